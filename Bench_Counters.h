@@ -0,0 +1,161 @@
+﻿// Bench_Counters.h
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Аппаратные счётчики производительности для экспериментов (perf_event_open, только Linux).
+//
+//  Каждое событие открывается отдельно и считает только пользовательский код этого потока,
+//  поэтому хватает perf_event_paranoid <= 2. Если ядро мультиплексирует счётчики,
+//  значения масштабируются по времени, в течение которого событие реально считалось.
+//  Событие, которое открыть не удалось, помечается недоступным; на других ОС или в
+//  контейнере без доступа к PMU недоступны все события, а замеры просто возвращают пустоту.
+//------------------------------------------------------------------------------------------------
+
+enum Perf_Event : int {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+// Короткие названия событий для заголовков таблиц
+inline const char* perf_event_name(int event) {
+    static const char* names[PERF_EVENT_COUNT] = {
+        "Такты", "Инструкции", "L1D промахи", "LLC промахи", "Ошибки ветвл.", "dTLB промахи"
+    };
+    return names[event];
+}
+
+// Значения счётчиков за один замер
+struct Perf_Values {
+    double value[PERF_EVENT_COUNT] = {};
+    bool   valid[PERF_EVENT_COUNT] = {};
+
+    Perf_Values& operator+=(const Perf_Values& other) {
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+            value[i] += other.value[i];
+            valid[i] = valid[i] || other.valid[i];
+        }
+        return *this;
+    }
+};
+
+class Perf_Counters {
+    int         fds[PERF_EVENT_COUNT];
+    std::string error;
+
+#if defined(__linux__)
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t cache_miss(uint64_t cache, uint64_t op) {
+        return cache | (op << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+#endif
+
+public:
+    Perf_Counters() {
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+            fds[i] = -1;
+        }
+#if defined(__linux__)
+        fds[PERF_CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[PERF_INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[PERF_L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE,
+            cache_miss(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ));
+        fds[PERF_LLC_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[PERF_BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[PERF_DTLB_MISSES] = open_event(PERF_TYPE_HW_CACHE,
+            cache_miss(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ));
+        if (!available()) {
+            error = "perf_event_open недоступен (проверьте /proc/sys/kernel/perf_event_paranoid)";
+        }
+#else
+        error = "аппаратные счётчики поддерживаются только в Linux";
+#endif
+    }
+
+    ~Perf_Counters() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    Perf_Counters(const Perf_Counters&) = delete;
+    Perf_Counters& operator=(const Perf_Counters&) = delete;
+
+    // Открылось ли хотя бы одно событие
+    bool available() const {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Причина недоступности (пустая строка, если счётчики работают)
+    const std::string& last_error() const {
+        return error;
+    }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    Perf_Values stop() {
+        Perf_Values result;
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+            // Формат чтения: значение, время включения, время фактического счёта
+            uint64_t data[3] = {};
+            if (fds[i] < 0 || read(fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            result.value[i] = double(data[0]) * double(data[1]) / double(data[2]);
+            result.valid[i] = true;
+        }
+#endif
+        return result;
+    }
+};
@@ -0,0 +1,153 @@
+﻿// Bench_Histogram.h
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>   // _BitScanReverse64
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BENCH_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_RDTSC 1
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Гистограмма задержек в духе HdrHistogram.
+//
+//  Значения делятся на диапазоны [2^k, 2^(k+1)), каждый из которых разбит на
+//  sub_buckets равных корзин, поэтому относительная погрешность не превышает
+//  1/sub_buckets при любом масштабе — от единиц наносекунд до секунд.
+//  Максимум хранится точно.
+//------------------------------------------------------------------------------------------------
+class Latency_Histogram {
+    static constexpr unsigned sub_bits = 7;
+    static constexpr uint64_t sub_buckets = uint64_t(1) << sub_bits;   // 128 корзин на диапазон
+    static constexpr unsigned ranges = 64 - sub_bits + 1;
+
+    std::vector<uint64_t> counts;
+    uint64_t              total = 0;
+    uint64_t              max_value = 0;
+
+    // Номер старшего единичного бита (value > 0)
+    static inline unsigned highest_bit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanReverse64(&bit, value);
+        return static_cast<unsigned>(bit);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+
+    static inline size_t index_of(uint64_t value) {
+        if (value < sub_buckets) {
+            return static_cast<size_t>(value);
+        }
+        unsigned range = highest_bit(value) - sub_bits + 1;
+        uint64_t sub = value >> (range - 1);                // от sub_buckets до 2*sub_buckets-1
+        return static_cast<size_t>(range * sub_buckets + (sub - sub_buckets));
+    }
+
+    // Наибольшее значение, попадающее в корзину
+    static inline uint64_t upper_of(size_t index) {
+        uint64_t range = index / sub_buckets;
+        uint64_t sub = index % sub_buckets;
+        if (range == 0) {
+            return sub;
+        }
+        return ((sub + sub_buckets + 1) << (range - 1)) - 1;
+    }
+
+public:
+    Latency_Histogram() : counts(ranges * sub_buckets, 0) {
+    }
+
+    void record(uint64_t value) {
+        ++counts[index_of(value)];
+        ++total;
+        max_value = std::max(max_value, value);
+    }
+
+    void merge(const Latency_Histogram& other) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        max_value = 0;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    uint64_t max() const {
+        return max_value;
+    }
+
+    // Значение, не превышаемое долей percent/100 записей (верхняя граница корзины)
+    uint64_t percentile(double percent) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * double(total) + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(upper_of(i), max_value);
+            }
+        }
+        return max_value;
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Часы для замера отдельных операций: счётчик тактов rdtsc там, где он есть
+//  (на порядок дешевле steady_clock), с пересчётом в наносекунды по калибровке.
+//------------------------------------------------------------------------------------------------
+class Latency_Clock {
+    double ns_per_tick = 1.0;
+
+public:
+    Latency_Clock() {
+#if defined(BENCH_HAS_RDTSC)
+        // Калибровка: сколько тактов проходит за ~20 мс steady_clock
+        auto wallStart = std::chrono::steady_clock::now();
+        uint64_t tickStart = __rdtsc();
+        while (std::chrono::steady_clock::now() - wallStart < std::chrono::milliseconds(20)) {
+        }
+        uint64_t ticks = __rdtsc() - tickStart;
+        double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - wallStart).count());
+        if (ticks > 0) {
+            ns_per_tick = ns / double(ticks);
+        }
+#endif
+    }
+
+    static inline uint64_t now() {
+#if defined(BENCH_HAS_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    inline uint64_t to_ns(uint64_t ticks) const {
+        return static_cast<uint64_t>(double(ticks) * ns_per_tick + 0.5);
+    }
+};
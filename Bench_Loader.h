@@ -0,0 +1,241 @@
+﻿// Bench_Loader.h
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BENCH_LOADER_SSE2 1
+#endif
+
+#include "Mapped_Dictionary.h"   // Mapped_File
+
+//------------------------------------------------------------------------------------------------
+//  Быстрая загрузка файлов ключей (по одному ключу в строке).
+//
+//  Файл отображается в память и делится на части по границам строк; части разбираются
+//  параллельно. Концы строк ищутся по 16 (SSE2) или 32 (AVX2) байта за сравнение.
+//  Порядок ключей совпадает с порядком строк в файле. Пустые строки пропускаются,
+//  завершающие '\r' и пробелы отбрасываются (файлы, сохранённые в Windows, читаются так же).
+//
+//  Строковые ключи возвращаются как string_view внутрь отображения: они действительны,
+//  пока открыт Key_File.
+//------------------------------------------------------------------------------------------------
+
+namespace key_loader_detail {
+
+    // Номер младшего единичного бита (mask != 0)
+    inline unsigned lowest_bit(uint32_t mask) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward(&bit, mask);
+        return static_cast<unsigned>(bit);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    // Концы строк по маске совпадений с '\n' в блоке, начинающемся с p
+    template <typename Func>
+    inline void emit_lines(uint32_t mask, const char* p, const char*& line, Func& on_line) {
+        while (mask != 0) {
+            unsigned bit = lowest_bit(mask);
+            on_line(line, p + bit);
+            line = p + bit + 1;
+            mask &= mask - 1;
+        }
+    }
+
+    // Вызывает on_line(begin, end) для каждой строки [begin, end) части файла
+    template <typename Func>
+    inline void for_each_line(const char* begin, const char* end, Func on_line) {
+        const char* line = begin;
+        const char* p = begin;
+#if defined(__AVX2__)
+        const __m256i newline = _mm256_set1_epi8('\n');
+        for (; p + 32 <= end; p += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+            emit_lines(mask, p, line, on_line);
+        }
+#elif defined(BENCH_LOADER_SSE2)
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; p + 16 <= end; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+            emit_lines(mask, p, line, on_line);
+        }
+#endif
+        for (; p < end; ++p) {
+            if (*p == '\n') {
+                on_line(line, p);
+                line = p + 1;
+            }
+        }
+        if (line < end) {
+            on_line(line, end);
+        }
+    }
+
+    // Отбрасывает пробельные символы по краям строки
+    inline std::string_view trim(const char* begin, const char* end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) {
+            ++begin;
+        }
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+            --end;
+        }
+        return std::string_view(begin, static_cast<size_t>(end - begin));
+    }
+
+    // Разбор целого со знаком без проверки локали; false при посторонних символах или переполнении
+    inline bool parse_int(std::string_view text, int& value) {
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+            negative = text[i] == '-';
+            ++i;
+        }
+        if (i == text.size()) {
+            return false;
+        }
+        int64_t result = 0;
+        for (; i < text.size(); ++i) {
+            unsigned digit = static_cast<unsigned>(text[i] - '0');
+            if (digit > 9) {
+                return false;
+            }
+            result = result * 10 + digit;
+            if (result > int64_t(INT32_MAX) + 1) {
+                return false;
+            }
+        }
+        result = negative ? -result : result;
+        if (result > INT32_MAX) {
+            return false;
+        }
+        value = static_cast<int>(result);
+        return true;
+    }
+
+    // Делит файл на parts частей; каждая граница сдвигается на начало следующей строки
+    inline std::vector<const char*> split_on_lines(const char* data, size_t size, unsigned parts) {
+        std::vector<const char*> bounds(parts + 1);
+        bounds[0] = data;
+        bounds[parts] = data + size;
+        for (unsigned i = 1; i < parts; ++i) {
+            const char* p = std::max(data + size / parts * i, bounds[i - 1]);
+            while (p < data + size && *p != '\n') {
+                ++p;
+            }
+            bounds[i] = p < data + size ? p + 1 : data + size;
+        }
+        return bounds;
+    }
+
+    // Разбирает части параллельно: parse(begin, end, out) для каждой части, затем склейка по порядку
+    template <typename T, typename Parse>
+    inline bool parse_parallel(const char* data, size_t size, unsigned threads, std::vector<T>& result, Parse parse) {
+        threads = std::max(1u, threads);
+        // Мелкие файлы не стоит делить: накладные расходы на потоки больше выигрыша
+        threads = static_cast<unsigned>(std::min<size_t>(threads, size / (1 << 20) + 1));
+        std::vector<const char*> bounds = split_on_lines(data, size, threads);
+        std::vector<std::vector<T>> parts(threads);
+        std::vector<char> ok(threads, 1);
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                ok[t] = parse(bounds[t], bounds[t + 1], parts[t]);
+            });
+        }
+        ok[0] = parse(bounds[0], bounds[1], parts[0]);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        size_t total = 0;
+        for (unsigned t = 0; t < threads; ++t) {
+            if (!ok[t]) {
+                return false;
+            }
+            total += parts[t].size();
+        }
+        result.clear();
+        result.reserve(total);
+        for (auto& part : parts) {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        return true;
+    }
+
+}
+
+class Key_File {
+    Mapped_File file;
+
+public:
+    bool open(const std::string& path) {
+        return file.open(path);
+    }
+
+    size_t size_bytes() const {
+        return file.size();
+    }
+
+    // Строковые ключи как string_view внутрь отображения
+    bool string_keys(std::vector<std::string_view>& keys,
+                     unsigned threads = std::thread::hardware_concurrency()) const {
+        if (file.data() == nullptr) {
+            return false;
+        }
+        return key_loader_detail::parse_parallel(file.data(), file.size(), threads, keys,
+            [](const char* begin, const char* end, std::vector<std::string_view>& out) {
+                out.reserve(static_cast<size_t>(end - begin) / 8);
+                key_loader_detail::for_each_line(begin, end, [&](const char* b, const char* e) {
+                    std::string_view key = key_loader_detail::trim(b, e);
+                    if (!key.empty()) {
+                        out.push_back(key);
+                    }
+                });
+                return true;
+            });
+    }
+
+    // Целочисленные ключи; false, если встретилась строка, не являющаяся числом int
+    bool int_keys(std::vector<int>& keys,
+                  unsigned threads = std::thread::hardware_concurrency()) const {
+        if (file.data() == nullptr) {
+            return false;
+        }
+        return key_loader_detail::parse_parallel(file.data(), file.size(), threads, keys,
+            [](const char* begin, const char* end, std::vector<int>& out) {
+                bool ok = true;
+                out.reserve(static_cast<size_t>(end - begin) / 6);
+                key_loader_detail::for_each_line(begin, end, [&](const char* b, const char* e) {
+                    std::string_view text = key_loader_detail::trim(b, e);
+                    int value;
+                    if (text.empty()) {
+                        return;
+                    }
+                    if (key_loader_detail::parse_int(text, value)) {
+                        out.push_back(value);
+                    }
+                    else {
+                        ok = false;
+                    }
+                });
+                return ok;
+            });
+    }
+};
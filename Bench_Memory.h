@@ -0,0 +1,179 @@
+﻿// Bench_Memory.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Точный учёт памяти для экспериментов.
+//
+//  Заголовок заменяет глобальные operator new/delete: каждое выделение получает 16-байтный
+//  префикс с размером, поэтому при освобождении известно, сколько байт вернулось.
+//  Счётчики ведутся атомарно и не зависят от того, как ОС отдаёт страницы процессу.
+//  RSS процесса доступен отдельно как вторичная, «шумная» величина.
+//
+//  Замена operator new действует на всю программу: подключать заголовок нужно ровно
+//  в одной единице трансляции (в драйвере экспериментов).
+//------------------------------------------------------------------------------------------------
+
+namespace bench_memory {
+
+    inline std::atomic<uint64_t> live_bytes{ 0 };       // занято сейчас
+    inline std::atomic<uint64_t> total_allocations{ 0 }; // выделений с начала работы
+
+    // Префикс перед блоком пользователя: размер и начало блока malloc
+    struct alignas(16) Prefix {
+        size_t size;
+        void*  origin;
+    };
+
+    inline void* allocate(size_t size, size_t alignment) {
+        if (alignment < alignof(Prefix)) {
+            alignment = alignof(Prefix);
+        }
+        void* origin = std::malloc(size + sizeof(Prefix) + alignment - alignof(Prefix));
+        if (origin == nullptr) {
+            return nullptr;
+        }
+        uintptr_t user = reinterpret_cast<uintptr_t>(origin) + sizeof(Prefix);
+        user = (user + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        Prefix* prefix = reinterpret_cast<Prefix*>(user) - 1;
+        prefix->size = size;
+        prefix->origin = origin;
+        live_bytes.fetch_add(size, std::memory_order_relaxed);
+        total_allocations.fetch_add(1, std::memory_order_relaxed);
+        return reinterpret_cast<void*>(user);
+    }
+
+    inline void release(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        Prefix* prefix = reinterpret_cast<Prefix*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Prefix));
+        live_bytes.fetch_sub(prefix->size, std::memory_order_relaxed);
+        std::free(prefix->origin);
+    }
+
+}
+
+// Состояние счётчиков в момент замера
+struct Memory_Snapshot {
+    uint64_t bytes;
+    uint64_t allocations;
+};
+
+inline Memory_Snapshot memory_snapshot() {
+    return { bench_memory::live_bytes.load(std::memory_order_relaxed),
+             bench_memory::total_allocations.load(std::memory_order_relaxed) };
+}
+
+// Разница между двумя замерами: сколько байт осталось занято и сколько было выделений
+struct Memory_Usage {
+    int64_t  bytes;
+    uint64_t allocations;
+};
+
+inline Memory_Usage memory_since(const Memory_Snapshot& start) {
+    Memory_Snapshot now = memory_snapshot();
+    return { static_cast<int64_t>(now.bytes) - static_cast<int64_t>(start.bytes),
+             now.allocations - start.allocations };
+}
+
+// Резидентная память процесса (байт), 0 — если узнать не удалось
+inline size_t current_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.WorkingSetSize;
+    }
+    return 0;
+#else
+    // /proc/self/statm: размер и резидентная часть в страницах
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+//------------------------------------------------------------------------------------------------
+//  Замена глобальных операторов выделения памяти
+//------------------------------------------------------------------------------------------------
+
+void* operator new(size_t size) {
+    if (void* ptr = bench_memory::allocate(size, alignof(std::max_align_t))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return bench_memory::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return bench_memory::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* ptr = bench_memory::allocate(size, static_cast<size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    bench_memory::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    bench_memory::release(ptr);
+}
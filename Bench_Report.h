@@ -0,0 +1,295 @@
+﻿// Bench_Report.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Машиночитаемые результаты экспериментов.
+//
+//  Каждая запись — один показатель (контейнер, набор ключей, операция, размер) со всеми
+//  повторами замера, чтобы сравнение прогонов (compare_results.py) могло учитывать шум.
+//  Отчёт пишется в JSON (с описанием окружения) и в CSV (одна строка на запись).
+//
+//  Флаги компиляции и коммит можно передать при сборке:
+//      -DBENCH_COMPILE_FLAGS="\"-O2 -march=native\"" -DBENCH_GIT_COMMIT="\"<hash>\""
+//  Без них коммит берётся из переменной окружения BENCH_GIT_COMMIT или из git rev-parse.
+//------------------------------------------------------------------------------------------------
+
+struct Bench_Record {
+    std::string         benchmark;   // режим эксперимента: tables, latency, ...
+    std::string         container;   // HashTable, RedBlackTree, StdHashMap, StdTreeMap, ...
+    std::string         dataset;     // файл ключей без расширения
+    std::string         operation;   // insert, find, erase, memory, ...
+    size_t              size = 0;    // число элементов
+    std::string         unit;        // ns, bytes, count
+    std::vector<double> samples;     // результаты отдельных повторов
+};
+
+// Описание окружения, в котором выполнялся прогон
+struct Bench_Environment {
+    std::string compiler;
+    std::string flags;
+    std::string cpu;
+    std::string commit;
+    std::string host;
+    std::string timestamp;
+    unsigned    hardware_threads = 0;
+
+    static Bench_Environment detect() {
+        Bench_Environment env;
+#if defined(__clang__)
+        env.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        env.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        env.compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+        env.compiler = "unknown";
+#endif
+
+#if defined(BENCH_COMPILE_FLAGS)
+        env.flags = BENCH_COMPILE_FLAGS;
+#else
+        // Флаги не переданы — записываем то, что видно из макросов
+        env.flags = "c++" + std::to_string(__cplusplus);
+#if defined(__OPTIMIZE__)
+        env.flags += " optimized";
+#endif
+#if defined(NDEBUG)
+        env.flags += " NDEBUG";
+#endif
+#if defined(__AVX2__)
+        env.flags += " avx2";
+#endif
+#endif
+
+        env.cpu = detect_cpu();
+        env.commit = detect_commit();
+        env.hardware_threads = std::thread::hardware_concurrency();
+
+#if defined(_WIN32)
+        const char* host = std::getenv("COMPUTERNAME");
+        env.host = host ? host : "";
+#else
+        char host[256] = {};
+        if (gethostname(host, sizeof(host) - 1) == 0) {
+            env.host = host;
+        }
+#endif
+
+        std::time_t now = std::time(nullptr);
+        std::tm utc{};
+#if defined(_WIN32)
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        env.timestamp = stamp;
+        return env;
+    }
+
+private:
+    static std::string detect_cpu() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int regs[4];
+        char brand[49] = {};
+        __cpuid(regs, 0x80000000);
+        if (static_cast<unsigned>(regs[0]) >= 0x80000004u) {
+            for (int i = 0; i < 3; ++i) {
+                __cpuid(regs, 0x80000002 + i);
+                std::memcpy(brand + 16 * i, regs, 16);
+            }
+            return brand;
+        }
+#elif defined(__linux__)
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("model name", 0) == 0) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    return line.substr(line.find_first_not_of(" \t", colon + 1));
+                }
+            }
+        }
+#endif
+        return "unknown";
+    }
+
+    static std::string detect_commit() {
+#if defined(BENCH_GIT_COMMIT)
+        return BENCH_GIT_COMMIT;
+#else
+        if (const char* commit = std::getenv("BENCH_GIT_COMMIT")) {
+            return commit;
+        }
+#if defined(_WIN32)
+        FILE* pipe = _popen("git rev-parse HEAD 2>NUL", "r");
+#else
+        FILE* pipe = popen("git rev-parse HEAD 2>/dev/null", "r");
+#endif
+        if (pipe == nullptr) {
+            return "unknown";
+        }
+        char buffer[64] = {};
+        std::string commit;
+        if (std::fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            commit = buffer;
+            commit.erase(commit.find_last_not_of(" \r\n") + 1);
+        }
+#if defined(_WIN32)
+        _pclose(pipe);
+#else
+        pclose(pipe);
+#endif
+        return commit.empty() ? "unknown" : commit;
+#endif
+    }
+};
+
+class Bench_Report {
+    std::vector<Bench_Record> records;
+
+    static std::string json_string(const std::string& text) {
+        std::string out = "\"";
+        for (char ch : text) {
+            switch (ch) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                    out += escaped;
+                }
+                else {
+                    out += ch;
+                }
+            }
+        }
+        return out + "\"";
+    }
+
+    static double mean_of(const std::vector<double>& samples) {
+        double sum = 0;
+        for (double v : samples) {
+            sum += v;
+        }
+        return samples.empty() ? 0 : sum / double(samples.size());
+    }
+
+    static double median_of(std::vector<double> samples) {
+        if (samples.empty()) {
+            return 0;
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t mid = samples.size() / 2;
+        return samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+    }
+
+    static double stddev_of(const std::vector<double>& samples) {
+        if (samples.size() < 2) {
+            return 0;
+        }
+        double mean = mean_of(samples), sum = 0;
+        for (double v : samples) {
+            sum += (v - mean) * (v - mean);
+        }
+        return std::sqrt(sum / double(samples.size() - 1));
+    }
+
+public:
+    Bench_Environment environment = Bench_Environment::detect();
+    std::string       dataset;   // набор ключей текущих замеров, подставляется в записи
+
+    void add(Bench_Record record) {
+        if (record.dataset.empty()) {
+            record.dataset = dataset;
+        }
+        records.push_back(std::move(record));
+    }
+
+    bool empty() const {
+        return records.empty();
+    }
+
+    bool write_json(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.precision(17);
+        out << "{\n  \"environment\": {\n"
+            << "    \"compiler\": " << json_string(environment.compiler) << ",\n"
+            << "    \"flags\": " << json_string(environment.flags) << ",\n"
+            << "    \"cpu\": " << json_string(environment.cpu) << ",\n"
+            << "    \"hardware_threads\": " << environment.hardware_threads << ",\n"
+            << "    \"commit\": " << json_string(environment.commit) << ",\n"
+            << "    \"host\": " << json_string(environment.host) << ",\n"
+            << "    \"timestamp\": " << json_string(environment.timestamp) << "\n  },\n"
+            << "  \"results\": [";
+        for (size_t i = 0; i < records.size(); ++i) {
+            const Bench_Record& r = records[i];
+            out << (i ? ",\n" : "\n")
+                << "    {\"benchmark\": " << json_string(r.benchmark)
+                << ", \"container\": " << json_string(r.container)
+                << ", \"dataset\": " << json_string(r.dataset)
+                << ", \"operation\": " << json_string(r.operation)
+                << ", \"size\": " << r.size
+                << ", \"unit\": " << json_string(r.unit)
+                << ", \"mean\": " << mean_of(r.samples)
+                << ", \"median\": " << median_of(r.samples)
+                << ", \"samples\": [";
+            for (size_t j = 0; j < r.samples.size(); ++j) {
+                out << (j ? ", " : "") << r.samples[j];
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    bool write_csv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.precision(17);
+        out << "benchmark,container,dataset,operation,size,unit,mean,median,stddev,count,samples,"
+            << "compiler,cpu,commit,timestamp\n";
+        for (const Bench_Record& r : records) {
+            out << r.benchmark << ',' << r.container << ',' << r.dataset << ',' << r.operation << ','
+                << r.size << ',' << r.unit << ',' << mean_of(r.samples) << ',' << median_of(r.samples) << ','
+                << stddev_of(r.samples) << ',' << r.samples.size() << ',';
+            for (size_t j = 0; j < r.samples.size(); ++j) {
+                out << (j ? ";" : "") << r.samples[j];
+            }
+            // Текстовые поля окружения могут содержать запятые — берём их в кавычки
+            out << ",\"" << environment.compiler << "\",\"" << environment.cpu << "\","
+                << environment.commit << ',' << environment.timestamp << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+};
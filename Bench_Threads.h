@@ -0,0 +1,53 @@
+﻿// Bench_Threads.h
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Вспомогательные средства для многопоточных экспериментов.
+//------------------------------------------------------------------------------------------------
+
+// Привязывает текущий поток к логическому процессору cpu; false, если ОС не позволила
+inline bool pin_current_thread(unsigned cpu) {
+#if defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Одноразовый барьер: потоки ждут, пока соберутся все, и стартуют одновременно
+class Start_Barrier {
+    std::atomic<unsigned> waiting;
+
+public:
+    explicit Start_Barrier(unsigned threads) : waiting(threads) {
+    }
+
+    void arrive_and_wait() {
+        waiting.fetch_sub(1, std::memory_order_acq_rel);
+        while (waiting.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+};
@@ -0,0 +1,182 @@
+﻿// Bench_Workload.h
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------
+//  Генератор рабочих нагрузок для экспериментов.
+//
+//  Ключи берутся из общего массива ключей по индексам. Живые ключи всегда образуют окно
+//  [lo, hi): перед запуском в словарь загружается working_set первых ключей, вставка
+//  добавляет ключ hi, удаление убирает самый старый ключ lo (обновление набора ключей).
+//  Благодаря этому состав словаря известен заранее и доля попаданий поиска точна:
+//  промахи берутся из хвоста массива ключей, который никогда не вставляется.
+//
+//  Распределения для выбора ключа поиска внутри окна:
+//      uniform    — равномерно
+//      zipf       — закон Ципфа с параметром theta (0 < theta < 1), горячие ключи разбросаны
+//                   по окну перемешиванием номера (как scrambled zipfian в YCSB)
+//      sequential — по кругу в порядке вставки
+//      latest     — закон Ципфа по новизне: чаще всего ищутся недавно вставленные ключи
+//------------------------------------------------------------------------------------------------
+
+enum Key_Distribution { DIST_UNIFORM, DIST_ZIPF, DIST_SEQUENTIAL, DIST_LATEST };
+
+inline const char* distribution_name(Key_Distribution distribution) {
+    switch (distribution) {
+    case DIST_UNIFORM:    return "uniform";
+    case DIST_ZIPF:       return "zipf";
+    case DIST_SEQUENTIAL: return "sequential";
+    default:              return "latest";
+    }
+}
+
+// Разбор названия распределения; false, если название неизвестно
+inline bool parse_distribution(const std::string& name, Key_Distribution& distribution) {
+    for (Key_Distribution d : { DIST_UNIFORM, DIST_ZIPF, DIST_SEQUENTIAL, DIST_LATEST }) {
+        if (name == distribution_name(d)) {
+            distribution = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Workload_Config {
+    Key_Distribution distribution = DIST_ZIPF;
+    double           zipf_theta = 0.99;
+    unsigned         find_percent = 90;     // доли операций; сумма — 100
+    unsigned         insert_percent = 5;
+    unsigned         erase_percent = 5;
+    double           hit_ratio = 1.0;       // доля поисков существующих ключей
+    size_t           working_set = 100000;  // число ключей в словаре перед запуском
+    size_t           operations = 1000000;
+    uint64_t         seed = 42;
+};
+
+enum Workload_Op_Kind : uint8_t { OP_FIND, OP_INSERT, OP_ERASE };
+
+struct Workload_Op {
+    Workload_Op_Kind kind;
+    uint32_t         key;   // индекс ключа в общем массиве
+};
+
+//------------------------------------------------------------------------------------------------
+//  Генератор номеров по закону Ципфа (алгоритм Грея и др., используется в YCSB):
+//  номер 0 — самый частый. Параметр theta в (0, 1).
+//------------------------------------------------------------------------------------------------
+class Zipf_Generator {
+    uint64_t n;
+    double   theta, alpha, zetan, eta, half_pow_theta;
+
+    static double zeta(uint64_t count, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= count; ++i) {
+            sum += 1.0 / std::pow(double(i), theta);
+        }
+        return sum;
+    }
+
+public:
+    Zipf_Generator(uint64_t count, double skew) : n(count < 2 ? 2 : count), theta(skew) {
+        alpha = 1.0 / (1.0 - theta);
+        zetan = zeta(n, theta);
+        eta = (1.0 - std::pow(2.0 / double(n), 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+        half_pow_theta = 1.0 + std::pow(0.5, theta);
+    }
+
+    template <typename Rng>
+    uint64_t next(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < half_pow_theta) {
+            return 1;
+        }
+        uint64_t rank = static_cast<uint64_t>(double(n) * std::pow(eta * u - eta + 1.0, alpha));
+        return rank < n ? rank : n - 1;
+    }
+};
+
+// Сколько ключей нужно нагрузке: окно, все вставки и запас отсутствующих ключей
+inline size_t workload_keys_needed(const Workload_Config& config) {
+    size_t inserts = config.operations * config.insert_percent / 100 + 1;
+    return config.working_set + inserts + config.working_set;
+}
+
+//------------------------------------------------------------------------------------------------
+//  Строит последовательность операций. keyCount — размер общего массива ключей;
+//  должно выполняться keyCount >= workload_keys_needed(config), иначе возвращается пустой
+//  вектор. Последовательность полностью определяется config.seed.
+//------------------------------------------------------------------------------------------------
+inline std::vector<Workload_Op> generate_workload(const Workload_Config& config, size_t keyCount) {
+    std::vector<Workload_Op> ops;
+    if (config.working_set == 0 || keyCount < workload_keys_needed(config) ||
+        config.find_percent + config.insert_percent + config.erase_percent != 100) {
+        return ops;
+    }
+
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<unsigned> percent(0, 99);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Zipf_Generator zipf(config.working_set, config.zipf_theta);
+
+    // Отсутствующие ключи — последние working_set ключей массива
+    const size_t missBegin = keyCount - config.working_set;
+    uint64_t lo = 0, hi = config.working_set;
+    uint64_t cursor = 0;
+
+    ops.reserve(config.operations);
+    for (size_t i = 0; i < config.operations; ++i) {
+        unsigned roll = percent(rng);
+        if (roll < config.insert_percent) {
+            ops.push_back({ OP_INSERT, static_cast<uint32_t>(hi++) });
+            continue;
+        }
+        if (roll < config.insert_percent + config.erase_percent) {
+            // Окно не опустошается полностью, чтобы поиску было из чего выбирать
+            if (hi - lo > 1) {
+                ops.push_back({ OP_ERASE, static_cast<uint32_t>(lo++) });
+            }
+            else {
+                ops.push_back({ OP_ERASE, static_cast<uint32_t>(missBegin) });
+            }
+            continue;
+        }
+
+        if (unit(rng) >= config.hit_ratio) {
+            uint64_t miss = missBegin + rng() % config.working_set;
+            ops.push_back({ OP_FIND, static_cast<uint32_t>(miss) });
+            continue;
+        }
+        uint64_t size = hi - lo;
+        uint64_t offset;
+        switch (config.distribution) {
+        case DIST_UNIFORM:
+            offset = rng() % size;
+            break;
+        case DIST_ZIPF: {
+            // Перемешивание номера (фибоначчиево хэширование), чтобы горячие ключи не шли подряд
+            uint64_t rank = zipf.next(rng);
+            offset = (rank * 0x9E3779B97F4A7C15ULL >> 17) % size;
+            break;
+        }
+        case DIST_SEQUENTIAL:
+            offset = cursor++ % size;
+            break;
+        default: {
+            uint64_t rank = zipf.next(rng) % size;
+            offset = size - 1 - rank;
+            break;
+        }
+        }
+        ops.push_back({ OP_FIND, static_cast<uint32_t>(lo + offset) });
+    }
+    return ops;
+}
@@ -0,0 +1,293 @@
+﻿// Binary_Stream.h
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------
+//  Потоковая двоичная сериализация словарей.
+//
+//  Поток состоит из блоков: [длина блока, 4 байта][данные блока]. Писатель копит данные
+//  в буфере (64 КиБ) и сбрасывает его одним блоком; читатель читает ровно столько байт,
+//  сколько указано в заголовке блока, поэтому никогда не забирает из потока чужие данные.
+//  Поток завершается блоком нулевой длины и CRC-32 всех данных блоков.
+//
+//  Строки кодируются как varint-длина и байты, остальные типы — как есть
+//  (числа в порядке байт машины, little-endian).
+//------------------------------------------------------------------------------------------------
+
+// Таблицы CRC-32 (полином 0xEDB88320) для обработки по 8 байт за шаг
+inline const uint32_t* crc32_tables() {
+    static const std::vector<uint32_t> tables = [] {
+        std::vector<uint32_t> t(8 * 256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+            }
+            t[i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) {
+                uint32_t prev = t[(s - 1) * 256 + i];
+                t[s * 256 + i] = (prev >> 8) ^ t[prev & 0xFF];
+            }
+        }
+        return t;
+    }();
+    return tables.data();
+}
+
+// Продолжает вычисление CRC-32 (начальное значение — 0)
+inline uint32_t crc32_update(uint32_t crc, const char* data, size_t length) {
+    const uint32_t* t = crc32_tables();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (length >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7 * 256 + (lo & 0xFF)] ^ t[6 * 256 + ((lo >> 8) & 0xFF)] ^
+              t[5 * 256 + ((lo >> 16) & 0xFF)] ^ t[4 * 256 + (lo >> 24)] ^
+              t[3 * 256 + (hi & 0xFF)] ^ t[2 * 256 + ((hi >> 8) & 0xFF)] ^
+              t[1 * 256 + ((hi >> 16) & 0xFF)] ^ t[0 * 256 + (hi >> 24)];
+        p += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ t[(crc ^ *p++) & 0xFF];
+    }
+    return ~crc;
+}
+
+// Сигнатура начала потока и вид содержимого
+static constexpr char binary_stream_magic[4] = { 'D', 'S', 'R', '1' };
+enum Binary_Layout : uint8_t { BINARY_HASH = 1, BINARY_ORDERED = 2, BINARY_TRACE = 3 };
+
+class Binary_Writer {
+    std::ostream&     out;
+    std::vector<char> buffer;
+    size_t            used = 0;
+    uint32_t          crc = 0;
+
+    // Выписывает накопленные данные одним блоком
+    void flush_block() {
+        if (used == 0) {
+            return;
+        }
+        uint32_t length = static_cast<uint32_t>(used);
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+        crc = crc32_update(crc, buffer.data(), used);
+        used = 0;
+    }
+
+public:
+    static constexpr size_t block_size = 1 << 16;
+
+    explicit Binary_Writer(std::ostream& stream) : out(stream), buffer(block_size) {
+    }
+
+    void write_bytes(const void* data, size_t length) {
+        const char* src = static_cast<const char*>(data);
+        // Быстрый путь: данные целиком помещаются в буфер
+        if (length <= buffer.size() - used) {
+            std::memcpy(buffer.data() + used, src, length);
+            used += length;
+            return;
+        }
+        while (length > 0) {
+            if (used == buffer.size()) {
+                flush_block();
+            }
+            size_t chunk = std::min(length, buffer.size() - used);
+            std::memcpy(buffer.data() + used, src, chunk);
+            used += chunk;
+            src += chunk;
+            length -= chunk;
+        }
+    }
+
+    void write_varint(uint64_t value) {
+        char bytes[10];
+        size_t n = 0;
+        while (value >= 0x80) {
+            bytes[n++] = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        bytes[n++] = static_cast<char>(value);
+        write_bytes(bytes, n);
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            write_varint(value.size());
+            write_bytes(value.data(), value.size());
+        }
+        else {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "Binary_Writer: тип должен быть строкой или тривиально копируемым");
+            write_bytes(&value, sizeof(T));
+        }
+    }
+
+    // Заголовок потока: сигнатура, вид содержимого и число пар
+    void write_header(Binary_Layout layout, uint64_t count) {
+        write_bytes(binary_stream_magic, sizeof(binary_stream_magic));
+        uint8_t kind = layout;
+        write_bytes(&kind, 1);
+        write_varint(count);
+    }
+
+    // Сбрасывает буфер, пишет завершающий блок и контрольную сумму
+    bool finish() {
+        flush_block();
+        uint32_t terminator = 0;
+        out.write(reinterpret_cast<const char*>(&terminator), sizeof(terminator));
+        out.write(reinterpret_cast<const char*>(&crc), sizeof(crc));
+        out.flush();
+        return static_cast<bool>(out);
+    }
+};
+
+class Binary_Reader {
+    std::istream&     in;
+    std::vector<char> buffer;
+    size_t            pos = 0;
+    size_t            filled = 0;
+    uint32_t          crc = 0;
+    bool              good = true;
+    bool              at_end = false;   // прочитан завершающий блок
+
+    // Читает следующий блок целиком
+    bool next_block() {
+        if (!good || at_end) {
+            return false;
+        }
+        uint32_t length = 0;
+        if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            good = false;
+            return false;
+        }
+        if (length == 0) {
+            at_end = true;
+            return false;
+        }
+        if (length > Binary_Writer::block_size) {
+            good = false;
+            return false;
+        }
+        if (!in.read(buffer.data(), length)) {
+            good = false;
+            return false;
+        }
+        crc = crc32_update(crc, buffer.data(), length);
+        pos = 0;
+        filled = length;
+        return true;
+    }
+
+public:
+    explicit Binary_Reader(std::istream& stream) : in(stream), buffer(Binary_Writer::block_size) {
+    }
+
+    bool ok() const {
+        return good;
+    }
+
+    bool read_bytes(void* data, size_t length) {
+        char* dst = static_cast<char*>(data);
+        while (length > 0) {
+            if (pos == filled && !next_block()) {
+                good = false;
+                return false;
+            }
+            size_t chunk = std::min(length, filled - pos);
+            std::memcpy(dst, buffer.data() + pos, chunk);
+            pos += chunk;
+            dst += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    bool read_varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            unsigned char byte;
+            if (pos < filled) {
+                byte = static_cast<unsigned char>(buffer[pos++]);
+            }
+            else if (!read_bytes(&byte, 1)) {
+                return false;
+            }
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        good = false;
+        return false;
+    }
+
+    template <typename T>
+    bool read(T& value) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            uint64_t length;
+            if (!read_varint(length)) {
+                return false;
+            }
+            // Повреждённая длина не должна приводить к гигантскому выделению памяти
+            if (length > (uint64_t(1) << 32)) {
+                good = false;
+                return false;
+            }
+            value.resize(static_cast<size_t>(length));
+            return read_bytes(&value[0], value.size());
+        }
+        else {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "Binary_Reader: тип должен быть строкой или тривиально копируемым");
+            if (pos + sizeof(T) <= filled) {
+                std::memcpy(&value, buffer.data() + pos, sizeof(T));
+                pos += sizeof(T);
+                return true;
+            }
+            return read_bytes(&value, sizeof(T));
+        }
+    }
+
+    // Проверяет сигнатуру и вид содержимого, возвращает число пар
+    bool read_header(Binary_Layout layout, uint64_t& count) {
+        char magic[sizeof(binary_stream_magic)];
+        uint8_t kind = 0;
+        if (!read_bytes(magic, sizeof(magic)) || !read_bytes(&kind, 1) ||
+            std::memcmp(magic, binary_stream_magic, sizeof(magic)) != 0 || kind != layout) {
+            good = false;
+            return false;
+        }
+        return read_varint(count);
+    }
+
+    // Проверяет, что данные закончились ровно на завершающем блоке и CRC совпадает
+    bool finish() {
+        if (!good || pos != filled || next_block() || !at_end) {
+            good = false;
+            return false;
+        }
+        uint32_t stored = 0;
+        if (!in.read(reinterpret_cast<char*>(&stored), sizeof(stored)) || stored != crc) {
+            good = false;
+            return false;
+        }
+        return true;
+    }
+};
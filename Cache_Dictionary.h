@@ -0,0 +1,205 @@
+﻿// Cache_Dictionary.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Membership_Filter.h"   // membership_hash()
+#include "Container_Stats.h"     // Cache_Stats
+
+//------------------------------------------------------------------------------------------------
+//  Хэш-таблица ограниченной ёмкости с вытеснением по алгоритму CLOCK.
+//
+//  Элементы лежат в массиве слотов фиксированного размера (capacity), цепочки корзин
+//  связывают номера слотов. У каждого слота есть бит обращения: попадание в find()
+//  только взводит его в самом слоте — общих списков (как у LRU) нет, поэтому попадание
+//  не перестраивает никаких структур. Когда кэш полон, «стрелка» идёт по слотам
+//  по кругу: взведённый бит сбрасывается (второй шанс), первый слот со сброшенным
+//  битом вытесняется, и его место занимает новый элемент.
+//
+//  Таблица корзин выделяется сразу под всю ёмкость и не расширяется.
+//  Указатель, возвращённый find(), действителен до следующей вставки.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value>
+class Cache_Dictionary {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Slot {
+        Key      key;
+        Value    value;
+        uint32_t next;         // следующий слот цепочки (или свободный слот)
+        bool     referenced;   // бит обращения для CLOCK
+    };
+
+    std::vector<uint32_t> buckets;
+    std::vector<Slot>     slots;
+    size_t                limit;
+    size_t                count = 0;
+    size_t                hand = 0;          // стрелка CLOCK
+    uint32_t              free_slot = NONE;  // слоты, освобождённые erase()
+    size_t                hits = 0;
+    size_t                misses = 0;
+    size_t                evictions = 0;
+
+    size_t bucket_of(const Key& key) const {
+        return static_cast<size_t>(membership_hash(key)) & (buckets.size() - 1);
+    }
+
+    uint32_t find_slot(const Key& key) const {
+        for (uint32_t slot = buckets[bucket_of(key)]; slot != NONE; slot = slots[slot].next) {
+            if (slots[slot].key == key) {
+                return slot;
+            }
+        }
+        return NONE;
+    }
+
+    // Убирает слот из цепочки его корзины
+    void unlink(uint32_t slot) {
+        uint32_t* link = &buckets[bucket_of(slots[slot].key)];
+        while (*link != slot) {
+            link = &slots[*link].next;
+        }
+        *link = slots[slot].next;
+    }
+
+    // Выбирает жертву CLOCK: проходит по слотам, сбрасывая биты обращения
+    uint32_t choose_victim() {
+        while (slots[hand].referenced) {
+            slots[hand].referenced = false;
+            hand = hand + 1 == slots.size() ? 0 : hand + 1;
+        }
+        uint32_t victim = static_cast<uint32_t>(hand);
+        hand = hand + 1 == slots.size() ? 0 : hand + 1;
+        return victim;
+    }
+
+public:
+    // capacity — наибольшее число элементов (не меньше 1)
+    explicit Cache_Dictionary(size_t capacity) : limit(capacity ? capacity : 1) {
+        size_t bucket_count = 16;
+        while (bucket_count * 3 < limit * 4) {
+            bucket_count *= 2;
+        }
+        buckets.assign(bucket_count, NONE);
+        slots.reserve(limit);
+    }
+
+    // Поиск с учётом попаданий и промахов; попадание взводит бит обращения
+    Value* find(const Key& key) {
+        uint32_t slot = find_slot(key);
+        if (slot == NONE) {
+            ++misses;
+            return nullptr;
+        }
+        ++hits;
+        if (!slots[slot].referenced) {
+            slots[slot].referenced = true;
+        }
+        return &slots[slot].value;
+    }
+
+    // Проверка наличия без учёта в счётчиках и без влияния на вытеснение
+    bool contains(const Key& key) const {
+        return find_slot(key) != NONE;
+    }
+
+    // Вставка или обновление. Возвращает true, если при вставке пришлось вытеснить элемент.
+    // Новый элемент начинает без бита обращения: если к нему не обратятся, он уйдёт первым.
+    bool insert(const Key& key, const Value& value) {
+        uint32_t slot = find_slot(key);
+        if (slot != NONE) {
+            slots[slot].value = value;
+            slots[slot].referenced = true;
+            return false;
+        }
+
+        bool evicted = false;
+        if (free_slot != NONE) {
+            slot = free_slot;
+            free_slot = slots[slot].next;
+            slots[slot].key = key;
+            slots[slot].value = value;
+        }
+        else if (slots.size() < limit) {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back({ key, value, NONE, false });
+        }
+        else {
+            slot = choose_victim();
+            unlink(slot);
+            slots[slot].key = key;
+            slots[slot].value = value;
+            ++evictions;
+            --count;
+            evicted = true;
+        }
+
+        size_t index = bucket_of(key);
+        slots[slot].next = buckets[index];
+        slots[slot].referenced = false;
+        buckets[index] = slot;
+        ++count;
+        return evicted;
+    }
+
+    bool erase(const Key& key) {
+        uint32_t slot = find_slot(key);
+        if (slot == NONE) {
+            return false;
+        }
+        unlink(slot);
+        // Стрелка до свободного слота не дойдёт: вытеснение начинается, только когда свободных нет
+        slots[slot].next = free_slot;
+        free_slot = slot;
+        --count;
+        return true;
+    }
+
+    void clear() {
+        buckets.assign(buckets.size(), NONE);
+        slots.clear();
+        free_slot = NONE;
+        hand = 0;
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t capacity() const {
+        return limit;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Обход всех пар (порядок не определён)
+    template <typename Func>
+    void for_each(Func func) const {
+        for (uint32_t head : buckets) {
+            for (uint32_t slot = head; slot != NONE; slot = slots[slot].next) {
+                func(slots[slot].key, slots[slot].value);
+            }
+        }
+    }
+
+    Cache_Stats stats() const {
+        Cache_Stats result;
+        result.element_count = count;
+        result.capacity = limit;
+        result.hits = hits;
+        result.misses = misses;
+        result.evictions = evictions;
+        result.hit_ratio = hits + misses ? double(hits) / double(hits + misses) : 0;
+        return result;
+    }
+
+    // Обнуление счётчиков попаданий, промахов и вытеснений
+    void reset_stats() {
+        hits = misses = evictions = 0;
+    }
+};
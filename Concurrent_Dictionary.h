@@ -0,0 +1,136 @@
+﻿// Concurrent_Dictionary.h
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+#include "Membership_Filter.h"
+
+//------------------------------------------------------------------------------------------------
+//  Потокобезопасные обёртки над словарями проекта.
+//
+//  Указатель из find() после снятия блокировки может стать недействительным, поэтому
+//  обёртки копируют значение наружу: find(key, value) возвращает, найден ли ключ.
+//
+//  Lock — std::mutex (все операции взаимоисключающие) или std::shared_mutex
+//  (поиски выполняются параллельно под разделяемой блокировкой).
+//------------------------------------------------------------------------------------------------
+
+namespace concurrent_detail {
+
+    template <typename Lock>
+    struct Read_Guard {
+        Lock& lock;
+        explicit Read_Guard(Lock& l) : lock(l) {
+            if constexpr (std::is_same<Lock, std::shared_mutex>::value) {
+                lock.lock_shared();
+            }
+            else {
+                lock.lock();
+            }
+        }
+        ~Read_Guard() {
+            if constexpr (std::is_same<Lock, std::shared_mutex>::value) {
+                lock.unlock_shared();
+            }
+            else {
+                lock.unlock();
+            }
+        }
+    };
+
+}
+
+// Один словарь под одной блокировкой
+template <typename Key, typename Value, typename Engine, typename Lock = std::mutex>
+class Locked_Dictionary {
+    mutable Lock lock;
+    Engine       dict;
+
+public:
+    Locked_Dictionary() = default;
+
+    Locked_Dictionary(const Locked_Dictionary&) = delete;
+    Locked_Dictionary& operator=(const Locked_Dictionary&) = delete;
+
+    void insert(const Key& key, const Value& value) {
+        std::lock_guard<Lock> guard(lock);
+        dict.insert(key, value);
+    }
+
+    bool find(const Key& key, Value& value) const {
+        concurrent_detail::Read_Guard<Lock> guard(lock);
+        const Value* found = dict.find(key);
+        if (found == nullptr) {
+            return false;
+        }
+        value = *found;
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        concurrent_detail::Read_Guard<Lock> guard(lock);
+        return dict.contains(key);
+    }
+
+    void erase(const Key& key) {
+        std::lock_guard<Lock> guard(lock);
+        dict.erase(key);
+    }
+
+    size_t size() const {
+        concurrent_detail::Read_Guard<Lock> guard(lock);
+        return static_cast<size_t>(const_cast<Engine&>(dict).size());
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Словарь, разбитый на Shards независимых частей со своими блокировками.
+//  Часть выбирается по хэшу ключа, поэтому потоки, работающие с разными ключами,
+//  почти не мешают друг другу. Порядок ключей между частями не сохраняется.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Engine, typename Lock = std::shared_mutex, size_t Shards = 64>
+class Sharded_Dictionary {
+    static_assert((Shards & (Shards - 1)) == 0, "Sharded_Dictionary: число частей — степень двойки");
+
+    // Каждая часть на своей кэш-линии, чтобы блокировки соседей не делили линию
+    struct alignas(64) Shard {
+        Locked_Dictionary<Key, Value, Engine, Lock> dict;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+
+    Shard& shard_of(const Key& key) const {
+        return shards[membership_hash(key) & (Shards - 1)];
+    }
+
+public:
+    Sharded_Dictionary() : shards(new Shard[Shards]) {
+    }
+
+    void insert(const Key& key, const Value& value) {
+        shard_of(key).dict.insert(key, value);
+    }
+
+    bool find(const Key& key, Value& value) const {
+        return shard_of(key).dict.find(key, value);
+    }
+
+    bool contains(const Key& key) const {
+        return shard_of(key).dict.contains(key);
+    }
+
+    void erase(const Key& key) {
+        shard_of(key).dict.erase(key);
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < Shards; ++i) {
+            total += shards[i].dict.size();
+        }
+        return total;
+    }
+};
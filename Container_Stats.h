@@ -0,0 +1,81 @@
+﻿// Container_Stats.h
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------
+//  Диагностика внутреннего устройства словарей: stats() у Dictionary и RB_Dictionary.
+//
+//  Структурные показатели (длины цепочек, высота дерева и т. п.) считаются обходом
+//  в момент вызова stats() и доступны всегда. Счётчики событий (расширения таблицы,
+//  повороты дерева) ведутся только при параметре шаблона Collect_Stats = true:
+//  по умолчанию счётчик пустой и его увеличение исчезает при компиляции.
+//------------------------------------------------------------------------------------------------
+
+// Счётчик событий; при Enabled = false ничего не хранит и ничего не делает
+template <bool Enabled>
+struct Stats_Counter {
+    size_t count = 0;
+
+    void add() { ++count; }
+    void reset() { count = 0; }
+    size_t value() const { return count; }
+};
+
+template <>
+struct Stats_Counter<false> {
+    void add() {}
+    void reset() {}
+    size_t value() const { return 0; }
+};
+
+// Показатели хэш-таблицы (Dictionary)
+struct Hash_Stats {
+    size_t              element_count = 0;
+    size_t              bucket_count = 0;
+    double              load_factor = 0;         // элементы / корзины
+    double              empty_bucket_ratio = 0;  // доля пустых корзин
+    size_t              max_chain = 0;           // длина самой длинной цепочки
+    std::vector<size_t> chain_histogram;         // [k] — число корзин с цепочкой длины k
+    size_t              bytes = 0;               // таблица и узлы, без памяти, занятой самими ключами
+    bool                counters_enabled = false;
+    size_t              resize_count = 0;        // расширений с последнего reset_stats() (при Collect_Stats)
+};
+
+// Показатели красно-чёрного дерева (RB_Dictionary)
+struct RB_Stats {
+    size_t element_count = 0;
+    size_t height = 0;          // число узлов на самом длинном пути от корня до листа
+    size_t black_height = 0;    // число чёрных узлов на любом пути от корня до nil (без nil)
+    double average_depth = 0;   // средняя глубина узла, корень на глубине 1
+    size_t pool_free = 0;       // свободных узлов в пуле, готовых к повторному использованию
+    size_t bytes = 0;           // узлы (включая пул и nil) и служебные структуры
+    bool   counters_enabled = false;
+    size_t rotations = 0;       // поворотов с последнего reset_stats() (при Collect_Stats)
+};
+
+// Показатели кэша (Cache_Dictionary)
+struct Cache_Stats {
+    size_t element_count = 0;
+    size_t capacity = 0;
+    size_t hits = 0;          // find(), нашедших ключ, с последнего reset_stats()
+    size_t misses = 0;        // find(), не нашедших ключ
+    size_t evictions = 0;     // вытесненных элементов
+    double hit_ratio = 0;     // hits / (hits + misses)
+};
+
+// Показатели LSM-словаря (LSM_Dictionary)
+struct LSM_Stats {
+    size_t memtable_count = 0;   // записей в памяти-таблице, включая надгробия
+    size_t memtable_limit = 0;   // при таком числе записей таблица выписывается на диск
+    size_t run_count = 0;        // файлов-прогонов на диске
+    size_t run_records = 0;      // записей во всех прогонах (с повторами ключей и надгробиями)
+    size_t disk_bytes = 0;       // размер файлов прогонов
+    size_t index_bytes = 0;      // разреженные индексы в памяти (без фильтров)
+    size_t flushes = 0;          // выписанных памяти-таблиц
+    size_t write_stalls = 0;     // выписываний, ждавших фонового слияния
+    size_t compactions = 0;      // завершённых слияний прогонов
+    size_t blocks_read = 0;      // блоков, прочитанных с диска при поиске
+    size_t filter_skips = 0;     // прогонов, пропущенных при поиске по ответу фильтра
+};
@@ -5,16 +5,30 @@ using System.Globalization;
 using System.IO;
 using System.Linq;
 using System.Runtime.InteropServices;
+using System.Text;
 
 class Program
 {
     private const int KeyCount = 1_000_000;
 
+    // Размеры наборов и число повторов; заменяются параметрами --sizes и --iterations
+    private static int[] Sizes = { 10, 100, 1000, 10_000, 100_000, 1_000_000 };
+    private static int[] IterationCounts = null;
+
+    // Замеры в формате отчёта Experiment_C++ (Bench_Report.h) для --report
+    private static readonly List<string> ReportRecords = new List<string>();
+
     static void Main(string[] args)
     {
+        if (args.Length > 0)
+        {
+            RunConfigured(args);
+            return;
+        }
+
         string filePath = @"C:\\Users\\PC\\OneDrive - vyatsu\\УЧЕБА\\2 курс 4 семестр\\Курсовой проект\\Тестирование\\"; 
 
-        string[] filenames = { "random_keys.txt", "decreazing_str_key.txt", "increazing_str_key.txt", "shuffled_numbers.txt", "decreazing_int_key.txt", "increazing_int_key.txt" };
+        string[] filenames = { "random_keys.txt", "decreasing_str_key.txt", "increasing_str_key.txt", "shuffled_numbers.txt", "decreasing_int_key.txt", "increasing_int_key.txt" };
 
         for (int i = 2; i < 3; i++)
         {
@@ -38,6 +52,78 @@ class Program
         
     }
 
+    // Запуск с параметрами: --data <каталог> --sizes 10,100 --iterations 1000,100
+    // --datasets random_keys:str,shuffled_numbers:int --report <файл.json>
+    private static void RunConfigured(string[] args)
+    {
+        string dataDir = ".";
+        string datasets = "random_keys:str,decreasing_str_key:str,increasing_str_key:str," +
+                          "shuffled_numbers:int,decreasing_int_key:int,increasing_int_key:int";
+        string reportPath = null;
+
+        for (int i = 0; i + 1 < args.Length; i += 2)
+        {
+            switch (args[i])
+            {
+                case "--data": dataDir = args[i + 1]; break;
+                case "--sizes": Sizes = args[i + 1].Split(',').Select(int.Parse).ToArray(); break;
+                case "--iterations": IterationCounts = args[i + 1].Split(',').Select(int.Parse).ToArray(); break;
+                case "--datasets": datasets = args[i + 1]; break;
+                case "--report": reportPath = args[i + 1]; break;
+                default: throw new ArgumentException($"Неизвестный параметр: {args[i]}");
+            }
+        }
+        if (IterationCounts != null && IterationCounts.Length != Sizes.Length)
+            throw new ArgumentException("Число значений --iterations должно совпадать с числом размеров");
+
+        string resultDir = Path.Combine(dataDir, "test_results");
+        Directory.CreateDirectory(resultDir);
+        int keyCount = Sizes.Max();
+
+        foreach (var item in datasets.Split(','))
+        {
+            var parts = item.Split(':');
+            string name = parts[0];
+            string path = Path.Combine(dataDir, name + ".txt");
+            Console.WriteLine(name);
+            if (parts[1] == "int")
+            {
+                var keys = ReadKeysFromFile<int>(path, keyCount);
+                TestDictionary<Dictionary<int, int>, int>(keys, Path.Combine(resultDir, name + "_DICT.txt"), name, "Dictionary");
+                TestDictionary<SortedDictionary<int, int>, int>(keys, Path.Combine(resultDir, name + "_SORT_DICT.txt"), name, "SortedDictionary");
+            }
+            else
+            {
+                var keys = ReadKeysFromFile<string>(path, keyCount);
+                TestDictionary<Dictionary<string, int>, string>(keys, Path.Combine(resultDir, name + "_DICT.txt"), name, "Dictionary");
+                TestDictionary<SortedDictionary<string, int>, string>(keys, Path.Combine(resultDir, name + "_SORT_DICT.txt"), name, "SortedDictionary");
+            }
+        }
+
+        if (reportPath != null)
+        {
+            var json = new StringBuilder();
+            json.Append("{\n  \"environment\": {");
+            json.Append($"\"compiler\": \"{RuntimeInformation.FrameworkDescription}\", ");
+            json.Append($"\"flags\": \"{RuntimeInformation.ProcessArchitecture}\", ");
+            json.Append($"\"cpu\": \"{Environment.ProcessorCount} logical\", ");
+            json.Append($"\"host\": \"{Environment.MachineName}\", ");
+            json.Append($"\"timestamp\": \"{DateTime.UtcNow:yyyy-MM-ddTHH:mm:ssZ}\"}},\n");
+            json.Append("  \"results\": [\n    ");
+            json.Append(string.Join(",\n    ", ReportRecords));
+            json.Append("\n  ]\n}\n");
+            File.WriteAllText(reportPath, json.ToString());
+            Console.WriteLine($"Отчёт сохранён в {reportPath}");
+        }
+    }
+
+    private static void AddRecord(string dataset, string container, string operation, int size, string unit, IEnumerable<double> samples)
+    {
+        string values = string.Join(", ", samples.Select(v => v.ToString("R", CultureInfo.InvariantCulture)));
+        ReportRecords.Add($"{{\"benchmark\": \"tables\", \"container\": \"{container}\", \"dataset\": \"{dataset}\", " +
+                          $"\"operation\": \"{operation}\", \"size\": {size}, \"unit\": \"{unit}\", \"samples\": [{values}]}}");
+    }
+
     public static List<T> ReadKeysFromFile<T>(string filePath, int keyCount)
     {
         if (!File.Exists(filePath))
@@ -74,7 +160,8 @@ class Program
 
         
  
-    public static void TestDictionary<TDict, TKey>(List<TKey> allKeys, string outputFile)
+    public static void TestDictionary<TDict, TKey>(List<TKey> allKeys, string outputFile,
+                                                   string dataset = null, string container = null)
     where TDict : IDictionary<TKey, int>, new()
     {
         using (StreamWriter writer = new StreamWriter(outputFile))
@@ -83,10 +170,9 @@ class Program
             writer.WriteLine(new string('-', 96));
         }
 
-        var sizes = new[] { 10, 100, 1000, 10_000, 100_000, 1_000_000 };
-
-        foreach (var size in sizes)
+        for (int s = 0; s < Sizes.Length; s++)
         {
+            int size = Sizes[s];
             var keys = allKeys.Take(size).ToList();
 
             double totalInsertTime = 0;
@@ -97,7 +183,11 @@ class Program
             int sizeAfterInsert = 0;
             int sizeAfterDelete = 0;
 
-            int Iterations = size < 100 ? 1000 : size == 100 ? 100 : size <= 10_000 ? 10 : size == 100_000 ? 5 : 3;
+            var insertSamples = new List<double>();
+            var searchSamples = new List<double>();
+            var deleteSamples = new List<double>();
+
+            int Iterations = IterationCounts != null ? IterationCounts[s] : size < 100 ? 1000 : size == 100 ? 100 : size <= 10_000 ? 10 : size == 100_000 ? 5 : 3;
 
             for (int i = 0; i < Iterations; i++)
             {
@@ -118,6 +208,7 @@ class Program
 
                 insertWatch.Stop();
                 totalInsertTime += insertWatch.Elapsed.TotalSeconds * 1_000_000_000;
+                insertSamples.Add(insertWatch.Elapsed.TotalSeconds * 1_000_000_000);
 
                 // Измеряем память и размер только на последней итерации
                 if (i == Iterations - 1)
@@ -137,6 +228,7 @@ class Program
                 }
                 searchWatch.Stop();
                 totalSearchTime += searchWatch.Elapsed.TotalSeconds * 1_000_000_000;
+                searchSamples.Add(searchWatch.Elapsed.TotalSeconds * 1_000_000_000);
 
                 if (foundCount != size)
                 {
@@ -150,6 +242,7 @@ class Program
                 }
                 deleteWatch.Stop();
                 totalDeleteTime += deleteWatch.Elapsed.TotalSeconds * 1_000_000_000;
+                deleteSamples.Add(deleteWatch.Elapsed.TotalSeconds * 1_000_000_000);
 
                 if (i == Iterations - 1)
                 {
@@ -166,6 +259,14 @@ class Program
             string line = $"{size,10} | {avgInsert,12:F0} | {avgSearch,11:F0} | {avgDelete,10:F0} | {sizeAfterInsert,15} | {sizeAfterDelete,14} | {memoryUsed,12}";
 
             File.AppendAllText(outputFile, line + Environment.NewLine);
+
+            if (dataset != null)
+            {
+                AddRecord(dataset, container, "insert", size, "ns", insertSamples);
+                AddRecord(dataset, container, "find", size, "ns", searchSamples);
+                AddRecord(dataset, container, "erase", size, "ns", deleteSamples);
+                AddRecord(dataset, container, "memory", size, "bytes", new double[] { memoryUsed });
+            }
         }
     }
 
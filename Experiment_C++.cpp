@@ -8,22 +8,76 @@
 #include <string>
 #include <random>
 #include <algorithm>
-#include "Dictionary.h"       // Пользовательская хеш-таблица
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <list>
+#include <memory_resource>
+#include "Hash_Dictionary.h"  // Пользовательская хеш-таблица
 #include "RB_Dictionary.h"    // Пользовательское красно-черное дерево
-#include <windows.h>
-#include <psapi.h>
-
-// Функция для получения текущего потребления памяти процессом (в байтах)
-size_t get_current_memory_usage() {
-    PROCESS_MEMORY_COUNTERS_EX pmc;
-    if (GetProcessMemoryInfo(
-        GetCurrentProcess(),
-        reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc),
-        sizeof(pmc)
-    )) {
-        return pmc.PrivateUsage;
+#include "Eytzinger_Dictionary.h" // Неизменяемый снимок дерева в раскладке Эйтцингера
+#include "Mapped_Dictionary.h"    // Словари, читаемые из отображённого в память файла
+#include "Small_Dictionary.h"     // Режим малого размера для крошечных словарей
+#include "Concurrent_Dictionary.h" // Потокобезопасные обёртки: блокировка и разбиение на части
+#include "Bench_Memory.h"         // Точный учёт выделений памяти (заменяет operator new)
+#include "Bench_Counters.h"       // Аппаратные счётчики производительности (perf_event_open)
+#include "Bench_Histogram.h"      // Гистограммы задержек отдельных операций
+#include "Bench_Workload.h"       // Генератор смешанных нагрузок с перекосом распределения
+#include "Bench_Threads.h"        // Привязка потоков к процессорам и стартовый барьер
+#include "Bench_Report.h"         // Результаты в JSON/CSV с описанием окружения
+#include "Bench_Loader.h"         // Параллельная загрузка файлов ключей через отображение в память
+#include "Trace_Dictionary.h"     // Запись и воспроизведение трасс операций
+#include "Persistent_Dictionary.h" // Персистентное дерево со снимками за O(1)
+#include "Top_Down_Dictionary.h"   // Красно-чёрное дерево без указателей на родителя
+#include "Split_Dictionary.h"      // Ключи и значения в раздельных массивах
+#include "Cache_Dictionary.h"      // Кэш ограниченной ёмкости с вытеснением CLOCK
+#include "LSM_Dictionary.h"        // Упорядоченный словарь с выгрузкой на диск (LSM)
+#include "Packed_Dictionary.h"     // Упорядоченный словарь целых ключей со сжатием разностей
+#include "Huge_Page_Resource.h"    // Арена для узлов на больших страницах
+
+// Размеры наборов основных таблиц и число повторов для каждого из них. Значения по умолчанию
+// можно заменить параметрами sizes=... iterations=... (так run_benchmarks.py задаёт
+// одинаковые условия для C++, Python и C#)
+std::vector<size_t> tableSizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+std::vector<int> tableIterations;   // пусто — правило getIterations
+
+// Количество итераций в зависимости от размера набора данных
+int getIterations(size_t currentSize) {
+    for (size_t i = 0; i < tableIterations.size() && i < tableSizes.size(); ++i) {
+        if (tableSizes[i] == currentSize) {
+            return tableIterations[i];
+        }
+    }
+    return
+        (currentSize == 10) ? 1000 :
+        (currentSize == 100) ? 100 :
+        (currentSize <= 10000) ? 10 :
+        (currentSize == 100000) ? 5 : 3;
+}
+
+// Вставка с перезаписью для словарей проекта и для контейнеров std
+template<typename DictionaryType, typename KeyType, typename ValueType>
+inline void dictInsert(DictionaryType& dict, const KeyType& key, const ValueType& value) {
+    if constexpr (std::is_pointer_v<decltype(dict.find(key))>) {
+        dict.insert(key, value);
+    }
+    else {
+        dict[key] = value;
+    }
+}
+
+// Наличие ключа: словари проекта возвращают из find() указатель, контейнеры std — итератор
+template<typename DictionaryType, typename KeyType>
+inline bool dictContains(const DictionaryType& dict, const KeyType& key) {
+    if constexpr (std::is_pointer_v<decltype(dict.find(key))>) {
+        return dict.find(key) != nullptr;
+    }
+    else {
+        return dict.find(key) != dict.end();
     }
-    return 0;
 }
 
 /**
@@ -34,12 +88,17 @@ size_t get_current_memory_usage() {
  * @param testName Название теста для вывода
  * @param allKeys Все доступные ключи для тестирования
  * @param outputFile Путь к выходному файлу с результатами
+ * @param counters Аппаратные счётчики; если заданы, под основной таблицей
+ *                 выводятся их значения в пересчёте на одну операцию
+ * @param report Машиночитаемый отчёт; если задан, в него добавляются все повторы замеров
  */
 template<typename DictionaryType, typename KeyType>
 void benchmarkDictionary(
     const std::string& testName,
     const std::vector<KeyType>& allKeys,
-    const std::string& outputFile
+    const std::string& outputFile,
+    Perf_Counters* counters = nullptr,
+    Bench_Report* report = nullptr
 ) {
     std::ofstream outFile(outputFile);
     if (!outFile.is_open()) {
@@ -52,13 +111,23 @@ void benchmarkDictionary(
         << std::setw(12) << "Вставка (нс)" << " | "
         << std::setw(12) << "Поиск (нс)" << " | "
         << std::setw(12) << "Удаление (нс)" << " | "
-        << std::setw(12) << "Память (КБ)" << "\n";
-    outFile << std::string(70, '-') << "\n";
+        << std::setw(12) << "Память (КБ)" << " | "
+        << std::setw(10) << "Выделений" << " | "
+        << std::setw(10) << "RSS (КБ)" << "\n";
+    outFile << std::string(96, '-') << "\n";
 
-    // Размеры тестовых наборов данных
-    const std::vector<size_t> testSizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    // Таблица счётчиков собирается отдельно и дописывается после основной
+    std::ostringstream counterTable;
+    if (counters != nullptr && counters->available()) {
+        counterTable << std::setw(10) << "Элементы" << " | " << std::setw(8) << "Фаза";
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            counterTable << " | " << std::setw(13) << perf_event_name(e);
+        }
+        counterTable << " | " << std::setw(6) << "IPC" << "\n";
+        counterTable << std::string(132, '-') << "\n";
+    }
 
-    for (size_t currentSize : testSizes) {
+    for (size_t currentSize : tableSizes) {
         // Проверка достаточности ключей
         if (currentSize > allKeys.size()) {
             std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
@@ -69,21 +138,21 @@ void benchmarkDictionary(
         std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
 
         // Количество итераций в зависимости от размера
-        const int iterations =
-            (currentSize == 10) ? 1000 :
-            (currentSize == 100) ? 100 :
-            (currentSize <= 10000) ? 10 :
-            (currentSize == 100000) ? 5 : 3;
+        const int iterations = getIterations(currentSize);
 
         // Измерение времени операций
         double totalInsertTime = 0;
         double totalSearchTime = 0;
         double totalEraseTime = 0;
+        Perf_Values insertCounters, searchCounters, eraseCounters;
+        const bool withCounters = counters != nullptr && counters->available();
+        std::vector<double> insertSamples, searchSamples, eraseSamples;
 
         for (int i = 0; i < iterations; ++i) {
             DictionaryType dict;
 
             // Тест вставки
+            if (withCounters) counters->start();
             auto startTime = std::chrono::high_resolution_clock::now();
             for (const auto& key : testKeys) {
                 // Обработка разных интерфейсов словарей
@@ -96,10 +165,13 @@ void benchmarkDictionary(
                 }
             }
             auto endTime = std::chrono::high_resolution_clock::now();
-            totalInsertTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
-                endTime - startTime).count();
+            if (withCounters) insertCounters += counters->stop();
+            insertSamples.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count()));
+            totalInsertTime += insertSamples.back();
 
             // Тест поиска
+            if (withCounters) counters->start();
             startTime = std::chrono::high_resolution_clock::now();
             for (const auto& key : testKeys) {
                 if constexpr (std::is_same_v<DictionaryType, Dictionary<KeyType, int>> ||
@@ -115,54 +187,46 @@ void benchmarkDictionary(
                 }
             }
             endTime = std::chrono::high_resolution_clock::now();
-            totalSearchTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
-                endTime - startTime).count();
+            if (withCounters) searchCounters += counters->stop();
+            searchSamples.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count()));
+            totalSearchTime += searchSamples.back();
 
             // Тест удаления
+            if (withCounters) counters->start();
             startTime = std::chrono::high_resolution_clock::now();
             for (const auto& key : testKeys) {
                 dict.erase(key);
             }
             endTime = std::chrono::high_resolution_clock::now();
-            totalEraseTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
-                endTime - startTime).count();
+            if (withCounters) eraseCounters += counters->stop();
+            eraseSamples.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count()));
+            totalEraseTime += eraseSamples.back();
         }
 
-        // Измерение потребления памяти
-        const int memoryMeasurements = 5;
-        size_t totalMemoryUsage = 0;
-        int validMeasurements = 0;
-
-        for (int i = 0; i < memoryMeasurements; ++i) {
-            size_t startMem = get_current_memory_usage();
-            {
-                DictionaryType dict;
-                for (const auto& key : testKeys) {
-                    if constexpr (std::is_same_v<DictionaryType, Dictionary<KeyType, int>> ||
-                        std::is_same_v<DictionaryType, RB_Dictionary<KeyType, int>>) {
-                        dict.insert(key, 1);
-                    }
-                    else {
-                        dict[key] = 1;
-                    }
+        // Измерение памяти: точные байты и число выделений по счётчикам operator new,
+        // резидентная память процесса — как вторичная оценка
+        Memory_Usage memoryUsage;
+        size_t rssGrowth = 0;
+        {
+            size_t startRss = current_rss_bytes();
+            Memory_Snapshot startMem = memory_snapshot();
+            DictionaryType dict;
+            for (const auto& key : testKeys) {
+                if constexpr (std::is_same_v<DictionaryType, Dictionary<KeyType, int>> ||
+                    std::is_same_v<DictionaryType, RB_Dictionary<KeyType, int>>) {
+                    dict.insert(key, 1);
                 }
-                size_t endMem = get_current_memory_usage();
-
-                if (endMem > startMem) {
-                    totalMemoryUsage += (endMem - startMem);
-                    validMeasurements++;
+                else {
+                    dict[key] = 1;
                 }
             }
-            // Пауза для стабилизации памяти
-            if (i < memoryMeasurements - 1) {
-                Sleep(5000);
-            }
+            memoryUsage = memory_since(startMem);
+            size_t endRss = current_rss_bytes();
+            rssGrowth = endRss > startRss ? endRss - startRss : 0;
         }
 
-        size_t avgMemoryUsage = validMeasurements > 0
-            ? totalMemoryUsage / validMeasurements
-            : 0;
-
         // Расчет среднего времени операций
         double avgInsertTime = totalInsertTime / iterations;
         double avgSearchTime = totalSearchTime / iterations;
@@ -173,7 +237,52 @@ void benchmarkDictionary(
             << std::setw(12) << static_cast<uint64_t>(avgInsertTime) << " | "
             << std::setw(12) << static_cast<uint64_t>(avgSearchTime) << " | "
             << std::setw(12) << static_cast<uint64_t>(avgEraseTime) << " | "
-            << std::setw(12) << (avgMemoryUsage / 1024) << "\n";
+            << std::setw(12) << (memoryUsage.bytes / 1024) << " | "
+            << std::setw(10) << memoryUsage.allocations << " | "
+            << std::setw(10) << (rssGrowth / 1024) << "\n";
+
+        // Те же поля в машиночитаемый отчёт: время — все повторы, память — один точный замер
+        if (report != nullptr) {
+            const std::string benchmark = counters != nullptr ? "counters" : "tables";
+            report->add({ benchmark, testName, "", "insert", currentSize, "ns", insertSamples });
+            report->add({ benchmark, testName, "", "find", currentSize, "ns", searchSamples });
+            report->add({ benchmark, testName, "", "erase", currentSize, "ns", eraseSamples });
+            report->add({ benchmark, testName, "", "memory", currentSize, "bytes", { double(memoryUsage.bytes) } });
+            report->add({ benchmark, testName, "", "allocations", currentSize, "count", { double(memoryUsage.allocations) } });
+            report->add({ benchmark, testName, "", "rss", currentSize, "bytes", { double(rssGrowth) } });
+        }
+
+        // Счётчики на одну операцию; недоступное событие выводится как «-»
+        if (withCounters) {
+            const double operations = double(currentSize) * iterations;
+            const std::pair<const char*, const Perf_Values*> phases[] = {
+                { "Вставка", &insertCounters }, { "Поиск", &searchCounters }, { "Удаление", &eraseCounters }
+            };
+            for (const auto& phase : phases) {
+                const Perf_Values& v = *phase.second;
+                counterTable << std::setw(10) << currentSize << " | " << std::setw(8) << phase.first
+                    << std::fixed << std::setprecision(2);
+                for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                    counterTable << " | " << std::setw(13);
+                    if (v.valid[e]) counterTable << v.value[e] / operations;
+                    else counterTable << "-";
+                }
+                counterTable << " | " << std::setw(6);
+                if (v.valid[PERF_CYCLES] && v.valid[PERF_INSTRUCTIONS] && v.value[PERF_CYCLES] > 0)
+                    counterTable << v.value[PERF_INSTRUCTIONS] / v.value[PERF_CYCLES] << "\n";
+                else
+                    counterTable << "-" << "\n";
+            }
+        }
+    }
+
+    if (counters != nullptr) {
+        if (counters->available()) {
+            outFile << "\nАппаратные счётчики на одну операцию\n" << counterTable.str();
+        }
+        else {
+            outFile << "\nАппаратные счётчики: " << counters->last_error() << "\n";
+        }
     }
 
     outFile.close();
@@ -181,73 +290,3014 @@ void benchmarkDictionary(
 }
 
 /**
- * Загружает вектор данных из файла.
+ * Сравнивает поиск в красно-черном дереве и в его снимке Эйтцингера.
  *
- * @param filename Путь к файлу с данными
- * @param dataVector Вектор для загрузки данных
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
  */
-template<typename T>
-void loadVectorFromFile(const std::string& filename, std::vector<T>& dataVector) {
-    std::ifstream inputFile(filename);
-    if (!inputFile.is_open()) {
-        std::cerr << "Ошибка открытия файла: " << filename << "\n";
+template<typename KeyType>
+void benchmarkSnapshot(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
         return;
     }
 
-    dataVector.clear();
-    T value;
-    while (inputFile >> value) {
-        dataVector.push_back(value);
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(14) << "Сборка (нс)" << " | "
+        << std::setw(14) << "Дерево (нс)" << " | "
+        << std::setw(14) << "Снимок (нс)" << " | "
+        << std::setw(16) << "lower_bound (нс)" << " | "
+        << std::setw(14) << "rank (нс)" << "\n";
+    outFile << std::string(96, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+
+        RB_Dictionary<KeyType, int> tree;
+        for (const auto& key : testKeys) {
+            tree.insert(key, 1);
+        }
+
+        double totalFreezeTime = 0;
+        double totalTreeTime = 0;
+        double totalSnapshotTime = 0;
+        double totalLowerBoundTime = 0;
+        double totalRankTime = 0;
+        size_t checksum = 0; // не дает компилятору выбросить циклы поиска
+
+        for (int i = 0; i < iterations; ++i) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            Eytzinger_Dictionary<KeyType, int> snapshot = tree.freeze();
+            auto endTime = std::chrono::high_resolution_clock::now();
+            totalFreezeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Поиск в дереве с указателями
+            startTime = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                checksum += *tree.find(key);
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalTreeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Поиск в снимке
+            startTime = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                const int* value = snapshot.find(key);
+                if (!value) {
+                    std::cerr << "Ключ не найден: " << key << "\n";
+                    continue;
+                }
+                checksum += *value;
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalSnapshotTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            startTime = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                checksum += snapshot.lower_bound(key) != nullptr;
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalLowerBoundTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            startTime = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                checksum += snapshot.rank(key);
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalRankTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+        }
+
+        outFile << std::setw(10) << currentSize << " | "
+            << std::setw(14) << static_cast<uint64_t>(totalFreezeTime / iterations) << " | "
+            << std::setw(14) << static_cast<uint64_t>(totalTreeTime / iterations) << " | "
+            << std::setw(14) << static_cast<uint64_t>(totalSnapshotTime / iterations) << " | "
+            << std::setw(16) << static_cast<uint64_t>(totalLowerBoundTime / iterations) << " | "
+            << std::setw(14) << static_cast<uint64_t>(totalRankTime / iterations) << "\n";
+
+        if (checksum == 0) {
+            std::cerr << "Пустая контрольная сумма для размера " << currentSize << "\n";
+        }
     }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
 }
 
-int main() {
-    setlocale(LC_ALL, "RU");
-    const size_t MAX_KEYS = 1'000'000;
+/**
+ * Сравнивает персистентное дерево с RB_Dictionary и стоимость согласованной копии:
+ * snapshot() за O(1) против полного копирования std::map. Отдельно измеряется запись,
+ * когда снимок берётся каждые snapshotEvery операций и пути приходится копировать.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkPersistent(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
 
-    // Пути к тестовым данным
-    const std::string basePath = "test_results/";
-    const std::vector<std::string> keyFiles = {
-        "random_keys.txt", "decreasing_str_key.txt", "increasing_str_key.txt",
-        "shuffled_numbers.txt", "decreasing_int_key.txt", "increasing_int_key.txt"
+    const size_t snapshotEvery = 100;
+    outFile << "Время операции (нс); запись со снимками — снимок каждые " << snapshotEvery << " операций\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(10) << "Вставка RB" << " | "
+        << std::setw(12) << "Вставка перс." << " | "
+        << std::setw(10) << "Поиск RB" << " | "
+        << std::setw(12) << "Поиск перс." << " | "
+        << std::setw(12) << "snapshot()" << " | "
+        << std::setw(14) << "Копия std::map" << " | "
+        << std::setw(14) << "Запись+снимки" << " | "
+        << std::setw(12) << "Копий узлов" << "\n";
+    outFile << std::string(132, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 1000, 10000, 100000, 1000000 };
+    auto elapsed = [](auto start) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - start).count());
     };
 
-    // Тестирование со строковыми ключами
-    for (int i = 0; i < 3; ++i) {
-        std::vector<std::string> stringKeys;
-        stringKeys.reserve(MAX_KEYS);
-        loadVectorFromFile(keyFiles[i], stringKeys);
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+        double treeInsert = 0, persistentInsert = 0, treeFind = 0, persistentFind = 0;
+        double snapshotTime = 0, copyTime = 0, sharedWrite = 0, copiedPerWrite = 0;
+        size_t checksum = 0;
 
-        std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
-        std::string filePrefix = basePath + testName;
+        for (int i = 0; i < iterations; ++i) {
+            RB_Dictionary<KeyType, int> tree;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                tree.insert(key, 1);
+            }
+            treeInsert += elapsed(start);
 
-        benchmarkDictionary<Dictionary<std::string, int>>(
-            "HashTable", stringKeys, filePrefix + "_hash_dict.txt");
-        benchmarkDictionary<std::unordered_map<std::string, int>>(
-            "StdHashMap", stringKeys, filePrefix + "_unordered_map.txt");
-        benchmarkDictionary<RB_Dictionary<std::string, int>>(
-            "RedBlackTree", stringKeys, filePrefix + "_rb_dict.txt");
-        benchmarkDictionary<std::map<std::string, int>>(
-            "StdTreeMap", stringKeys, filePrefix + "_std_map.txt");
+            Persistent_RB_Dictionary<KeyType, int> persistent;
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                persistent.insert(key, 1);
+            }
+            persistentInsert += elapsed(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                checksum += *tree.find(key);
+            }
+            treeFind += elapsed(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                checksum += *persistent.find(key);
+            }
+            persistentFind += elapsed(start);
+
+            // Согласованная копия: снимок против полного копирования
+            const int snapshots = 1000;
+            start = std::chrono::high_resolution_clock::now();
+            for (int j = 0; j < snapshots; ++j) {
+                RB_Snapshot<KeyType, int> snapshot = persistent.snapshot();
+                checksum += snapshot.size();
+            }
+            snapshotTime += elapsed(start) / snapshots;
+
+            std::map<KeyType, int> source;
+            for (const auto& key : testKeys) {
+                source.emplace(key, 1);
+            }
+            start = std::chrono::high_resolution_clock::now();
+            {
+                std::map<KeyType, int> copy(source);
+                checksum += copy.size();
+            }
+            copyTime += elapsed(start);
+
+            // Обновления при живых снимках: каждое копирует путь от корня
+            const size_t copiedBefore = persistent.copied_nodes();
+            std::vector<RB_Snapshot<KeyType, int>> versions;
+            start = std::chrono::high_resolution_clock::now();
+            for (size_t j = 0; j < testKeys.size(); ++j) {
+                if (j % snapshotEvery == 0) {
+                    versions.push_back(persistent.snapshot());
+                }
+                persistent.insert(testKeys[j], 2);
+            }
+            sharedWrite += elapsed(start);
+            copiedPerWrite += double(persistent.copied_nodes() - copiedBefore) / double(testKeys.size());
+            tree.clear();
+        }
+
+        outFile << std::setw(10) << currentSize << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << treeInsert / iterations / currentSize << " | "
+            << std::setw(12) << persistentInsert / iterations / currentSize << " | "
+            << std::setw(10) << treeFind / iterations / currentSize << " | "
+            << std::setw(12) << persistentFind / iterations / currentSize << " | "
+            << std::setw(12) << snapshotTime / iterations << " | "
+            << std::setw(14) << copyTime / iterations << " | "
+            << std::setw(14) << sharedWrite / iterations / currentSize << " | "
+            << std::setw(12) << copiedPerWrite / iterations << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+
+        if (checksum == 0) {
+            std::cerr << "Пустая контрольная сумма для размера " << currentSize << "\n";
+        }
     }
 
-    // Тестирование с целочисленными ключами
-    for (int i = 3; i < 6; ++i) {
-        std::vector<int> intKeys;
-        intKeys.reserve(MAX_KEYS);
-        loadVectorFromFile(keyFiles[i], intKeys);
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
 
-        std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
-        std::string filePrefix = basePath + testName;
+/**
+ * Кэш с вытеснением LRU «вручную»: Dictionary и список ключей в порядке обращений.
+ * Используется как база для сравнения с Cache_Dictionary.
+ */
+template<typename KeyType, typename ValueType>
+class Manual_LRU_Cache {
+    using Order = std::list<std::pair<KeyType, ValueType>>;
+    Order order;   // от недавно использованных к давно использованным
+    Dictionary<KeyType, typename Order::iterator> index;
+    size_t limit;
 
-        benchmarkDictionary<Dictionary<int, int>>(
-            "HashTable", intKeys, filePrefix + "_hash_dict.txt");
-        benchmarkDictionary<std::unordered_map<int, int>>(
-            "StdHashMap", intKeys, filePrefix + "_unordered_map.txt");
-        benchmarkDictionary<RB_Dictionary<int, int>>(
-            "RedBlackTree", intKeys, filePrefix + "_rb_dict.txt");
-        benchmarkDictionary<std::map<int, int>>(
-            "StdTreeMap", intKeys, filePrefix + "_std_map.txt");
+public:
+    explicit Manual_LRU_Cache(size_t capacity) : limit(capacity) {
+    }
+
+    ~Manual_LRU_Cache() {
+        index.clear();
+    }
+
+    ValueType* find(const KeyType& key) {
+        typename Order::iterator* position = index.find(key);
+        if (position == nullptr) {
+            return nullptr;
+        }
+        order.splice(order.begin(), order, *position);
+        return &order.front().second;
+    }
+
+    void insert(const KeyType& key, const ValueType& value) {
+        if (ValueType* existing = find(key)) {
+            *existing = value;
+            return;
+        }
+        if (order.size() == limit) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+        order.emplace_front(key, value);
+        index.insert(key, order.begin());
+    }
+};
+
+/**
+ * Доля попаданий и пропускная способность кэша под нагрузкой по закону Ципфа:
+ * обращение — find(), при промахе — insert(). CLOCK (Cache_Dictionary) сравнивается
+ * с LRU на Dictionary и связном списке.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования (номер ключа — ранг по Ципфу)
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkCache(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const size_t universe = std::min<size_t>(allKeys.size(), 1000000);
+    const size_t accesses = 2000000;
+    outFile << "Ключей всего: " << universe << ", обращений: " << accesses
+        << "; попадания — %, скорость — млн обращений в секунду\n";
+    outFile << std::setw(10) << "Ёмкость" << " | "
+        << std::setw(6) << "theta" << " | "
+        << std::setw(12) << "CLOCK, %" << " | "
+        << std::setw(12) << "LRU, %" << " | "
+        << std::setw(12) << "CLOCK, Mops" << " | "
+        << std::setw(12) << "LRU, Mops" << "\n";
+    outFile << std::string(80, '-') << "\n";
+
+    for (double theta : { 0.5, 0.8, 0.99 }) {
+        // Последовательность обращений одна для всех ёмкостей и обоих кэшей
+        Zipf_Generator zipf(universe, theta);
+        std::mt19937_64 rng(42);
+        std::vector<uint32_t> ranks(accesses);
+        for (auto& rank : ranks) {
+            rank = static_cast<uint32_t>(zipf.next(rng));
+        }
+
+        for (size_t capacity : { universe / 100, universe / 10 }) {
+            auto run = [&](auto& cache) {
+                size_t hits = 0;
+                auto start = std::chrono::high_resolution_clock::now();
+                for (uint32_t rank : ranks) {
+                    const KeyType& key = allKeys[rank];
+                    if (cache.find(key) != nullptr) {
+                        ++hits;
+                    }
+                    else {
+                        cache.insert(key, int(rank));
+                    }
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                double seconds = std::chrono::duration<double>(end - start).count();
+                return std::make_pair(100.0 * double(hits) / double(accesses), double(accesses) / 1e6 / seconds);
+            };
+
+            Cache_Dictionary<KeyType, int> clock(capacity);
+            auto clockResult = run(clock);
+            if (std::abs(clock.stats().hit_ratio * 100.0 - clockResult.first) > 1e-9) {
+                std::cerr << "Счётчики кэша разошлись с замером\n";
+            }
+            Manual_LRU_Cache<KeyType, int> lru(capacity);
+            auto lruResult = run(lru);
+
+            outFile << std::setw(10) << capacity << " | " << std::fixed << std::setprecision(2)
+                << std::setw(6) << theta << " | "
+                << std::setw(12) << clockResult.first << " | "
+                << std::setw(12) << lruResult.first << " | "
+                << std::setw(12) << clockResult.second << " | "
+                << std::setw(12) << lruResult.second << "\n";
+            outFile.unsetf(std::ios::fixed);
+            outFile << std::setprecision(6);
+        }
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * LSM_Dictionary против RB_Dictionary в памяти. Бюджет памяти-таблицы подбирается так,
+ * чтобы данные были в 1, 4 и 16 раз больше него («оперативной памяти»); остальное
+ * лежит в файлах прогонов. Замеряются вставка всех ключей и поиск случайных ключей.
+ * Файлы читаются через страничный кэш ОС, так что поиск в основном меряет
+ * чтение блока и его разбор, а не задержку диска.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param filePrefix Начало имён временных файлов прогонов
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkLSM(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& filePrefix,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const size_t lookups = std::min<size_t>(allKeys.size(), 200000);
+    std::vector<KeyType> probes(allKeys.begin(), allKeys.end());
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(42));
+    probes.resize(lookups);
+
+    outFile << "Ключей: " << allKeys.size() << ", поисков: " << lookups
+        << "; время — нс на операцию\n";
+    outFile << std::setw(22) << "Словарь" << " | "
+        << std::setw(10) << "Вставка" << " | "
+        << std::setw(10) << "Поиск" << " | "
+        << std::setw(8) << "Прогонов" << " | "
+        << std::setw(10) << "Диск, МБ" << " | "
+        << std::setw(12) << "Блоков/поиск" << "\n";
+    outFile << std::string(86, '-') << "\n";
+
+    auto writeRow = [&](const std::string& name, double insertTime, double findTime,
+                        size_t runs, double diskMb, double blocksPerFind) {
+        outFile << std::setw(22) << name << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << insertTime << " | "
+            << std::setw(10) << findTime << " | "
+            << std::setw(8) << runs << " | "
+            << std::setw(10) << diskMb << " | " << std::setprecision(2)
+            << std::setw(12) << blocksPerFind << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    };
+
+    {
+        RB_Dictionary<KeyType, int> tree;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < allKeys.size(); ++i) {
+            tree.insert(allKeys[i], int(i));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double insertTime = std::chrono::duration<double, std::nano>(end - start).count() / allKeys.size();
+
+        size_t found = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& key : probes) {
+            found += tree.find(key) != nullptr;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double findTime = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+        if (found != lookups) {
+            std::cerr << "RB_Dictionary: найдены не все ключи\n";
+        }
+        writeRow("RB_Dictionary", insertTime, findTime, 0, 0, 0);
+    }
+
+    const size_t dataBytes = allKeys.size() * RB_Dictionary<KeyType, int>::node_bytes();
+    for (size_t ratio : { 1, 4, 16 }) {
+        LSM_Config config;
+        // При 1x память-таблица вмещает все данные; запас — на узел надгробия и округление
+        config.memtable_bytes = dataBytes / ratio + (ratio == 1 ? dataBytes / 2 : 0);
+        LSM_Dictionary<KeyType, int> lsm(filePrefix, config);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < allKeys.size(); ++i) {
+            lsm.insert(allKeys[i], int(i));
+        }
+        lsm.wait_compaction();
+        auto end = std::chrono::high_resolution_clock::now();
+        double insertTime = std::chrono::duration<double, std::nano>(end - start).count() / allKeys.size();
+
+        size_t blocksBefore = lsm.stats().blocks_read;
+        size_t found = 0;
+        int value;
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& key : probes) {
+            found += lsm.find(key, value);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double findTime = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+        if (found != lookups || !lsm.ok()) {
+            std::cerr << "LSM_Dictionary: найдены не все ключи или ошибка ввода-вывода\n";
+        }
+
+        LSM_Stats stats = lsm.stats();
+        writeRow("LSM, данные = " + std::to_string(ratio) + "x", insertTime, findTime, stats.run_count,
+            double(stats.disk_bytes) / (1 << 20), double(stats.blocks_read - blocksBefore) / lookups);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+// Значение заданного размера для замеров раскладки
+template<size_t Bytes>
+struct Payload {
+    unsigned char data[Bytes] = {};
+};
+
+/**
+ * Время вставки и поиска (нс на операцию) для одного словаря со значениями Payload<Bytes>.
+ * При поиске читается первый байт найденного значения.
+ */
+template<typename DictionaryType, typename KeyType>
+std::pair<double, double> measureLayout(const std::vector<KeyType>& keys, int iterations) {
+    double insertTime = 0, findTime = 0;
+    size_t checksum = 0;
+    for (int i = 0; i < iterations; ++i) {
+        DictionaryType dict;
+        typename std::remove_pointer<decltype(dict.find(keys[0]))>::type value;
+        value.data[0] = 1;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto& key : keys) {
+            dict.insert(key, value);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        insertTime += std::chrono::duration<double, std::nano>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& key : keys) {
+            checksum += dict.find(key)->data[0];
+        }
+        end = std::chrono::high_resolution_clock::now();
+        findTime += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    const double operations = double(iterations) * double(keys.size());
+    if (checksum != size_t(operations)) {
+        std::cerr << "Поиск вернул не все ключи\n";
+    }
+    return { insertTime / operations, findTime / operations };
+}
+
+/**
+ * Строка таблицы benchmarkSplitLayout для значений размера Bytes: обычные узлы
+ * (ключ и значение рядом) против раздельных массивов ключей и значений.
+ */
+template<size_t Bytes, typename KeyType>
+void writeLayoutRow(std::ofstream& outFile, const std::vector<KeyType>& keys) {
+    const int iterations = getIterations(keys.size());
+    auto hash = measureLayout<Dictionary<KeyType, Payload<Bytes>>>(keys, iterations);
+    auto splitHash = measureLayout<Split_Hash_Dictionary<KeyType, Payload<Bytes>>>(keys, iterations);
+    auto tree = measureLayout<RB_Dictionary<KeyType, Payload<Bytes>>>(keys, iterations);
+    auto splitTree = measureLayout<Split_RB_Dictionary<KeyType, Payload<Bytes>>>(keys, iterations);
+
+    outFile << std::setw(8) << Bytes << " | "
+        << std::setw(10) << keys.size() << " | " << std::fixed << std::setprecision(1)
+        << std::setw(10) << hash.first << " | "
+        << std::setw(10) << splitHash.first << " | "
+        << std::setw(10) << tree.first << " | "
+        << std::setw(10) << splitTree.first << " | "
+        << std::setw(10) << hash.second << " | "
+        << std::setw(10) << splitHash.second << " | "
+        << std::setw(10) << tree.second << " | "
+        << std::setw(10) << splitTree.second << "\n";
+    outFile.unsetf(std::ios::fixed);
+    outFile << std::setprecision(6);
+}
+
+/**
+ * Сравнивает раскладку «ключ и значение в одном узле» (Dictionary, RB_Dictionary)
+ * с раздельными массивами горячих ключей и холодных значений (Split_Dictionary.h)
+ * при значениях 4, 64 и 256 байт.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkSplitLayout(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << "Время операции (нс); SoA — ключи и значения в раздельных массивах\n";
+    outFile << std::setw(8) << "Значение" << " | "
+        << std::setw(10) << "Элементы" << " | "
+        << std::setw(10) << "Вст. хэш" << " | "
+        << std::setw(10) << "Вст. SoA-х" << " | "
+        << std::setw(10) << "Вст. RB" << " | "
+        << std::setw(10) << "Вст. SoA-RB" << " | "
+        << std::setw(10) << "Поиск хэш" << " | "
+        << std::setw(10) << "Поиск SoA-х" << " | "
+        << std::setw(10) << "Поиск RB" << " | "
+        << std::setw(10) << "Поиск SoA-RB" << "\n";
+    outFile << std::string(130, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 10000, 100000, 1000000 };
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        writeLayoutRow<4>(outFile, testKeys);
+        writeLayoutRow<64>(outFile, testKeys);
+        writeLayoutRow<256>(outFile, testKeys);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+// Откуда берут память короткоживущие словари в benchmarkShortLived
+enum class Resource_Kind {
+    HEAP,          // обычные new/delete
+    SHARED_POOL,   // один unsynchronized_pool_resource на все словари
+    ARENA          // monotonic_buffer_resource на запрос, сбрасывается целиком
+};
+
+/**
+ * Прогоняет requests «запросов»: в каждом живут perRequest словарей по dictSize ключей,
+ * в них вставляют ключи и ищут каждый ключ, затем словари уничтожаются.
+ * На арене деструкторы словарей возвращают узлы в monotonic_buffer_resource, где это ничего
+ * не стоит, а сама память сбрасывается вместе с ареной.
+ *
+ * @return Время в наносекундах на один элемент
+ */
+template<typename DictionaryType, typename KeyType>
+double runShortLived(
+    const std::vector<KeyType>& keys,
+    size_t dictSize,
+    size_t perRequest,
+    size_t requests,
+    Resource_Kind kind
+) {
+    std::pmr::unsynchronized_pool_resource sharedPool;
+    std::vector<std::byte> arenaBuffer(kind == Resource_Kind::ARENA ? perRequest * dictSize * 128 + (1 << 16) : 0);
+    std::vector<std::optional<DictionaryType>> dicts(perRequest);
+    size_t checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t request = 0; request < requests; ++request) {
+        std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+        std::pmr::memory_resource* resource =
+            kind == Resource_Kind::ARENA ? static_cast<std::pmr::memory_resource*>(&arena) :
+            kind == Resource_Kind::SHARED_POOL ? static_cast<std::pmr::memory_resource*>(&sharedPool) :
+            std::pmr::get_default_resource();
+
+        for (size_t d = 0; d < perRequest; ++d) {
+            dicts[d].emplace(resource);
+            size_t first = ((request * perRequest + d) * dictSize) % (keys.size() - dictSize + 1);
+            for (size_t i = first; i < first + dictSize; ++i) {
+                dicts[d]->insert(keys[i], 1);
+            }
+            for (size_t i = first; i < first + dictSize; ++i) {
+                checksum += *dicts[d]->find(keys[i]);
+            }
+        }
+        for (size_t d = 0; d < perRequest; ++d) {
+            dicts[d].reset();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    const double elements = double(requests) * double(perRequest) * double(dictSize);
+    if (checksum != size_t(elements)) {
+        std::cerr << "Поиск вернул не все ключи\n";
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() / elements;
+}
+
+/**
+ * Тысячи короткоживущих словарей: сравнение обычных new/delete, общего пула
+ * для всех словарей и арены на запрос, которая освобождается целиком.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkShortLived(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const size_t perRequest = 16;
+    const size_t totalElements = 1000000;
+    outFile << "Время на элемент (нс): вставка, поиск и освобождение; словарей в запросе: " << perRequest << "\n";
+    outFile << std::setw(10) << "Ключей" << " | "
+        << std::setw(10) << "Словарей" << " | "
+        << std::setw(10) << "Хэш new" << " | "
+        << std::setw(10) << "Хэш пул" << " | "
+        << std::setw(12) << "Хэш арена" << " | "
+        << std::setw(12) << "Дерево new" << " | "
+        << std::setw(12) << "Дерево пул" << " | "
+        << std::setw(14) << "Дерево арена" << "\n";
+    outFile << std::string(108, '-') << "\n";
+
+    using Hash = Dictionary<KeyType, int>;
+    using Tree = RB_Dictionary<KeyType, int>;
+    const std::vector<size_t> dictSizes = { 10, 100, 1000 };
+    for (size_t dictSize : dictSizes) {
+        if (dictSize > allKeys.size()) {
+            continue;
+        }
+        const size_t requests = std::max<size_t>(1, totalElements / (perRequest * dictSize));
+        outFile << std::setw(10) << dictSize << " | "
+            << std::setw(10) << requests * perRequest << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << runShortLived<Hash>(allKeys, dictSize, perRequest, requests, Resource_Kind::HEAP) << " | "
+            << std::setw(10) << runShortLived<Hash>(allKeys, dictSize, perRequest, requests, Resource_Kind::SHARED_POOL) << " | "
+            << std::setw(12) << runShortLived<Hash>(allKeys, dictSize, perRequest, requests, Resource_Kind::ARENA) << " | "
+            << std::setw(12) << runShortLived<Tree>(allKeys, dictSize, perRequest, requests, Resource_Kind::HEAP) << " | "
+            << std::setw(12) << runShortLived<Tree>(allKeys, dictSize, perRequest, requests, Resource_Kind::SHARED_POOL) << " | "
+            << std::setw(14) << runShortLived<Tree>(allKeys, dictSize, perRequest, requests, Resource_Kind::ARENA) << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+// Объём анонимной памяти процесса на прозрачных больших страницах (КиБ); 0, если неизвестно
+size_t anonHugePagesKb() {
+    size_t total = 0;
+#if defined(__linux__)
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(smaps, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            total += std::stoul(line.substr(14));
+        }
+    }
+#endif
+    return total;
+}
+
+// Результат measureHugePages
+struct Huge_Page_Sample {
+    double findTime = 0;      // нс на поиск
+    double dtlbMisses = -1;   // промахов dTLB на поиск; -1 — счётчик недоступен
+    double hugeMb = 0;        // прирост памяти на прозрачных больших страницах, МиБ
+};
+
+/**
+ * Строит словарь из keys с памятью из resource и замеряет поиск по probes
+ * вместе с промахами dTLB.
+ */
+template<typename DictionaryType>
+Huge_Page_Sample measureHugePages(
+    const std::vector<int>& keys,
+    const std::vector<int>& probes,
+    std::pmr::memory_resource* resource,
+    Perf_Counters& counters
+) {
+    Huge_Page_Sample sample;
+    size_t hugeBefore = anonHugePagesKb();
+    DictionaryType dict(resource);
+    for (int key : keys) {
+        dict.insert(key, 1);
+    }
+    sample.hugeMb = double(anonHugePagesKb()) / 1024 - double(hugeBefore) / 1024;
+
+    size_t checksum = 0;
+    counters.start();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : probes) {
+        checksum += *dict.find(key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    Perf_Values values = counters.stop();
+    if (checksum != probes.size()) {
+        std::cerr << "Поиск вернул не все ключи\n";
+    }
+    sample.findTime = std::chrono::duration<double, std::nano>(end - start).count() / probes.size();
+    if (values.valid[PERF_DTLB_MISSES]) {
+        sample.dtlbMisses = values.value[PERF_DTLB_MISSES] / probes.size();
+    }
+    return sample;
+}
+
+// Замеры measureHugePages для new, арены на страницах 4 КиБ и арены на страницах 2 МиБ
+template<typename DictionaryType>
+std::vector<Huge_Page_Sample> measureHugePageModes(
+    const std::vector<int>& keys,
+    const std::vector<int>& probes,
+    Perf_Counters& counters
+) {
+    std::vector<Huge_Page_Sample> samples;
+    samples.push_back(measureHugePages<DictionaryType>(keys, probes, std::pmr::get_default_resource(), counters));
+    {
+        Huge_Page_Resource small(HUGE_PAGES_OFF);
+        samples.push_back(measureHugePages<DictionaryType>(keys, probes, &small, counters));
+    }
+    {
+        Huge_Page_Resource huge(HUGE_PAGES_AUTO);
+        samples.push_back(measureHugePages<DictionaryType>(keys, probes, &huge, counters));
+    }
+    return samples;
+}
+
+/**
+ * Поиск в больших словарях (1 и 10 млн элементов) при трёх источниках памяти для узлов:
+ * обычный new, арена Huge_Page_Resource на страницах 4 КиБ и та же арена на страницах 2 МиБ.
+ * Ключи — перемешанные числа 0..n-1, поиск — 2 млн случайных существующих ключей.
+ *
+ * @param testName Название теста для вывода
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+void benchmarkHugePages(
+    const std::string& testName,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    // Какие большие страницы даёт система: пробный кусок арены
+    Huge_Page_Stats available;
+    {
+        Huge_Page_Resource probe(HUGE_PAGES_AUTO);
+        probe.deallocate(probe.allocate(64), 64);
+        available = probe.stats();
+    }
+    outFile << "Большие страницы: " << (available.explicit_chunks ? "MAP_HUGETLB" :
+        available.transparent_chunks ? "прозрачные (madvise)" : "недоступны, арена берёт обычные") << "\n";
+
+    const char* memoryNames[] = { "new", "арена 4 КиБ", "арена 2 МиБ" };
+    Perf_Counters counters;
+    outFile << "Поиск — нс на операцию; dTLB — промахов на поиск; "
+        << "Большие стр. — прирост AnonHugePages при построении, МиБ\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(14) << "Словарь" << " | "
+        << std::setw(14) << "Память" << " | "
+        << std::setw(10) << "Поиск" << " | "
+        << std::setw(10) << "dTLB" << " | "
+        << std::setw(12) << "Большие стр." << "\n";
+    outFile << std::string(86, '-') << "\n";
+
+    auto writeRow = [&](size_t size, const char* dictName, const char* memoryName, const Huge_Page_Sample& sample) {
+        outFile << std::setw(10) << size << " | "
+            << std::setw(14) << dictName << " | "
+            << std::setw(14) << memoryName << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << sample.findTime << " | " << std::setprecision(2) << std::setw(10);
+        if (sample.dtlbMisses >= 0) outFile << sample.dtlbMisses;
+        else outFile << "-";
+        outFile << " | " << std::setprecision(0) << std::setw(12) << sample.hugeMb << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    };
+
+    const size_t probeCount = 2000000;
+    for (size_t size : { size_t(1000000), size_t(10000000) }) {
+        std::vector<int> keys(size);
+        for (size_t i = 0; i < size; ++i) {
+            keys[i] = int(i);
+        }
+        std::mt19937 rng(42);
+        std::shuffle(keys.begin(), keys.end(), rng);
+        std::vector<int> probes(probeCount);
+        for (auto& probe : probes) {
+            probe = keys[rng() % size];
+        }
+
+        auto rbSamples = measureHugePageModes<RB_Dictionary<int, int>>(keys, probes, counters);
+        for (size_t i = 0; i < rbSamples.size(); ++i) {
+            writeRow(size, "RB_Dictionary", memoryNames[i], rbSamples[i]);
+        }
+        auto hashSamples = measureHugePageModes<Dictionary<int, int>>(keys, probes, counters);
+        for (size_t i = 0; i < hashSamples.size(); ++i) {
+            writeRow(size, "Dictionary", memoryNames[i], hashSamples[i]);
+        }
+    }
+
+    if (!counters.available()) {
+        outFile << "\nАппаратные счётчики: " << counters.last_error() << "\n";
+    }
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Замеры одного дерева для benchmarkTopDown: память на элемент (байт) по учёту выделений,
+ * время вставки, поиска и удаления (нс на операцию).
+ */
+struct Tree_Sample {
+    double bytes = 0;
+    double insertTime = 0;
+    double findTime = 0;
+    double eraseTime = 0;
+};
+
+template<typename DictionaryType, typename KeyType>
+Tree_Sample measureTree(const std::vector<KeyType>& keys, int iterations) {
+    Tree_Sample sample;
+    size_t checksum = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Memory_Snapshot startMem = memory_snapshot();
+        {
+            DictionaryType dict;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : keys) {
+                dict.insert(key, 1);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            sample.insertTime += std::chrono::duration<double, std::nano>(end - start).count();
+            sample.bytes += double(memory_since(startMem).bytes);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : keys) {
+                checksum += *dict.find(key);
+            }
+            end = std::chrono::high_resolution_clock::now();
+            sample.findTime += std::chrono::duration<double, std::nano>(end - start).count();
+
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& key : keys) {
+                dict.erase(key);
+            }
+            end = std::chrono::high_resolution_clock::now();
+            sample.eraseTime += std::chrono::duration<double, std::nano>(end - start).count();
+        }
+    }
+    const double operations = double(iterations) * double(keys.size());
+    sample.bytes /= operations;
+    sample.insertTime /= operations;
+    sample.findTime /= operations;
+    sample.eraseTime /= operations;
+    if (checksum != size_t(operations)) {
+        std::cerr << "Поиск вернул не все ключи\n";
+    }
+    return sample;
+}
+
+/**
+ * Сравнивает RB_Dictionary (указатель на родителя, sentinel nil, исправления снизу вверх)
+ * с Top_Down_RB_Dictionary (без родителя и nil, балансировка за один проход сверху вниз):
+ * размер узла, память на элемент с учётом ключей и время вставки, поиска и удаления.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkTopDown(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    using Bottom_Up = RB_Dictionary<KeyType, int>;
+    using Top_Down = Top_Down_RB_Dictionary<KeyType, int>;
+    outFile << "Узел: RB_Dictionary " << Bottom_Up::node_bytes() << " байт, Top_Down " << Top_Down::node_bytes()
+        << " байт; память — байт на элемент, время — нс на операцию\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(10) << "Память RB" << " | "
+        << std::setw(10) << "Память TD" << " | "
+        << std::setw(10) << "Вставка RB" << " | "
+        << std::setw(10) << "Вставка TD" << " | "
+        << std::setw(10) << "Поиск RB" << " | "
+        << std::setw(10) << "Поиск TD" << " | "
+        << std::setw(12) << "Удаление RB" << " | "
+        << std::setw(12) << "Удаление TD" << "\n";
+    outFile << std::string(120, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 1000, 10000, 100000, 1000000 };
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+        Tree_Sample bottomUp = measureTree<Bottom_Up>(testKeys, iterations);
+        Tree_Sample topDown = measureTree<Top_Down>(testKeys, iterations);
+
+        outFile << std::setw(10) << currentSize << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << bottomUp.bytes << " | "
+            << std::setw(10) << topDown.bytes << " | "
+            << std::setw(10) << bottomUp.insertTime << " | "
+            << std::setw(10) << topDown.insertTime << " | "
+            << std::setw(10) << bottomUp.findTime << " | "
+            << std::setw(10) << topDown.findTime << " | "
+            << std::setw(12) << bottomUp.eraseTime << " | "
+            << std::setw(12) << topDown.eraseTime << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Сравнивает RB_Dictionary с Packed_Int_Dictionary (отсортированные блоки по 128 ключей,
+ * разности упакованы по битам) на целых ключах: память на элемент по учёту выделений
+ * (вместе с 4-байтным значением), байты только на ключи — после вставок в порядке файла
+ * и после построения из отсортированных пар, время вставки, поиска и удаления.
+ *
+ * @tparam KeyType Целый тип ключей
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkPacked(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    using Tree = RB_Dictionary<KeyType, int>;
+    using Packed = Packed_Int_Dictionary<KeyType, int>;
+    outFile << "Память — байт на элемент, время — нс на операцию; PK — Packed_Int_Dictionary\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(10) << "Память RB" << " | "
+        << std::setw(10) << "Память PK" << " | "
+        << std::setw(10) << "Ключи PK" << " | "
+        << std::setw(12) << "Ключи PK сорт." << " | "
+        << std::setw(10) << "Вставка RB" << " | "
+        << std::setw(10) << "Вставка PK" << " | "
+        << std::setw(10) << "Поиск RB" << " | "
+        << std::setw(10) << "Поиск PK" << " | "
+        << std::setw(12) << "Удаление RB" << " | "
+        << std::setw(12) << "Удаление PK" << "\n";
+    outFile << std::string(150, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 1000, 10000, 100000, 1000000 };
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+        Tree_Sample tree = measureTree<Tree>(testKeys, iterations);
+        Tree_Sample packed = measureTree<Packed>(testKeys, iterations);
+
+        // Байты на ключи: блоки, заполненные вставками (в среднем на 3/4), и заполненные целиком
+        Packed inserted;
+        for (const auto& key : testKeys) {
+            inserted.insert(key, 1);
+        }
+        std::vector<KeyType> sortedKeys(testKeys);
+        std::sort(sortedKeys.begin(), sortedKeys.end());
+        Packed built(sortedKeys, std::vector<int>(sortedKeys.size(), 1));
+
+        outFile << std::setw(10) << currentSize << " | " << std::fixed << std::setprecision(2)
+            << std::setw(10) << tree.bytes << " | "
+            << std::setw(10) << packed.bytes << " | "
+            << std::setw(10) << double(inserted.key_bytes()) / double(inserted.size()) << " | "
+            << std::setw(12) << double(built.key_bytes()) / double(built.size()) << " | "
+            << std::setprecision(1)
+            << std::setw(10) << tree.insertTime << " | "
+            << std::setw(10) << packed.insertTime << " | "
+            << std::setw(10) << tree.findTime << " | "
+            << std::setw(10) << packed.findTime << " | "
+            << std::setw(12) << tree.eraseTime << " | "
+            << std::setw(12) << packed.eraseTime << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Сравнивает слияние двух деревьев циклом вставок с unite()/intersect()/subtract().
+ * Базовый словарь фиксированного размера, второй («дельта») растёт; половина ключей
+ * дельты есть в базе. Время — на всю операцию (мс), так как сложность зависит от обоих размеров.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkSetOperations(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const size_t baseSize = std::min<size_t>(500000, allKeys.size() / 2);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    outFile << "Время операции (мс); в базе " << baseSize << " ключей, потоков для слияния: " << threads << "\n";
+    outFile << std::setw(10) << "Дельта" << " | "
+        << std::setw(12) << "Цикл insert" << " | "
+        << std::setw(10) << "unite" << " | "
+        << std::setw(14) << "unite, потоки" << " | "
+        << std::setw(10) << "intersect" << " | "
+        << std::setw(10) << "subtract" << "\n";
+    outFile << std::string(82, '-') << "\n";
+
+    RB_Dictionary<KeyType, int> base;
+    for (size_t i = 0; i < baseSize; ++i) {
+        base.insert(allKeys[i], int(i));
+    }
+    const int iterations = getIterations(baseSize);
+    auto sum = [](const int& mine, const int& theirs) { return mine + theirs; };
+
+    const std::vector<size_t> deltaSizes = { 1000, 10000, 100000, 500000 };
+    for (size_t deltaSize : deltaSizes) {
+        if (baseSize + deltaSize / 2 > allKeys.size() || deltaSize / 2 > baseSize) {
+            std::cerr << "Пропуск размера " << deltaSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        RB_Dictionary<KeyType, int> delta;
+        for (size_t i = baseSize - deltaSize / 2; i < baseSize + deltaSize - deltaSize / 2; ++i) {
+            delta.insert(allKeys[i], 1);
+        }
+
+        // Время операции op над свежей копией базы
+        auto measure = [&](auto op) {
+            double total = 0;
+            for (int i = 0; i < iterations; ++i) {
+                RB_Dictionary<KeyType, int> target;
+                target.unite(base);
+                auto start = std::chrono::high_resolution_clock::now();
+                op(target);
+                auto end = std::chrono::high_resolution_clock::now();
+                total += std::chrono::duration<double, std::milli>(end - start).count();
+            }
+            return total / iterations;
+        };
+
+        double loopTime = measure([&](RB_Dictionary<KeyType, int>& target) {
+            delta.for_each([&](const KeyType& key, const int& value) {
+                if (int* mine = target.find(key)) {
+                    *mine += value;
+                }
+                else {
+                    target.insert(key, value);
+                }
+            });
+        });
+        double uniteTime = measure([&](RB_Dictionary<KeyType, int>& target) { target.unite(delta, sum); });
+        double parallelTime = measure([&](RB_Dictionary<KeyType, int>& target) { target.unite(delta, sum, threads); });
+        double intersectTime = measure([&](RB_Dictionary<KeyType, int>& target) { target.intersect(delta, threads); });
+        double subtractTime = measure([&](RB_Dictionary<KeyType, int>& target) { target.subtract(delta, threads); });
+
+        outFile << std::setw(10) << deltaSize << " | " << std::fixed << std::setprecision(2)
+            << std::setw(12) << loopTime << " | "
+            << std::setw(10) << uniteTime << " | "
+            << std::setw(14) << parallelTime << " | "
+            << std::setw(10) << intersectTime << " | "
+            << std::setw(10) << subtractTime << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Измеряет пропускную способность save()/load() в памяти (МБ/с) и сравнивает
+ * загрузку из потока с построением того же словаря вставками.
+ *
+ * @tparam DictionaryType Тип тестируемого словаря (Dictionary или RB_Dictionary)
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename DictionaryType, typename KeyType>
+void benchmarkSerialization(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(12) << "Байт" << " | "
+        << std::setw(14) << "Запись (МБ/с)" << " | "
+        << std::setw(14) << "Чтение (МБ/с)" << " | "
+        << std::setw(14) << "Загрузка (нс)" << " | "
+        << std::setw(14) << "Вставки (нс)" << "\n";
+    outFile << std::string(96, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 10000, 100000, 1000000 };
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+
+        DictionaryType dict;
+        for (const auto& key : testKeys) {
+            dict.insert(key, 1);
+        }
+
+        double totalSaveTime = 0;
+        double totalLoadTime = 0;
+        double totalInsertTime = 0;
+        size_t streamBytes = 0;
+
+        for (int i = 0; i < iterations; ++i) {
+            std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+
+            auto startTime = std::chrono::high_resolution_clock::now();
+            if (!dict.save(stream)) {
+                std::cerr << "Ошибка сохранения для размера " << currentSize << "\n";
+            }
+            auto endTime = std::chrono::high_resolution_clock::now();
+            totalSaveTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+            streamBytes = static_cast<size_t>(stream.tellp());
+
+            DictionaryType loaded;
+            startTime = std::chrono::high_resolution_clock::now();
+            if (!loaded.load(stream) || static_cast<size_t>(loaded.size()) != currentSize) {
+                std::cerr << "Ошибка загрузки для размера " << currentSize << "\n";
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalLoadTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Для сравнения: тот же словарь, построенный вставками
+            DictionaryType rebuilt;
+            startTime = std::chrono::high_resolution_clock::now();
+            for (const auto& key : testKeys) {
+                rebuilt.insert(key, 1);
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalInsertTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+        }
+
+        // байт / нс * 1000 = МБ/с
+        double avgSaveTime = totalSaveTime / iterations;
+        double avgLoadTime = totalLoadTime / iterations;
+        outFile << std::setw(10) << currentSize << " | "
+            << std::setw(12) << streamBytes << " | "
+            << std::setw(14) << std::fixed << std::setprecision(1) << streamBytes * 1000.0 / avgSaveTime << " | "
+            << std::setw(14) << streamBytes * 1000.0 / avgLoadTime << " | "
+            << std::setw(14) << static_cast<uint64_t>(avgLoadTime) << " | "
+            << std::setw(14) << static_cast<uint64_t>(totalInsertTime / iterations) << "\n";
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Среднее время одного поиска (нс) по заданной последовательности запросов.
+ */
+template<typename DictionaryType, typename KeyType>
+double measureLookups(const DictionaryType& dict, const std::vector<KeyType>& queries, int repeats) {
+    size_t hits = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (const auto& key : queries) {
+            hits += dict.find(key) != nullptr;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (hits > queries.size() * repeats) {
+        std::cerr << "Некорректное число попаданий\n";
+    }
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count())
+        / (double(queries.size()) * repeats);
+}
+
+/**
+ * Измеряет поиск с фильтрами принадлежности и без них при разной доле отсутствующих ключей.
+ * В словари вставляется первая половина ключей, отсутствующие ключи берутся из второй.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkMissRatio(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const size_t half = allKeys.size() / 2;
+    std::vector<KeyType> present(allKeys.begin(), allKeys.begin() + half);
+    std::vector<KeyType> absent(allKeys.begin() + half, allKeys.begin() + 2 * half);
+    if (present.empty()) {
+        std::cerr << "Недостаточно ключей для " << testName << "\n";
+        return;
+    }
+
+    Dictionary<KeyType, int> hash;
+    Dictionary<KeyType, int, Blocked_Bloom_Filter> hashBloom;
+    Dictionary<KeyType, int, Fingerprint_Filter> hashFingerprint;
+    RB_Dictionary<KeyType, int> tree;
+    RB_Dictionary<KeyType, int, Blocked_Bloom_Filter> treeBloom;
+    RB_Dictionary<KeyType, int, Fingerprint_Filter> treeFingerprint;
+    for (const auto& key : present) {
+        hash.insert(key, 1);
+        hashBloom.insert(key, 1);
+        hashFingerprint.insert(key, 1);
+        tree.insert(key, 1);
+        treeBloom.insert(key, 1);
+        treeFingerprint.insert(key, 1);
+    }
+
+    outFile << "Элементов в словаре: " << present.size() << ", время одного поиска (нс)\n";
+    outFile << std::setw(12) << "Промахи (%)" << " | "
+        << std::setw(10) << "Хэш" << " | "
+        << std::setw(10) << "Хэш+Bloom" << " | "
+        << std::setw(10) << "Хэш+FP" << " | "
+        << std::setw(10) << "Дерево" << " | "
+        << std::setw(12) << "Дерево+Bloom" << " | "
+        << std::setw(10) << "Дерево+FP" << "\n";
+    outFile << std::string(92, '-') << "\n";
+
+    const std::vector<int> missPercents = { 0, 10, 30, 50, 70, 90, 100 };
+    const int repeats = getIterations(present.size());
+    std::mt19937 rng(42);
+
+    for (int missPercent : missPercents) {
+        // Запросы: заданная доля отсутствующих ключей, перемешанных с присутствующими
+        std::vector<KeyType> queries;
+        queries.reserve(present.size());
+        const size_t misses = present.size() * missPercent / 100;
+        for (size_t i = 0; i < present.size(); ++i) {
+            queries.push_back(i < misses ? absent[i % absent.size()] : present[i]);
+        }
+        std::shuffle(queries.begin(), queries.end(), rng);
+
+        outFile << std::setw(12) << missPercent << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << measureLookups(hash, queries, repeats) << " | "
+            << std::setw(10) << measureLookups(hashBloom, queries, repeats) << " | "
+            << std::setw(10) << measureLookups(hashFingerprint, queries, repeats) << " | "
+            << std::setw(10) << measureLookups(tree, queries, repeats) << " | "
+            << std::setw(12) << measureLookups(treeBloom, queries, repeats) << " | "
+            << std::setw(10) << measureLookups(treeFingerprint, queries, repeats) << "\n";
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Полный цикл жизни одного маленького словаря (создание, вставка всех ключей,
+ * поиск каждого ключа, очистка и уничтожение), нс на словарь.
+ */
+template<typename DictionaryType, typename KeyType>
+double measureTinyLifecycle(const std::vector<KeyType>& keys, size_t dictionaries) {
+    size_t hits = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (size_t d = 0; d < dictionaries; ++d) {
+        DictionaryType dict;
+        for (const auto& key : keys) {
+            dict.insert({ key, 1 });
+        }
+        for (const auto& key : keys) {
+            hits += dict.find(key) != dict.end();
+        }
+        dict.clear();
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (hits != keys.size() * dictionaries) {
+        std::cerr << "Некорректное число попаданий\n";
+    }
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count())
+        / double(dictionaries);
+}
+
+// То же для словарей проекта: insert(key, value) и find(), возвращающий указатель
+template<typename DictionaryType, typename KeyType>
+double measureTinyLifecycleCustom(const std::vector<KeyType>& keys, size_t dictionaries) {
+    size_t hits = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (size_t d = 0; d < dictionaries; ++d) {
+        DictionaryType dict;
+        for (const auto& key : keys) {
+            dict.insert(key, 1);
+        }
+        for (const auto& key : keys) {
+            hits += dict.find(key) != nullptr;
+        }
+        dict.clear();
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (hits != keys.size() * dictionaries) {
+        std::cerr << "Некорректное число попаданий\n";
+    }
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count())
+        / double(dictionaries);
+}
+
+/**
+ * Сравнивает множество крошечных словарей: обычные контейнеры против режима малого
+ * размера (Small_Dictionary), который до 8 элементов не обращается к куче.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkTinyDictionaries(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    using SmallHash = Small_Dictionary<KeyType, int, Dictionary<KeyType, int>>;
+    using SmallTree = Small_Dictionary<KeyType, int, RB_Dictionary<KeyType, int>>;
+
+    outFile << "Время полного цикла одного словаря (нс); sizeof Small: "
+        << sizeof(SmallHash) << " / " << sizeof(SmallTree) << " байт\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(10) << "Хэш" << " | "
+        << std::setw(10) << "Small+Хэш" << " | "
+        << std::setw(10) << "Дерево" << " | "
+        << std::setw(12) << "Small+Дерево" << " | "
+        << std::setw(13) << "unordered_map" << " | "
+        << std::setw(10) << "std::map" << "\n";
+    outFile << std::string(92, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 1, 4, 8, 10, 16, 100 };
+    const size_t dictionaries = 20000;
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+
+        outFile << std::setw(10) << currentSize << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << measureTinyLifecycleCustom<Dictionary<KeyType, int>>(testKeys, dictionaries) << " | "
+            << std::setw(10) << measureTinyLifecycleCustom<SmallHash>(testKeys, dictionaries) << " | "
+            << std::setw(10) << measureTinyLifecycleCustom<RB_Dictionary<KeyType, int>>(testKeys, dictionaries) << " | "
+            << std::setw(12) << measureTinyLifecycleCustom<SmallTree>(testKeys, dictionaries) << " | "
+            << std::setw(13) << measureTinyLifecycle<std::unordered_map<KeyType, int>>(testKeys, dictionaries) << " | "
+            << std::setw(10) << measureTinyLifecycle<std::map<KeyType, int>>(testKeys, dictionaries) << "\n";
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Замеряет каждую вставку, поиск и удаление по отдельности и выводит перцентили
+ * задержек. В отличие от средних значений, здесь видны редкие долгие операции:
+ * перестроение таблицы в Dictionary::resize() и длинные каскады балансировки дерева.
+ *
+ * @tparam DictionaryType Тип тестируемого словаря
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename DictionaryType, typename KeyType>
+void benchmarkLatency(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << "Задержка одной операции (нс)\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(8) << "Фаза" << " | "
+        << std::setw(8) << "p50" << " | "
+        << std::setw(8) << "p90" << " | "
+        << std::setw(8) << "p99" << " | "
+        << std::setw(8) << "p99.9" << " | "
+        << std::setw(10) << "max" << "\n";
+    outFile << std::string(80, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 1000, 10000, 100000, 1000000 };
+    const Latency_Clock clock;
+    Latency_Histogram insertLatency, searchLatency, eraseLatency;
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+
+        std::vector<KeyType> testKeys(allKeys.begin(), allKeys.begin() + currentSize);
+        const int iterations = getIterations(currentSize);
+        insertLatency.reset();
+        searchLatency.reset();
+        eraseLatency.reset();
+
+        for (int i = 0; i < iterations; ++i) {
+            DictionaryType dict;
+            for (const auto& key : testKeys) {
+                uint64_t start = Latency_Clock::now();
+                dictInsert(dict, key, 1);
+                insertLatency.record(clock.to_ns(Latency_Clock::now() - start));
+            }
+            for (const auto& key : testKeys) {
+                uint64_t start = Latency_Clock::now();
+                bool found = dictContains(dict, key);
+                searchLatency.record(clock.to_ns(Latency_Clock::now() - start));
+                if (!found) {
+                    std::cerr << "Ключ не найден: " << key << "\n";
+                }
+            }
+            for (const auto& key : testKeys) {
+                uint64_t start = Latency_Clock::now();
+                dict.erase(key);
+                eraseLatency.record(clock.to_ns(Latency_Clock::now() - start));
+            }
+        }
+
+        const std::pair<const char*, const Latency_Histogram*> phases[] = {
+            { "Вставка", &insertLatency }, { "Поиск", &searchLatency }, { "Удаление", &eraseLatency }
+        };
+        for (const auto& phase : phases) {
+            const Latency_Histogram& h = *phase.second;
+            outFile << std::setw(10) << currentSize << " | "
+                << std::setw(8) << phase.first << " | "
+                << std::setw(8) << h.percentile(50) << " | "
+                << std::setw(8) << h.percentile(90) << " | "
+                << std::setw(8) << h.percentile(99) << " | "
+                << std::setw(8) << h.percentile(99.9) << " | "
+                << std::setw(10) << h.max() << "\n";
+        }
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Выполняет последовательность операций нагрузки над одним словарём.
+ * Перед замером в словарь загружаются первые config.working_set ключей.
+ *
+ * @return Среднее время операции (нс); в hits — число успешных поисков
+ */
+template<typename DictionaryType, typename KeyType>
+double runWorkload(
+    const std::vector<KeyType>& allKeys,
+    const Workload_Config& config,
+    const std::vector<Workload_Op>& ops,
+    size_t& hits
+) {
+    DictionaryType dict;
+    for (size_t i = 0; i < config.working_set; ++i) {
+        dictInsert(dict, allKeys[i], 1);
+    }
+
+    hits = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (const Workload_Op& op : ops) {
+        const KeyType& key = allKeys[op.key];
+        switch (op.kind) {
+        case OP_FIND:
+            hits += dictContains(dict, key);
+            break;
+        case OP_INSERT:
+            dictInsert(dict, key, 1);
+            break;
+        case OP_ERASE:
+            dict.erase(key);
+            break;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count())
+        / double(ops.size());
+}
+
+/**
+ * Записывает трассу нагрузки: операции выполняются на хэш-таблице через Traced_Dictionary.
+ * Начальное заполнение словаря тоже попадает в трассу, поэтому она воспроизводима с нуля.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param allKeys Все доступные ключи для тестирования
+ * @param config Параметры нагрузки
+ * @param traceFile Путь к файлу трассы
+ * @return false при нехватке ключей или ошибке записи
+ */
+template<typename KeyType>
+bool recordTrace(
+    const std::vector<KeyType>& allKeys,
+    const Workload_Config& config,
+    const std::string& traceFile
+) {
+    std::vector<Workload_Op> ops = generate_workload(config, allKeys.size());
+    std::ofstream out(traceFile, std::ios::binary);
+    if (ops.empty() || !out.is_open()) {
+        std::cerr << "Не удалось записать трассу " << traceFile << "\n";
+        return false;
+    }
+
+    Traced_Dictionary<KeyType, int, Dictionary<KeyType, int>> dict(out);
+    for (size_t i = 0; i < config.working_set; ++i) {
+        dict.insert(allKeys[i], int(i));
+    }
+    for (const Workload_Op& op : ops) {
+        const KeyType& key = allKeys[op.key];
+        switch (op.kind) {
+        case OP_FIND:
+            dict.find(key);
+            break;
+        case OP_INSERT:
+            dict.insert(key, int(op.key));
+            break;
+        case OP_ERASE:
+            dict.erase(key);
+            break;
+        }
+    }
+    const uint64_t recorded = dict.recorded();
+    if (!dict.finish()) {
+        std::cerr << "Ошибка записи трассы " << traceFile << "\n";
+        return false;
+    }
+    std::cout << "Трасса " << traceFile << ": " << recorded << " операций, "
+        << out.tellp() << " байт\n";
+    return true;
+}
+
+/**
+ * Воспроизводит трассу на одном словаре с замером каждой операции
+ * и записывает строку таблицы: среднее и p99 по видам операций, расхождения.
+ */
+template<typename DictionaryType, typename KeyType>
+void replayOn(
+    const std::string& engineName,
+    const std::vector<Trace_Op<KeyType, int>>& ops,
+    std::ofstream& outFile
+) {
+    const Latency_Clock clock;
+    Latency_Histogram latency[3];
+    uint64_t ticks[3] = {};
+    size_t divergences = 0, firstDivergence = 0;
+
+    DictionaryType dict;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < ops.size(); ++i) {
+        uint64_t start = Latency_Clock::now();
+        bool result = apply_trace_op(dict, ops[i]);
+        uint64_t elapsed = Latency_Clock::now() - start;
+        ticks[ops[i].kind] += elapsed;
+        latency[ops[i].kind].record(clock.to_ns(elapsed));
+        if (result != ops[i].result && divergences++ == 0) {
+            firstDivergence = i;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    const double totalNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        endTime - startTime).count());
+    outFile << std::setw(14) << engineName << " | " << std::fixed << std::setprecision(1)
+        << std::setw(10) << totalNs / double(ops.size());
+    for (int kind : { TRACE_FIND, TRACE_INSERT, TRACE_ERASE }) {
+        const Latency_Histogram& h = latency[kind];
+        if (h.count() == 0) {
+            outFile << " | " << std::setw(10) << "-" << " | " << std::setw(8) << "-";
+        }
+        else {
+            outFile << " | " << std::setw(10) << double(clock.to_ns(ticks[kind])) / double(h.count())
+                << " | " << std::setw(8) << h.percentile(99);
+        }
+    }
+    outFile << " | " << std::setw(11) << divergences;
+    if (divergences) {
+        outFile << " (первое: #" << firstDivergence << ")";
+    }
+    outFile << "\n";
+    outFile.unsetf(std::ios::fixed);
+    outFile << std::setprecision(6);
+}
+
+/**
+ * Воспроизводит трассу на всех словарях. Трасса загружается в память целиком,
+ * чтобы чтение файла не попадало в замер.
+ *
+ * @tparam KeyType Тип ключей трассы
+ * @param traceFile Путь к файлу трассы
+ * @param outputFile Путь к выходному файлу с результатами
+ * @return false, если файл не является трассой с ключами KeyType
+ */
+template<typename KeyType>
+bool benchmarkReplay(const std::string& traceFile, const std::string& outputFile) {
+    std::vector<Trace_Op<KeyType, int>> ops;
+    {
+        std::ifstream in(traceFile, std::ios::binary);
+        if (!in.is_open() || !load_trace(in, ops)) {
+            return false;
+        }
+    }
+
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return true;
+    }
+
+    size_t counts[3] = {};
+    for (const auto& op : ops) {
+        ++counts[op.kind];
+    }
+    outFile << "Трасса " << traceFile << ": " << ops.size() << " операций (поиск " << counts[TRACE_FIND]
+        << ", вставка " << counts[TRACE_INSERT] << ", удаление " << counts[TRACE_ERASE] << ")\n";
+    outFile << "Время операции (нс)\n";
+    outFile << std::setw(14) << "Словарь" << " | "
+        << std::setw(10) << "Среднее" << " | "
+        << std::setw(10) << "Поиск" << " | " << std::setw(8) << "p99" << " | "
+        << std::setw(10) << "Вставка" << " | " << std::setw(8) << "p99" << " | "
+        << std::setw(10) << "Удаление" << " | " << std::setw(8) << "p99" << " | "
+        << std::setw(11) << "Расхождения" << "\n";
+    outFile << std::string(116, '-') << "\n";
+
+    replayOn<Dictionary<KeyType, int>>("HashTable", ops, outFile);
+    replayOn<std::unordered_map<KeyType, int>>("StdHashMap", ops, outFile);
+    replayOn<RB_Dictionary<KeyType, int>>("RedBlackTree", ops, outFile);
+    replayOn<std::map<KeyType, int>>("StdTreeMap", ops, outFile);
+
+    outFile.close();
+    std::cout << "[Replay] Результаты сохранены в " << outputFile << '\n';
+    return true;
+}
+
+/**
+ * Прогоняет набор нагрузок (распределение ключей, смесь операций, доля попаданий)
+ * на всех словарях, включая std::unordered_map и std::map.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param configs Параметры нагрузок
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkWorkload(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::vector<Workload_Config>& configs,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << "Среднее время операции (нс)\n";
+    outFile << std::setw(34) << "Нагрузка" << " | "
+        << std::setw(10) << "Хэш" << " | "
+        << std::setw(10) << "Дерево" << " | "
+        << std::setw(13) << "unordered_map" << " | "
+        << std::setw(10) << "std::map" << " | "
+        << std::setw(14) << "Попадания (%)" << "\n";
+    outFile << std::string(104, '-') << "\n";
+
+    for (const Workload_Config& config : configs) {
+        std::vector<Workload_Op> ops = generate_workload(config, allKeys.size());
+        if (ops.empty()) {
+            std::cerr << "Пропуск нагрузки (недостаточно ключей или неверная смесь операций)\n";
+            continue;
+        }
+
+        std::ostringstream name;
+        name << distribution_name(config.distribution);
+        if (config.distribution == DIST_ZIPF || config.distribution == DIST_LATEST) {
+            name << "(" << config.zipf_theta << ")";
+        }
+        name << " " << config.find_percent << "/" << config.insert_percent << "/"
+            << config.erase_percent << " hit=" << config.hit_ratio;
+
+        size_t hashHits, treeHits, stdHashHits, stdTreeHits;
+        double hashTime = runWorkload<Dictionary<KeyType, int>>(allKeys, config, ops, hashHits);
+        double treeTime = runWorkload<RB_Dictionary<KeyType, int>>(allKeys, config, ops, treeHits);
+        double stdHashTime = runWorkload<std::unordered_map<KeyType, int>>(allKeys, config, ops, stdHashHits);
+        double stdTreeTime = runWorkload<std::map<KeyType, int>>(allKeys, config, ops, stdTreeHits);
+        if (hashHits != treeHits || hashHits != stdHashHits || hashHits != stdTreeHits) {
+            std::cerr << "Словари разошлись в числе попаданий\n";
+        }
+
+        size_t finds = 0;
+        for (const Workload_Op& op : ops) {
+            finds += op.kind == OP_FIND;
+        }
+
+        outFile << std::setw(34) << name.str() << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << hashTime << " | "
+            << std::setw(10) << treeTime << " | "
+            << std::setw(13) << stdHashTime << " | "
+            << std::setw(10) << stdTreeTime << " | "
+            << std::setw(14) << (finds ? 100.0 * double(hashHits) / double(finds) : 0.0) << "\n";
+        outFile.unsetf(std::ios::fixed);
+        outFile << std::setprecision(6);
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Разбирает параметры основных таблиц вида ключ=значение:
+ * sizes=10,100,1000 iterations=1000,100,10 datasets=random_keys,shuffled_numbers report=out.json
+ *
+ * @param datasets Наборы ключей (имена файлов без расширения); пусто — все
+ * @param reportPath Путь к JSON-отчёту; CSV пишется рядом с тем же именем
+ * @return false, если какой-либо параметр не распознан
+ */
+bool parseTableArgs(const std::vector<std::string>& args, std::vector<std::string>& datasets, std::string& reportPath) {
+    auto splitList = [](const std::string& value) {
+        std::vector<std::string> items;
+        std::istringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    };
+
+    for (const std::string& arg : args) {
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Ожидался параметр вида ключ=значение: " << arg << "\n";
+            return false;
+        }
+        std::string name = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (name == "sizes") {
+            tableSizes.clear();
+            for (const std::string& item : splitList(value)) {
+                tableSizes.push_back(std::stoul(item));
+            }
+        }
+        else if (name == "iterations") {
+            tableIterations.clear();
+            for (const std::string& item : splitList(value)) {
+                tableIterations.push_back(std::max(1, std::stoi(item)));
+            }
+        }
+        else if (name == "datasets") {
+            datasets = splitList(value);
+        }
+        else if (name == "report") {
+            reportPath = value;
+        }
+        else {
+            std::cerr << "Неизвестный параметр таблиц: " << name << "\n";
+            return false;
+        }
+    }
+    if (!tableIterations.empty() && tableIterations.size() != tableSizes.size()) {
+        std::cerr << "Число значений iterations должно совпадать с числом размеров\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Разбирает параметры нагрузки вида ключ=значение:
+ * dist=uniform|zipf|sequential|latest theta=0.99 mix=90/5/5 hit=1.0 ws=100000 ops=1000000 seed=42
+ *
+ * @return false, если какой-либо параметр не распознан
+ */
+bool parseWorkloadArgs(const std::vector<std::string>& args, Workload_Config& config) {
+    for (const std::string& arg : args) {
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Ожидался параметр вида ключ=значение: " << arg << "\n";
+            return false;
+        }
+        std::string name = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (name == "dist") {
+            if (!parse_distribution(value, config.distribution)) {
+                std::cerr << "Неизвестное распределение: " << value << "\n";
+                return false;
+            }
+        }
+        else if (name == "theta") {
+            config.zipf_theta = std::stod(value);
+            if (!(config.zipf_theta > 0 && config.zipf_theta < 1)) {
+                std::cerr << "theta должно лежать в интервале (0, 1)\n";
+                return false;
+            }
+        }
+        else if (name == "mix") {
+            char sep1 = 0, sep2 = 0;
+            std::istringstream mix(value);
+            if (!(mix >> config.find_percent >> sep1 >> config.insert_percent >> sep2 >> config.erase_percent) ||
+                config.find_percent + config.insert_percent + config.erase_percent != 100) {
+                std::cerr << "Смесь операций задаётся как поиск/вставка/удаление с суммой 100\n";
+                return false;
+            }
+        }
+        else if (name == "hit") {
+            config.hit_ratio = std::stod(value);
+        }
+        else if (name == "ws") {
+            config.working_set = std::stoul(value);
+        }
+        else if (name == "ops") {
+            config.operations = std::stoul(value);
+        }
+        else if (name == "seed") {
+            config.seed = std::stoull(value);
+        }
+        else {
+            std::cerr << "Неизвестный параметр нагрузки: " << name << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Многопоточная пропускная способность одного общего словаря.
+ * Ключи делятся между потоками на непересекающиеся части, и каждый поток выполняет
+ * свою нагрузку (параметры config, поделённые на число потоков) над своей частью.
+ * Для T = 1..maxThreads выводится суммарная пропускная способность и равномерность
+ * потоков: отношение самого медленного к самому быстрому и индекс Джайна.
+ *
+ * @tparam ContainerType Потокобезопасный словарь (Locked_Dictionary, Sharded_Dictionary)
+ * @tparam KeyType Тип ключей словаря
+ * @param containerName Название словаря для заголовка раздела
+ * @param allKeys Все доступные ключи для тестирования
+ * @param config Параметры нагрузки на все потоки вместе
+ * @param maxThreads Наибольшее число потоков
+ * @param outFile Поток, в который дописывается раздел результатов
+ */
+template<typename ContainerType, typename KeyType>
+void benchmarkThreads(
+    const std::string& containerName,
+    const std::vector<KeyType>& allKeys,
+    const Workload_Config& config,
+    unsigned maxThreads,
+    std::ofstream& outFile
+) {
+    outFile << "\n" << containerName << "\n";
+    outFile << std::setw(7) << "Потоки" << " | "
+        << std::setw(10) << "Mops/s" << " | "
+        << std::setw(10) << "Ускорение" << " | "
+        << std::setw(12) << "Мин. поток" << " | "
+        << std::setw(12) << "Макс. поток" << " | "
+        << std::setw(8) << "Джайн" << " | "
+        << std::setw(14) << "Попадания (%)" << "\n";
+    outFile << std::string(96, '-') << "\n";
+
+    const unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    double singleThread = 0;
+
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        // Нагрузка одного потока и его часть ключей
+        Workload_Config threadConfig = config;
+        threadConfig.working_set = std::max<size_t>(1, config.working_set / threads);
+        threadConfig.operations = std::max<size_t>(1, config.operations / threads);
+        const size_t slice = allKeys.size() / threads;
+
+        std::vector<std::vector<Workload_Op>> ops(threads);
+        bool enoughKeys = true;
+        for (unsigned t = 0; t < threads; ++t) {
+            threadConfig.seed = config.seed + t;
+            ops[t] = generate_workload(threadConfig, slice);
+            enoughKeys = enoughKeys && !ops[t].empty();
+        }
+        if (!enoughKeys) {
+            std::cerr << "Пропуск " << threads << " потоков (недостаточно ключей)\n";
+            break;
+        }
+
+        ContainerType dict;
+        for (unsigned t = 0; t < threads; ++t) {
+            for (size_t i = 0; i < threadConfig.working_set; ++i) {
+                dict.insert(allKeys[t * slice + i], 1);
+            }
+        }
+
+        std::vector<std::chrono::steady_clock::time_point> starts(threads), ends(threads);
+        std::vector<size_t> hits(threads, 0), finds(threads, 0);
+        Start_Barrier barrier(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                pin_current_thread(t % hardwareThreads);
+                const KeyType* keys = allKeys.data() + t * slice;
+                size_t threadHits = 0, threadFinds = 0;
+                barrier.arrive_and_wait();
+                starts[t] = std::chrono::steady_clock::now();
+                for (const Workload_Op& op : ops[t]) {
+                    switch (op.kind) {
+                    case OP_FIND:
+                        threadHits += dict.contains(keys[op.key]);
+                        ++threadFinds;
+                        break;
+                    case OP_INSERT:
+                        dict.insert(keys[op.key], 1);
+                        break;
+                    case OP_ERASE:
+                        dict.erase(keys[op.key]);
+                        break;
+                    }
+                }
+                ends[t] = std::chrono::steady_clock::now();
+                hits[t] = threadHits;
+                finds[t] = threadFinds;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Суммарная пропускная способность — по окну от первого старта до последнего финиша
+        auto first = *std::min_element(starts.begin(), starts.end());
+        auto last = *std::max_element(ends.begin(), ends.end());
+        double totalOps = 0, minRate = 0, maxRate = 0, sumRate = 0, sumSquares = 0;
+        size_t totalHits = 0, totalFinds = 0;
+        for (unsigned t = 0; t < threads; ++t) {
+            double seconds = std::chrono::duration<double>(ends[t] - starts[t]).count();
+            double rate = double(ops[t].size()) / std::max(seconds, 1e-9) / 1e6;
+            minRate = t == 0 ? rate : std::min(minRate, rate);
+            maxRate = std::max(maxRate, rate);
+            sumRate += rate;
+            sumSquares += rate * rate;
+            totalOps += double(ops[t].size());
+            totalHits += hits[t];
+            totalFinds += finds[t];
+        }
+        double mops = totalOps / std::max(std::chrono::duration<double>(last - first).count(), 1e-9) / 1e6;
+        if (threads == 1) {
+            singleThread = mops;
+        }
+
+        outFile << std::setw(7) << threads << " | " << std::fixed << std::setprecision(2)
+            << std::setw(10) << mops << " | "
+            << std::setw(10) << (singleThread > 0 ? mops / singleThread : 0.0) << " | "
+            << std::setw(12) << minRate << " | "
+            << std::setw(12) << maxRate << " | "
+            << std::setw(8) << sumRate * sumRate / (threads * sumSquares) << " | "
+            << std::setw(14) << (totalFinds ? 100.0 * double(totalHits) / double(totalFinds) : 0.0) << "\n";
+    }
+}
+
+/**
+ * Многопоточные замеры для всех потокобезопасных вариантов словарей.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param config Параметры нагрузки на все потоки вместе
+ * @param maxThreads Наибольшее число потоков
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkConcurrency(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const Workload_Config& config,
+    unsigned maxThreads,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << "Нагрузка: " << distribution_name(config.distribution) << " "
+        << config.find_percent << "/" << config.insert_percent << "/" << config.erase_percent
+        << ", операций " << config.operations << ", ключей в словаре " << config.working_set
+        << "; Mops/s потоков — миллионы операций в секунду\n";
+
+    using Hash = Dictionary<KeyType, int>;
+    using Tree = RB_Dictionary<KeyType, int>;
+    benchmarkThreads<Locked_Dictionary<KeyType, int, Hash, std::mutex>>(
+        "Хэш + mutex", allKeys, config, maxThreads, outFile);
+    benchmarkThreads<Locked_Dictionary<KeyType, int, Hash, std::shared_mutex>>(
+        "Хэш + shared_mutex", allKeys, config, maxThreads, outFile);
+    benchmarkThreads<Sharded_Dictionary<KeyType, int, Hash>>(
+        "Хэш, 64 части", allKeys, config, maxThreads, outFile);
+    benchmarkThreads<Locked_Dictionary<KeyType, int, Tree, std::mutex>>(
+        "Дерево + mutex", allKeys, config, maxThreads, outFile);
+    benchmarkThreads<Locked_Dictionary<KeyType, int, Tree, std::shared_mutex>>(
+        "Дерево + shared_mutex", allKeys, config, maxThreads, outFile);
+    benchmarkThreads<Sharded_Dictionary<KeyType, int, Tree>>(
+        "Дерево, 64 части", allKeys, config, maxThreads, outFile);
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Сравнивает загрузку хэш-таблицы вставкой по одной с bulk_insert() на 1, 2, 4, ... потоках
+ * и последовательное расширение таблицы с параллельным (reserve() с потоками).
+ * Время указано на один элемент; ускорение — относительно однопоточного варианта.
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param maxThreads Наибольшее число потоков
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+template<typename KeyType>
+void benchmarkBulkLoad(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    unsigned maxThreads,
+    const std::string& outputFile
+) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << "Время на элемент (нс); аппаратных потоков: " << std::thread::hardware_concurrency() << "\n";
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(8) << "Потоки" << " | "
+        << std::setw(10) << "insert()" << " | "
+        << std::setw(12) << "bulk_insert" << " | "
+        << std::setw(10) << "Ускорение" << " | "
+        << std::setw(12) << "Расширение" << " | "
+        << std::setw(10) << "Ускорение" << "\n";
+    outFile << std::string(90, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 10000, 100000, 1000000 };
+    auto elapsed = [](auto start) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - start).count());
+    };
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+        std::vector<std::pair<KeyType, int>> pairs;
+        pairs.reserve(currentSize);
+        for (size_t i = 0; i < currentSize; ++i) {
+            pairs.emplace_back(allKeys[i], int(i));
+        }
+        const int iterations = getIterations(currentSize);
+
+        double serialInsert = 0;
+        for (int i = 0; i < iterations; ++i) {
+            Dictionary<KeyType, int> dict;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const auto& pair : pairs) {
+                dict.insert(pair.first, pair.second);
+            }
+            serialInsert += elapsed(start);
+        }
+        serialInsert /= double(iterations) * currentSize;
+
+        double singleBulk = 0, singleGrow = 0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            double bulkTime = 0, growTime = 0;
+            for (int i = 0; i < iterations; ++i) {
+                Dictionary<KeyType, int> dict;
+                auto start = std::chrono::high_resolution_clock::now();
+                dict.bulk_insert(pairs, threads);
+                bulkTime += elapsed(start);
+                if (static_cast<size_t>(dict.size()) != currentSize) {
+                    std::cerr << "bulk_insert потерял элементы: " << dict.size() << " из " << currentSize << "\n";
+                }
+
+                // Одно удвоение заполненной таблицы
+                size_t doubled = static_cast<size_t>(dict.get_size() * 2 * dict.get_max_load_factor());
+                start = std::chrono::high_resolution_clock::now();
+                dict.reserve(doubled, threads);
+                growTime += elapsed(start);
+            }
+            bulkTime /= double(iterations) * currentSize;
+            growTime /= double(iterations) * currentSize;
+            if (threads == 1) {
+                singleBulk = bulkTime;
+                singleGrow = growTime;
+            }
+
+            outFile << std::setw(10) << currentSize << " | " << std::fixed << std::setprecision(1)
+                << std::setw(8) << threads << " | "
+                << std::setw(10) << serialInsert << " | "
+                << std::setw(12) << bulkTime << " | " << std::setprecision(2)
+                << std::setw(10) << singleBulk / bulkTime << " | " << std::setprecision(1)
+                << std::setw(12) << growTime << " | " << std::setprecision(2)
+                << std::setw(10) << singleGrow / growTime << "\n";
+            outFile.unsetf(std::ios::fixed);
+            outFile << std::setprecision(6);
+        }
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Загружает вектор данных из файла построчным чтением через поток (исходный способ;
+ * используется, если файл не удалось отобразить в память, и как база для сравнения).
+ *
+ * @param filename Путь к файлу с данными
+ * @param dataVector Вектор для загрузки данных
+ */
+template<typename T>
+void loadVectorFromStream(const std::string& filename, std::vector<T>& dataVector) {
+    std::ifstream inputFile(filename);
+    if (!inputFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << filename << "\n";
+        return;
+    }
+
+    dataVector.clear();
+    T value;
+    while (inputFile >> value) {
+        dataVector.push_back(value);
+    }
+}
+
+/**
+ * Загружает вектор данных из файла: отображение в память и параллельный разбор
+ * (Bench_Loader.h), при неудаче — чтение через поток.
+ *
+ * @param filename Путь к файлу с данными
+ * @param dataVector Вектор для загрузки данных
+ */
+template<typename T>
+void loadVectorFromFile(const std::string& filename, std::vector<T>& dataVector) {
+    Key_File file;
+    if (file.open(filename)) {
+        if constexpr (std::is_same_v<T, int>) {
+            if (file.int_keys(dataVector)) {
+                return;
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::string>) {
+            std::vector<std::string_view> views;
+            if (file.string_keys(views)) {
+                dataVector.assign(views.begin(), views.end());
+                return;
+            }
+        }
+    }
+    loadVectorFromStream(filename, dataVector);
+}
+
+/**
+ * Пропускная способность загрузки файлов ключей (МБ/с): чтение через поток,
+ * отображение в один поток и параллельно; для строк — отдельно string_view
+ * и копирование в std::string.
+ *
+ * @param keyFiles Файлы ключей; первые три — строковые, остальные — целочисленные
+ * @param outputFile Путь к выходному файлу с результатами
+ */
+void benchmarkLoader(const std::vector<std::string>& keyFiles, const std::string& outputFile) {
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    outFile << "Скорость загрузки (МБ/с), потоков для параллельного разбора: " << threads << "\n";
+    outFile << std::setw(24) << "Файл" << " | "
+        << std::setw(10) << "Ключи" << " | "
+        << std::setw(10) << "ifstream" << " | "
+        << std::setw(12) << "mmap, 1 пот." << " | "
+        << std::setw(12) << "mmap, все" << " | "
+        << std::setw(16) << "mmap + string" << "\n";
+    outFile << std::string(100, '-') << "\n";
+
+    // МБ/с по времени работы функции load
+    auto throughput = [](size_t bytes, auto load) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        load();
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(endTime - startTime).count();
+        return double(bytes) / (1024.0 * 1024.0) / std::max(seconds, 1e-9);
+    };
+
+    for (size_t i = 0; i < keyFiles.size(); ++i) {
+        Key_File file;
+        if (!file.open(keyFiles[i])) {
+            std::cerr << "Ошибка открытия файла: " << keyFiles[i] << "\n";
+            continue;
+        }
+        const size_t bytes = file.size_bytes();
+        const bool stringKeys = i < 3;
+        size_t count = 0;
+        double streamRate, singleRate, parallelRate, materializeRate = 0;
+
+        if (stringKeys) {
+            std::vector<std::string> strings;
+            std::vector<std::string_view> views;
+            streamRate = throughput(bytes, [&] { loadVectorFromStream(keyFiles[i], strings); });
+            singleRate = throughput(bytes, [&] { file.string_keys(views, 1); });
+            parallelRate = throughput(bytes, [&] { file.string_keys(views, threads); });
+            materializeRate = throughput(bytes, [&] { loadVectorFromFile(keyFiles[i], strings); });
+            count = views.size();
+            if (views.size() != strings.size()) {
+                std::cerr << "Загрузчики разошлись в числе ключей: " << keyFiles[i] << "\n";
+            }
+        }
+        else {
+            std::vector<int> streamed, mapped;
+            streamRate = throughput(bytes, [&] { loadVectorFromStream(keyFiles[i], streamed); });
+            singleRate = throughput(bytes, [&] { file.int_keys(mapped, 1); });
+            parallelRate = throughput(bytes, [&] { file.int_keys(mapped, threads); });
+            count = mapped.size();
+            if (mapped != streamed) {
+                std::cerr << "Загрузчики разошлись в содержимом: " << keyFiles[i] << "\n";
+            }
+        }
+
+        outFile << std::setw(24) << keyFiles[i] << " | " << std::fixed << std::setprecision(1)
+            << std::setw(10) << count << " | "
+            << std::setw(10) << streamRate << " | "
+            << std::setw(12) << singleRate << " | "
+            << std::setw(12) << parallelRate << " | "
+            << std::setw(16);
+        if (stringKeys) outFile << materializeRate;
+        else outFile << "-";
+        outFile << "\n";
+    }
+
+    outFile.close();
+    std::cout << "[Loader] Результаты сохранены в " << outputFile << '\n';
+}
+
+/**
+ * Сравнивает «холодный» старт: пересборку словаря из текстового файла ключей
+ * и открытие готового отображаемого файла. В обоих случаях после старта
+ * выполняется одна и та же серия поисков, а файлы перед замером вытесняются
+ * из страничного кэша (где ОС это позволяет).
+ *
+ * @tparam KeyType Тип ключей словаря
+ * @param testName Название теста для вывода
+ * @param allKeys Все доступные ключи для тестирования
+ * @param filePrefix Префикс путей к временным файлам и файлу результатов
+ */
+template<typename KeyType>
+void benchmarkColdStart(
+    const std::string& testName,
+    const std::vector<KeyType>& allKeys,
+    const std::string& filePrefix
+) {
+    const std::string outputFile = filePrefix + "_cold_start.txt";
+    std::ofstream outFile(outputFile);
+    if (!outFile.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << outputFile << "\n";
+        return;
+    }
+
+    outFile << std::setw(10) << "Элементы" << " | "
+        << std::setw(16) << "Текст→хэш (нс)" << " | "
+        << std::setw(16) << "mmap хэш (нс)" << " | "
+        << std::setw(16) << "Текст→дерево (нс)" << " | "
+        << std::setw(16) << "mmap дерево (нс)" << "\n";
+    outFile << std::string(90, '-') << "\n";
+
+    const std::vector<size_t> testSizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    const size_t maxProbes = 10000;
+
+    for (size_t currentSize : testSizes) {
+        if (currentSize > allKeys.size()) {
+            std::cerr << "Пропуск размера " << currentSize << " (недостаточно ключей)\n";
+            continue;
+        }
+
+        // Подготовка файлов (не замеряется)
+        const std::string textPath = filePrefix + "_" + std::to_string(currentSize) + ".keys";
+        const std::string hashPath = filePrefix + "_" + std::to_string(currentSize) + ".hmap";
+        const std::string treePath = filePrefix + "_" + std::to_string(currentSize) + ".tmap";
+        {
+            std::ofstream textFile(textPath);
+            Dictionary<KeyType, int> dict;
+            RB_Dictionary<KeyType, int> tree;
+            for (size_t i = 0; i < currentSize; ++i) {
+                textFile << allKeys[i] << "\n";
+                dict.insert(allKeys[i], 1);
+                tree.insert(allKeys[i], 1);
+            }
+            if (!save_mapped(dict, hashPath) || !save_mapped(tree, treePath)) {
+                std::cerr << "Ошибка записи отображаемых файлов для размера " << currentSize << "\n";
+                continue;
+            }
+        }
+
+        // Ключи для серии поисков после старта, разбросанные по всему набору
+        std::vector<KeyType> probes;
+        for (size_t i = 0; i < std::min(currentSize, maxProbes); ++i) {
+            probes.push_back(allKeys[(i * 7919) % currentSize]);
+        }
+
+        const int iterations = std::min(getIterations(currentSize), 10);
+        double totalTextHash = 0;
+        double totalMappedHash = 0;
+        double totalTextTree = 0;
+        double totalMappedTree = 0;
+        size_t found = 0;
+
+        for (int i = 0; i < iterations; ++i) {
+            // Пересборка хэш-таблицы из текста
+            Mapped_File::drop_page_cache(textPath);
+            auto startTime = std::chrono::high_resolution_clock::now();
+            {
+                std::vector<KeyType> keys;
+                loadVectorFromFile(textPath, keys);
+                Dictionary<KeyType, int> dict;
+                for (const auto& key : keys) {
+                    dict.insert(key, 1);
+                }
+                for (const auto& key : probes) {
+                    found += dict.find(key) != nullptr;
+                }
+            }
+            auto endTime = std::chrono::high_resolution_clock::now();
+            totalTextHash += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Открытие отображаемой хэш-таблицы
+            Mapped_File::drop_page_cache(hashPath);
+            startTime = std::chrono::high_resolution_clock::now();
+            {
+                Mapped_Hash_Dictionary<KeyType, int> dict(hashPath);
+                for (const auto& key : probes) {
+                    found += dict.find(key) != nullptr;
+                }
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalMappedHash += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Пересборка дерева из текста
+            Mapped_File::drop_page_cache(textPath);
+            startTime = std::chrono::high_resolution_clock::now();
+            {
+                std::vector<KeyType> keys;
+                loadVectorFromFile(textPath, keys);
+                RB_Dictionary<KeyType, int> tree;
+                for (const auto& key : keys) {
+                    tree.insert(key, 1);
+                }
+                for (const auto& key : probes) {
+                    found += tree.find(key) != nullptr;
+                }
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalTextTree += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+
+            // Открытие отображаемого упорядоченного словаря
+            Mapped_File::drop_page_cache(treePath);
+            startTime = std::chrono::high_resolution_clock::now();
+            {
+                Mapped_Ordered_Dictionary<KeyType, int> tree(treePath);
+                for (const auto& key : probes) {
+                    found += tree.find(key) != nullptr;
+                }
+            }
+            endTime = std::chrono::high_resolution_clock::now();
+            totalMappedTree += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                endTime - startTime).count();
+        }
+
+        if (found != 4 * probes.size() * iterations) {
+            std::cerr << "Не все ключи найдены для размера " << currentSize << "\n";
+        }
+
+        outFile << std::setw(10) << currentSize << " | "
+            << std::setw(16) << static_cast<uint64_t>(totalTextHash / iterations) << " | "
+            << std::setw(16) << static_cast<uint64_t>(totalMappedHash / iterations) << " | "
+            << std::setw(16) << static_cast<uint64_t>(totalTextTree / iterations) << " | "
+            << std::setw(16) << static_cast<uint64_t>(totalMappedTree / iterations) << "\n";
+
+        std::remove(textPath.c_str());
+        std::remove(hashPath.c_str());
+        std::remove(treePath.c_str());
+    }
+
+    outFile.close();
+    std::cout << "[" << testName << "] Результаты сохранены в " << outputFile << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    setlocale(LC_ALL, "RU");
+    const size_t MAX_KEYS = 1'000'000;
+
+    // Режим запуска: без аргументов — основные таблицы, иначе отдельный эксперимент
+    const std::string mode = argc > 1 ? argv[1] : "tables";
+    const std::vector<std::string> modes = {
+        "tables", "counters", "loader", "snapshot", "filter", "serialize", "tiny", "latency",
+        "workload", "threads", "bulk", "hugepages", "packed", "lsm", "cache", "split", "pmr",
+        "topdown", "setops", "persistent", "record", "replay", "coldstart"
+    };
+    // Опечатка в имени режима не должна запускать многочасовые основные таблицы
+    if (std::find(modes.begin(), modes.end(), mode) == modes.end()) {
+        std::cerr << "Неизвестный режим: " << mode << "\nИспользование: " << argv[0] << " [режим]\nРежимы:";
+        for (const std::string& name : modes) {
+            std::cerr << ' ' << name;
+        }
+        std::cerr << '\n';
+        return 1;
+    }
+
+    // Пути к тестовым данным
+    const std::string basePath = "test_results/";
+    const std::vector<std::string> keyFiles = {
+        "random_keys.txt", "decreasing_str_key.txt", "increasing_str_key.txt",
+        "shuffled_numbers.txt", "decreasing_int_key.txt", "increasing_int_key.txt"
+    };
+
+    // Скорость загрузки файлов ключей
+    if (mode == "loader") {
+        benchmarkLoader(keyFiles, basePath + "loader.txt");
+        return 0;
+    }
+
+    // Снимок Эйтцингера против дерева на упорядоченных и перемешанных ключах
+    if (mode == "snapshot") {
+        for (int i : { 0, 2 }) {
+            std::vector<std::string> stringKeys;
+            stringKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], stringKeys);
+            std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkSnapshot("Snapshot", stringKeys, basePath + testName + "_snapshot.txt");
+        }
+        for (int i : { 3, 5 }) {
+            std::vector<int> intKeys;
+            intKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkSnapshot("Snapshot", intKeys, basePath + testName + "_snapshot.txt");
+        }
+        return 0;
+    }
+
+    // Фильтры принадлежности при разной доле промахов
+    if (mode == "filter") {
+        for (int i : { 0, 2 }) {
+            std::vector<std::string> stringKeys;
+            stringKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], stringKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkMissRatio("MissRatio", stringKeys, filePrefix + "_miss_ratio.txt");
+        }
+        for (int i : { 3, 5 }) {
+            std::vector<int> intKeys;
+            intKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkMissRatio("MissRatio", intKeys, filePrefix + "_miss_ratio.txt");
+        }
+        return 0;
+    }
+
+    // Пропускная способность потоковой сериализации
+    if (mode == "serialize") {
+        for (int i = 0; i < 3; ++i) {
+            std::vector<std::string> stringKeys;
+            stringKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], stringKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkSerialization<Dictionary<std::string, int>>(
+                "HashTable", stringKeys, filePrefix + "_hash_dict_serialize.txt");
+            benchmarkSerialization<RB_Dictionary<std::string, int>>(
+                "RedBlackTree", stringKeys, filePrefix + "_rb_dict_serialize.txt");
+        }
+        for (int i = 3; i < 6; ++i) {
+            std::vector<int> intKeys;
+            intKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkSerialization<Dictionary<int, int>>(
+                "HashTable", intKeys, filePrefix + "_hash_dict_serialize.txt");
+            benchmarkSerialization<RB_Dictionary<int, int>>(
+                "RedBlackTree", intKeys, filePrefix + "_rb_dict_serialize.txt");
+        }
+        return 0;
+    }
+
+    // Множество крошечных словарей: режим малого размера против обычных контейнеров
+    if (mode == "tiny") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkTinyDictionaries("Tiny", stringKeys, basePath + "random_keys_tiny.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkTinyDictionaries("Tiny", intKeys, basePath + "shuffled_numbers_tiny.txt");
+        }
+        return 0;
+    }
+
+    // Перцентили задержек отдельных операций
+    if (mode == "latency") {
+        for (int i = 0; i < 3; ++i) {
+            std::vector<std::string> stringKeys;
+            stringKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], stringKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkLatency<Dictionary<std::string, int>>(
+                "HashTable", stringKeys, filePrefix + "_hash_dict_latency.txt");
+            benchmarkLatency<std::unordered_map<std::string, int>>(
+                "StdHashMap", stringKeys, filePrefix + "_unordered_map_latency.txt");
+            benchmarkLatency<RB_Dictionary<std::string, int>>(
+                "RedBlackTree", stringKeys, filePrefix + "_rb_dict_latency.txt");
+            benchmarkLatency<std::map<std::string, int>>(
+                "StdTreeMap", stringKeys, filePrefix + "_std_map_latency.txt");
+        }
+        for (int i = 3; i < 6; ++i) {
+            std::vector<int> intKeys;
+            intKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string filePrefix = basePath + keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkLatency<Dictionary<int, int>>(
+                "HashTable", intKeys, filePrefix + "_hash_dict_latency.txt");
+            benchmarkLatency<std::unordered_map<int, int>>(
+                "StdHashMap", intKeys, filePrefix + "_unordered_map_latency.txt");
+            benchmarkLatency<RB_Dictionary<int, int>>(
+                "RedBlackTree", intKeys, filePrefix + "_rb_dict_latency.txt");
+            benchmarkLatency<std::map<int, int>>(
+                "StdTreeMap", intKeys, filePrefix + "_std_map_latency.txt");
+        }
+        return 0;
+    }
+
+    // Смешанные нагрузки: без параметров — набор типовых, иначе одна заданная
+    // (например: workload dist=zipf theta=0.99 mix=90/5/5 hit=0.9 ws=100000 ops=1000000)
+    if (mode == "workload") {
+        std::vector<Workload_Config> configs;
+        if (argc > 2) {
+            Workload_Config config;
+            if (!parseWorkloadArgs(std::vector<std::string>(argv + 2, argv + argc), config)) {
+                return 1;
+            }
+            configs.push_back(config);
+        }
+        else {
+            for (Key_Distribution distribution : { DIST_UNIFORM, DIST_ZIPF, DIST_SEQUENTIAL, DIST_LATEST }) {
+                for (unsigned findPercent : { 100u, 90u, 50u }) {
+                    Workload_Config config;
+                    config.distribution = distribution;
+                    config.find_percent = findPercent;
+                    config.insert_percent = (100 - findPercent) / 2;
+                    config.erase_percent = (100 - findPercent) / 2;
+                    configs.push_back(config);
+                }
+            }
+            Workload_Config misses;
+            misses.hit_ratio = 0.5;
+            configs.push_back(misses);
+        }
+
+        std::vector<std::string> stringKeys;
+        loadVectorFromFile(keyFiles[0], stringKeys);
+        benchmarkWorkload("Workload", stringKeys, configs, basePath + "random_keys_workload.txt");
+        std::vector<int> intKeys;
+        loadVectorFromFile(keyFiles[3], intKeys);
+        benchmarkWorkload("Workload", intKeys, configs, basePath + "shuffled_numbers_workload.txt");
+        return 0;
+    }
+
+    // Многопоточная пропускная способность для T = 1..threads (по умолчанию — все ядра);
+    // остальные параметры — как у workload
+    if (mode == "threads") {
+        Workload_Config config;
+        unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> workloadArgs;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("threads=", 0) == 0) {
+                maxThreads = std::max(1, std::stoi(arg.substr(8)));
+            }
+            else {
+                workloadArgs.push_back(arg);
+            }
+        }
+        if (!parseWorkloadArgs(workloadArgs, config)) {
+            return 1;
+        }
+
+        std::vector<std::string> stringKeys;
+        loadVectorFromFile(keyFiles[0], stringKeys);
+        benchmarkConcurrency("Threads", stringKeys, config, maxThreads, basePath + "random_keys_threads.txt");
+        std::vector<int> intKeys;
+        loadVectorFromFile(keyFiles[3], intKeys);
+        benchmarkConcurrency("Threads", intKeys, config, maxThreads, basePath + "shuffled_numbers_threads.txt");
+        return 0;
+    }
+
+    // Параллельная загрузка и расширение хэш-таблицы на 1..threads потоках (по умолчанию 32)
+    if (mode == "bulk") {
+        unsigned maxThreads = 32;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("threads=", 0) == 0) {
+                maxThreads = std::max(1, std::stoi(arg.substr(8)));
+            }
+        }
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkBulkLoad("Bulk", stringKeys, maxThreads, basePath + "random_keys_bulk.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkBulkLoad("Bulk", intKeys, maxThreads, basePath + "shuffled_numbers_bulk.txt");
+        }
+        return 0;
+    }
+
+    // Узлы на больших страницах: время поиска и промахи dTLB
+    if (mode == "hugepages") {
+        benchmarkHugePages("HugePages", basePath + "huge_pages.txt");
+        return 0;
+    }
+
+    // Сжатое хранение целых ключей: разности, упакованные по битам, против RB_Dictionary
+    if (mode == "packed") {
+        for (size_t i : { 3, 4, 5 }) {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkPacked("Packed", intKeys, basePath + testName + "_packed.txt");
+
+            // Те же ключи, прореженные примерно в 8 раз: разности уже не равны 1
+            if (i == 3) {
+                std::vector<int> sparseKeys;
+                for (int key : intKeys) {
+                    if ((static_cast<uint32_t>(key) * 2654435761u) >> 29 == 0) {
+                        sparseKeys.push_back(key);
+                    }
+                }
+                benchmarkPacked("Packed", sparseKeys, basePath + "sparse_numbers_packed.txt");
+            }
+        }
+        return 0;
+    }
+
+    // Словарь больше памяти: LSM с выгрузкой на диск против дерева в памяти
+    if (mode == "lsm") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkLSM("LSM", stringKeys, basePath + "lsm_run", basePath + "random_keys_lsm.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkLSM("LSM", intKeys, basePath + "lsm_run", basePath + "shuffled_numbers_lsm.txt");
+        }
+        return 0;
+    }
+
+    // Кэш ограниченной ёмкости: CLOCK против LRU под нагрузкой по Ципфу
+    if (mode == "cache") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkCache("Cache", stringKeys, basePath + "random_keys_cache.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkCache("Cache", intKeys, basePath + "shuffled_numbers_cache.txt");
+        }
+        return 0;
+    }
+
+    // Раздельные массивы ключей и значений при значениях 4, 64 и 256 байт
+    if (mode == "split") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkSplitLayout("Split", stringKeys, basePath + "random_keys_split.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkSplitLayout("Split", intKeys, basePath + "shuffled_numbers_split.txt");
+        }
+        return 0;
+    }
+
+    // Короткоживущие словари с памятью из new/delete, общего пула и арены
+    if (mode == "pmr") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkShortLived("ShortLived", stringKeys, basePath + "random_keys_pmr.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkShortLived("ShortLived", intKeys, basePath + "shuffled_numbers_pmr.txt");
+        }
+        return 0;
+    }
+
+    // Дерево с балансировкой сверху вниз против RB_Dictionary
+    if (mode == "topdown") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkTopDown("TopDown", stringKeys, basePath + "random_keys_topdown.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkTopDown("TopDown", intKeys, basePath + "shuffled_numbers_topdown.txt");
+        }
+        return 0;
+    }
+
+    // Объединение, пересечение и разность деревьев против цикла вставок
+    if (mode == "setops") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkSetOperations("SetOps", stringKeys, basePath + "random_keys_setops.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkSetOperations("SetOps", intKeys, basePath + "shuffled_numbers_setops.txt");
+        }
+        return 0;
+    }
+
+    // Персистентное дерево: снимки за O(1) и запись с копированием пути
+    if (mode == "persistent") {
+        {
+            std::vector<std::string> stringKeys;
+            loadVectorFromFile(keyFiles[0], stringKeys);
+            benchmarkPersistent("Persistent", stringKeys, basePath + "random_keys_persistent.txt");
+        }
+        {
+            std::vector<int> intKeys;
+            loadVectorFromFile(keyFiles[3], intKeys);
+            benchmarkPersistent("Persistent", intKeys, basePath + "shuffled_numbers_persistent.txt");
+        }
+        return 0;
+    }
+
+    // Запись трасс заданной нагрузки (параметры — как у workload)
+    if (mode == "record") {
+        Workload_Config config;
+        if (!parseWorkloadArgs(std::vector<std::string>(argv + 2, argv + argc), config)) {
+            return 1;
+        }
+        std::vector<std::string> stringKeys;
+        loadVectorFromFile(keyFiles[0], stringKeys);
+        recordTrace(stringKeys, config, basePath + "random_keys_trace.bin");
+        std::vector<int> intKeys;
+        loadVectorFromFile(keyFiles[3], intKeys);
+        recordTrace(intKeys, config, basePath + "shuffled_numbers_trace.bin");
+        return 0;
+    }
+
+    // Воспроизведение трасс на всех словарях (replay <файл трассы> ...)
+    if (mode == "replay") {
+        std::vector<std::string> traces(argv + 2, argv + argc);
+        if (traces.empty()) {
+            traces = { basePath + "random_keys_trace.bin", basePath + "shuffled_numbers_trace.bin" };
+        }
+        for (const std::string& trace : traces) {
+            std::string outputFile = trace.substr(0, trace.rfind('.')) + "_replay.txt";
+            if (!benchmarkReplay<int>(trace, outputFile) && !benchmarkReplay<std::string>(trace, outputFile)) {
+                std::cerr << "Не удалось прочитать трассу " << trace << "\n";
+            }
+        }
+        return 0;
+    }
+
+    // Холодный старт: пересборка из текста против открытия отображаемого файла
+    if (mode == "coldstart") {
+        for (int i = 0; i < 3; ++i) {
+            std::vector<std::string> stringKeys;
+            stringKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], stringKeys);
+            std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkColdStart("ColdStart", stringKeys, basePath + testName);
+        }
+        for (int i = 3; i < 6; ++i) {
+            std::vector<int> intKeys;
+            intKeys.reserve(MAX_KEYS);
+            loadVectorFromFile(keyFiles[i], intKeys);
+            std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+            benchmarkColdStart("ColdStart", intKeys, basePath + testName);
+        }
+        return 0;
+    }
+
+    // Основные таблицы можно ограничить наборами ключей и задать размеры и повторы
+    // (например: tables sizes=1000,100000 iterations=10,5 datasets=random_keys report=run.json)
+    std::vector<std::string> datasets;
+    std::string reportPath;
+    if ((mode == "tables" || mode == "counters") &&
+        !parseTableArgs(std::vector<std::string>(argv + 2, argv + argc), datasets, reportPath)) {
+        return 1;
+    }
+    auto selected = [&](const std::string& testName) {
+        return datasets.empty() || std::find(datasets.begin(), datasets.end(), testName) != datasets.end();
+    };
+
+    // Режим counters — те же основные таблицы с аппаратными счётчиками
+    Perf_Counters perfCounters;
+    Perf_Counters* counters = mode == "counters" ? &perfCounters : nullptr;
+    if (counters != nullptr && !counters->available()) {
+        std::cerr << "Аппаратные счётчики: " << counters->last_error() << "\n";
+    }
+
+    // Машиночитаемый отчёт; имя с отметкой времени, чтобы повторные прогоны не затирали друг друга
+    Bench_Report report;
+
+    // Тестирование со строковыми ключами
+    for (int i = 0; i < 3; ++i) {
+        std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+        if (!selected(testName)) {
+            continue;
+        }
+        std::vector<std::string> stringKeys;
+        stringKeys.reserve(MAX_KEYS);
+        loadVectorFromFile(keyFiles[i], stringKeys);
+
+        std::string filePrefix = basePath + testName;
+        report.dataset = testName;
+
+        benchmarkDictionary<Dictionary<std::string, int>>(
+            "HashTable", stringKeys, filePrefix + "_hash_dict.txt", counters, &report);
+        benchmarkDictionary<std::unordered_map<std::string, int>>(
+            "StdHashMap", stringKeys, filePrefix + "_unordered_map.txt", counters, &report);
+        benchmarkDictionary<RB_Dictionary<std::string, int>>(
+            "RedBlackTree", stringKeys, filePrefix + "_rb_dict.txt", counters, &report);
+        benchmarkDictionary<std::map<std::string, int>>(
+            "StdTreeMap", stringKeys, filePrefix + "_std_map.txt", counters, &report);
+    }
+
+    // Тестирование с целочисленными ключами
+    for (int i = 3; i < 6; ++i) {
+        std::string testName = keyFiles[i].substr(0, keyFiles[i].find('.'));
+        if (!selected(testName)) {
+            continue;
+        }
+        std::vector<int> intKeys;
+        intKeys.reserve(MAX_KEYS);
+        loadVectorFromFile(keyFiles[i], intKeys);
+
+        std::string filePrefix = basePath + testName;
+        report.dataset = testName;
+
+        benchmarkDictionary<Dictionary<int, int>>(
+            "HashTable", intKeys, filePrefix + "_hash_dict.txt", counters, &report);
+        benchmarkDictionary<std::unordered_map<int, int>>(
+            "StdHashMap", intKeys, filePrefix + "_unordered_map.txt", counters, &report);
+        benchmarkDictionary<RB_Dictionary<int, int>>(
+            "RedBlackTree", intKeys, filePrefix + "_rb_dict.txt", counters, &report);
+        benchmarkDictionary<std::map<int, int>>(
+            "StdTreeMap", intKeys, filePrefix + "_std_map.txt", counters, &report);
+    }
+
+    std::string stamp = report.environment.timestamp;
+    std::replace(stamp.begin(), stamp.end(), ':', '-');
+    std::string reportPrefix = basePath + "results_" + stamp;
+    if (!reportPath.empty()) {
+        reportPrefix = reportPath.substr(0, reportPath.rfind(".json"));
+    }
+    if (report.write_json(reportPrefix + ".json") && report.write_csv(reportPrefix + ".csv")) {
+        std::cout << "Машиночитаемые результаты сохранены в " << reportPrefix << ".json/.csv\n";
+    }
+    else {
+        std::cerr << "Ошибка записи " << reportPrefix << ".json/.csv\n";
     }
 
     return 0;
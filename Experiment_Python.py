@@ -1,3 +1,6 @@
+import argparse
+import json
+import platform
 import time
 import sys
 import os
@@ -33,8 +36,12 @@ def get_iterations(n):
     return 10
 
 
-def test_dict_performance(keys, sizes, dict_class):
-    """Тестирует производительность словаря для заданных ключей и размеров."""
+def test_dict_performance(keys, sizes, dict_class, iterations=None):
+    """Тестирует производительность словаря для заданных ключей и размеров.
+
+    iterations — словарь {размер: число повторов}; без него используется get_iterations.
+    Возвращает средние времена и, последним элементом, замеры отдельных повторов в нс.
+    """
     results = []
 
     for n in sizes:
@@ -42,11 +49,12 @@ def test_dict_performance(keys, sizes, dict_class):
             continue
 
         subset = keys[:n]
-        num_iter = get_iterations(n)
+        num_iter = iterations[n] if iterations else get_iterations(n)
         print(f"Testing size: {n} with {num_iter} iterations...")
 
         # Тест вставки
         total_insert = 0.0
+        insert_samples = []
         for _ in range(num_iter):
             d = dict_class()
             start_time = time.perf_counter()
@@ -54,10 +62,12 @@ def test_dict_performance(keys, sizes, dict_class):
                 d[key] = True
             end_time = time.perf_counter()
             total_insert += (end_time - start_time)
+            insert_samples.append((end_time - start_time) * 1e9)
         avg_insert = total_insert / num_iter
 
         # Тест поиска
         total_search = 0.0
+        search_samples = []
         for _ in range(num_iter):
             d = dict_class()
             for key in subset:
@@ -68,10 +78,12 @@ def test_dict_performance(keys, sizes, dict_class):
                     pass
             end_time = time.perf_counter()
             total_search += (end_time - start_time)
+            search_samples.append((end_time - start_time) * 1e9)
         avg_search = total_search / num_iter
 
         # Тест удаления
         total_delete = 0.0
+        delete_samples = []
         for _ in range(num_iter):
             d = dict_class()
             for key in subset:
@@ -84,6 +96,7 @@ def test_dict_performance(keys, sizes, dict_class):
                     pass
             end_time = time.perf_counter()
             total_delete += (end_time - start_time)
+            delete_samples.append((end_time - start_time) * 1e9)
         avg_delete = total_delete / num_iter
 
         # Замер памяти
@@ -94,22 +107,61 @@ def test_dict_performance(keys, sizes, dict_class):
         size_after = sys.getsizeof(d)
         memory_usage = size_after - size_before
 
-        results.append((n, avg_insert, avg_search, avg_delete, memory_usage))
+        results.append((n, avg_insert, avg_search, avg_delete, memory_usage,
+                        {'insert': insert_samples, 'find': search_samples, 'erase': delete_samples}))
 
     return results
 
 
+def report_records(dataset, dict_name, results):
+    """Записи в формате отчёта Experiment_C++ (Bench_Report.h)."""
+    records = []
+    for n, _, _, _, memory_usage, samples in results:
+        for operation in ('insert', 'find', 'erase'):
+            records.append({'benchmark': 'tables', 'container': dict_name, 'dataset': dataset,
+                            'operation': operation, 'size': n, 'unit': 'ns',
+                            'samples': samples[operation]})
+        records.append({'benchmark': 'tables', 'container': dict_name, 'dataset': dataset,
+                        'operation': 'memory', 'size': n, 'unit': 'bytes', 'samples': [memory_usage]})
+    return records
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Производительность словарей Python.')
+    parser.add_argument('--data-dir', default='.', help='каталог с файлами ключей')
+    parser.add_argument('--sizes', help='размеры через запятую (по умолчанию 10..1000000)')
+    parser.add_argument('--iterations', help='число повторов для каждого размера через запятую')
+    parser.add_argument('--datasets', help='наборы вида имя:str или имя:int через запятую')
+    parser.add_argument('--report', help='JSON-отчёт в формате Experiment_C++')
+    return parser.parse_args()
+
+
 def main():
+    args = parse_args()
+
     # Конфигурация тестов
     sizes = [10, 100, 1000, 10000, 100000, 1000000]
+    if args.sizes:
+        sizes = [int(v) for v in args.sizes.split(',')]
+    iterations = None
+    if args.iterations:
+        counts = [int(v) for v in args.iterations.split(',')]
+        if len(counts) != len(sizes):
+            sys.exit('Число значений --iterations должно совпадать с числом размеров')
+        iterations = dict(zip(sizes, counts))
     test_files = [
         ('random_keys.txt', 'str'),
-        ('decreazing_str_key.txt', 'str'),
-        ('increazing_str_key.txt', 'str'),
-        ('increazing_int_key.txt', 'int'),
-        ('decreazing_int_key.txt', 'int'),
+        ('decreasing_str_key.txt', 'str'),
+        ('increasing_str_key.txt', 'str'),
+        ('increasing_int_key.txt', 'int'),
+        ('decreasing_int_key.txt', 'int'),
         ('shuffled_numbers.txt', 'int')
     ]
+    if args.datasets:
+        test_files = []
+        for item in args.datasets.split(','):
+            name, key_type = item.split(':')
+            test_files.append((name + '.txt', key_type))
 
     # Типы словарей для тестирования
     dict_types = [
@@ -120,18 +172,21 @@ def main():
 
     # Создаем директорию для результатов
     os.makedirs('test_results', exist_ok=True)
+    records = []
 
     for file_name, key_type in test_files:
-        if not os.path.exists(file_name):
+        file_path = os.path.join(args.data_dir, file_name)
+        if not os.path.exists(file_path):
             print(f"File {file_name} not found. Skipping...")
             continue
 
         print(f"\nProcessing file: {file_name}")
-        keys = load_keys(file_name, key_type)
+        keys = load_keys(file_path, key_type)
 
         for dict_name, dict_class in dict_types:
             print(f"\nTesting dictionary: {dict_name}")
-            results = test_dict_performance(keys, sizes, dict_class)
+            results = test_dict_performance(keys, sizes, dict_class, iterations)
+            records += report_records(os.path.splitext(file_name)[0], dict_name, results)
 
             # Сохраняем результаты
             result_file = os.path.join('test_results',
@@ -142,6 +197,15 @@ def main():
                     f.write(f"{r[0]}\t{r[1]:.10f}\t{r[2]:.10f}\t{r[3]:.10f}\t{r[4]}\n")
             print(f"Results saved to {result_file}")
 
+    if args.report:
+        environment = {'compiler': f"{platform.python_implementation()} {platform.python_version()}",
+                       'flags': '', 'cpu': platform.processor() or platform.machine(),
+                       'host': platform.node(),
+                       'timestamp': time.strftime('%Y-%m-%dT%H:%M:%SZ', time.gmtime())}
+        with open(args.report, 'w', encoding='utf-8') as f:
+            json.dump({'environment': environment, 'results': records}, f, indent=1)
+        print(f"Report saved to {args.report}")
+
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,195 @@
+﻿// Eytzinger_Dictionary.h
+#pragma once
+
+#include <vector>   // для хранения ключей и значений
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "RB_Dictionary.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#define EYTZINGER_PREFETCH(ptr) _mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0)
+#else
+#define EYTZINGER_PREFETCH(ptr) __builtin_prefetch(ptr)
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Навигация по неявному дереву Эйтцингера из n элементов (индексы 1..n)
+//------------------------------------------------------------------------------------------------
+
+// Первая позиция в симметричном порядке обхода (самый левый узел)
+inline size_t eytzinger_first(size_t n) {
+    size_t k = 1;
+    while (2 * k <= n) {
+        k = 2 * k;
+    }
+    return k;
+}
+
+// Следующая позиция в симметричном порядке обхода
+inline size_t eytzinger_next(size_t k, size_t n) {
+    if (2 * k + 1 <= n) {
+        k = 2 * k + 1;
+        while (2 * k <= n) {
+            k = 2 * k;
+        }
+        return k;
+    }
+    // Поднимаемся, пока k — правый потомок
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+// Позиция, на которой закончился спуск k, переводится в индекс нижней границы:
+// отбрасываем повороты направо, сделанные после последнего поворота налево
+inline size_t eytzinger_lower_bound(uint64_t k) {
+#if defined(_MSC_VER)
+    unsigned long trailing_ones;
+    _BitScanForward64(&trailing_ones, ~k);
+#else
+    unsigned trailing_ones = static_cast<unsigned>(__builtin_ctzll(~k));
+#endif
+    return static_cast<size_t>(k >> (trailing_ones + 1));
+}
+
+// Глубина позиции k (корень 1 — глубина 0)
+inline unsigned eytzinger_depth(uint64_t k) {
+#if defined(_MSC_VER)
+    unsigned long top;
+    _BitScanReverse64(&top, k);
+    return static_cast<unsigned>(top);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(k));
+#endif
+}
+
+// Число элементов в поддереве с корнем j: уровни до предпоследнего заполнены целиком,
+// на последнем уровне дерева заняты позиции до n
+inline size_t eytzinger_subtree_size(size_t j, size_t n) {
+    if (j > n) {
+        return 0;
+    }
+    unsigned levels = eytzinger_depth(n) - eytzinger_depth(j);
+    size_t first = j << levels;   // самая левая позиция поддерева на последнем уровне
+    size_t width = size_t(1) << levels;
+    return (width - 1) + (n >= first ? std::min(n - first + 1, width) : 0);
+}
+
+// Позиция элемента k в отсортированном порядке: левое поддерево k и, для каждого
+// предка, из правого потомка которого пришёл путь, сам предок и его левое поддерево
+inline size_t eytzinger_rank(size_t k, size_t n) {
+    size_t rank = eytzinger_subtree_size(2 * k, n);
+    for (; k > 1; k >>= 1) {
+        if (k & 1) {
+            rank += eytzinger_subtree_size(k - 1, n) + 1;
+        }
+    }
+    return rank;
+}
+
+//------------------------------------------------------------------------------------------------
+//  Неизменяемый снимок RB_Dictionary.
+//  Ключи лежат в непрерывном массиве в порядке обхода в ширину (раскладка Эйтцингера):
+//  потомки элемента k — это элементы 2k и 2k+1. Поиск спускается без условных переходов
+//  и заранее подгружает в кэш потомков на несколько уровней вперёд.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value>
+class Eytzinger_Dictionary {
+private:
+    // Сколько ключей помещается в одну кэш-линию (64 байта)
+    static constexpr size_t keys_per_line = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+
+    std::vector<Key>    keys;   // ключи в раскладке Эйтцингера, индекс 0 не используется
+    std::vector<Value>  values; // значения по тем же индексам, что и ключи
+    size_t              count;  // число элементов
+
+    // Кладёт очередную пару (в порядке возрастания ключей) на позицию k
+    inline void place(size_t& k, const Key& key, const Value& value) {
+        keys[k] = key;
+        values[k] = value;
+        k = eytzinger_next(k, count);
+    }
+
+    // Индекс первого ключа, не меньшего key, либо 0, если такого нет
+    inline size_t search(const Key& key) const {
+        size_t k = 1;
+        while (k <= count) {
+            // Потомки k через log2(keys_per_line) уровней лежат в одной кэш-линии;
+            // у нижних уровней их нет, и адрес не должен уходить за конец массива
+            EYTZINGER_PREFETCH(keys.data() + std::min(k * keys_per_line, count));
+            k = 2 * k + (keys[k] < key);
+        }
+        return eytzinger_lower_bound(k);
+    }
+
+public:
+    // Строит снимок из отсортированной последовательности пар;
+    // std::invalid_argument, если ключей и значений не поровну
+    Eytzinger_Dictionary(const std::vector<Key>& sorted_keys, const std::vector<Value>& sorted_values)
+        : keys(sorted_keys.size() + 1), values(sorted_keys.size() + 1), count(sorted_keys.size()) {
+        if (sorted_values.size() != sorted_keys.size()) {
+            throw std::invalid_argument("Eytzinger_Dictionary: число ключей и значений не совпадает");
+        }
+        size_t k = eytzinger_first(count);
+        for (size_t i = 0; i < count; ++i) {
+            place(k, sorted_keys[i], sorted_values[i]);
+        }
+    }
+
+    // Строит снимок по текущему содержимому дерева за один симметричный обход
+    template <typename Filter, bool Collect_Stats>
+    explicit Eytzinger_Dictionary(const RB_Dictionary<Key, Value, Filter, Collect_Stats>& tree)
+        : keys(tree.size() + 1), values(tree.size() + 1), count(tree.size()) {
+        size_t k = eytzinger_first(count);
+        tree.for_each([&](const Key& key, const Value& value) { place(k, key, value); });
+    }
+
+    // Поиск значения по ключу
+    const Value* find(const Key& key) const {
+        size_t k = search(key);
+        if (k != 0 && !(key < keys[k])) {
+            return &values[k];
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Первый ключ, не меньший key; nullptr, если все ключи меньше
+    const Key* lower_bound(const Key& key) const {
+        size_t k = search(key);
+        return k != 0 ? &keys[k] : nullptr;
+    }
+
+    // Количество ключей, строго меньших key
+    size_t rank(const Key& key) const {
+        size_t k = search(key);
+        return k != 0 ? eytzinger_rank(k, count) : count;
+    }
+
+    inline size_t size() const {
+        return count;
+    }
+
+    // Обход пар в порядке возрастания ключей: вызывает func(key, value)
+    template <typename Func>
+    void for_each(Func func) const {
+        size_t k = eytzinger_first(count);
+        for (size_t i = 0; i < count; ++i) {
+            func(keys[k], values[k]);
+            k = eytzinger_next(k, count);
+        }
+    }
+};
+
+template <typename Key, typename Value, typename Filter, bool Collect_Stats>
+Eytzinger_Dictionary<Key, Value> RB_Dictionary<Key, Value, Filter, Collect_Stats>::freeze() const {
+    return Eytzinger_Dictionary<Key, Value>(*this);
+}
@@ -1,11 +1,69 @@
 ﻿#include "pch.h"
 #include "CppUnitTest.h"
+#include <sstream>
+#include <memory_resource>
+#include <type_traits>
+#include <thread>
+#include <vector>
 #include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Mapped_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Small_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Concurrent_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Trace_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Split_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Cache_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Huge_Page_Resource.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace HashUnitTest
 {
+    // Источник памяти, который считает занятые байты
+    struct Counting_Resource : std::pmr::memory_resource {
+        size_t bytes = 0;
+        void* do_allocate(size_t size, size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            bytes -= size;
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // Итог проверки обхода for_each: ключи строго возрастают и каждая пара прошла проверку
+    struct Key_Order {
+        bool   ordered = true;
+        bool   complete = true;   // for_each, возвращающий bool, дошёл до конца
+        size_t count = 0;
+        int    last = 0;          // последний ключ обхода
+    };
+
+    template <typename Container, typename Check>
+    Key_Order check_key_order(const Container& dict, Check check) {
+        Key_Order order;
+        auto visit = [&](const int& key, const auto& value) {
+            order.ordered = order.ordered && (order.count == 0 || order.last < key) && check(key, value);
+            order.last = key;
+            ++order.count;
+        };
+        if constexpr (std::is_same<decltype(dict.for_each(visit)), bool>::value) {
+            order.complete = dict.for_each(visit);
+        }
+        else {
+            dict.for_each(visit);
+        }
+        return order;
+    }
+
+    template <typename Container>
+    Key_Order check_key_order(const Container& dict) {
+        return check_key_order(dict, [](const int&, const auto&) { return true; });
+    }
+
 
 	TEST_CLASS(HashUnitTest)
 	{
@@ -203,5 +261,400 @@ namespace HashUnitTest
             Assert::IsTrue(dict.contains(1));
             Assert::IsFalse(dict.contains(2));
         }
+
+        //Тест 19: Сохранение в отображаемый файл и поиск прямо в нём, повреждённый файл не открывается
+        TEST_METHOD(Test_Mapped_File) {
+            Dictionary<std::string, int> dict;
+            for (int i = 0; i < 1000; ++i) {
+                dict.insert("key" + std::to_string(i), i);
+            }
+            Assert::IsTrue(save_mapped(dict, "hash_test.dmap"));
+
+            Mapped_Hash_Dictionary<std::string, int> mapped("hash_test.dmap");
+            Assert::IsTrue(mapped.is_open());
+            Assert::AreEqual(static_cast<size_t>(1000), mapped.size());
+            for (int i = 0; i < 1000; ++i) {
+                Assert::AreEqual(i, *mapped.find("key" + std::to_string(i)));
+            }
+            Assert::IsNull(mapped.find("missing"));
+
+            // Файл другой раскладки не открывается
+            Mapped_Ordered_Dictionary<std::string, int> wrong("hash_test.dmap");
+            Assert::IsFalse(wrong.is_open());
+            Assert::IsNull(wrong.find("key1"));
+
+            // Секция, выходящая за конец файла (смещение с переполнением), отвергается
+            std::ifstream in("hash_test.dmap", std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            in.close();
+            Mapped_Header header;
+            std::memcpy(&header, bytes.data(), sizeof(header));
+            header.keys_offset = UINT64_MAX - mapped_page_size + 1;
+            std::memcpy(&bytes[0], &header, sizeof(header));
+            std::ofstream("hash_bad.dmap", std::ios::binary).write(bytes.data(), bytes.size());
+            Mapped_Hash_Dictionary<std::string, int> corrupted("hash_bad.dmap");
+            Assert::IsFalse(corrupted.is_open());
+            Assert::IsNull(corrupted.find("key1"));
+        }
+
+        //Тест 20: Сохранение в поток и загрузка, порча данных обнаруживается по CRC
+        TEST_METHOD(Test_Save_Load) {
+            Dictionary<std::string, int> dict;
+            for (int i = 0; i < 10000; ++i) {
+                dict.insert("key" + std::to_string(i), i);
+            }
+            std::stringstream stream;
+            Assert::IsTrue(dict.save(stream));
+            std::string bytes = stream.str();
+
+            Dictionary<std::string, int> loaded;
+            Assert::IsTrue(loaded.load(stream));
+            Assert::AreEqual(10000, loaded.size());
+            for (int i = 0; i < 10000; ++i) {
+                Assert::AreEqual(i, *loaded.find("key" + std::to_string(i)));
+            }
+
+            bytes[bytes.size() / 2] ^= 1;
+            std::stringstream corrupted(bytes);
+            Assert::IsFalse(loaded.load(corrupted));
+            Assert::IsTrue(loaded.empty());
+        }
+
+        //Тест 21: Фильтры принадлежности не меняют результатов поиска
+        TEST_METHOD(Test_Membership_Filters) {
+            Dictionary<int, int, Blocked_Bloom_Filter> bloom;
+            Dictionary<int, int, Fingerprint_Filter> fingerprint;
+            for (int i = 0; i < 5000; ++i) {
+                bloom.insert(i, i);
+                fingerprint.insert(i, i);
+            }
+            for (int i = 0; i < 5000; i += 2) {
+                bloom.erase(i);
+                fingerprint.erase(i);
+            }
+            for (int i = 0; i < 10000; ++i) {
+                bool expected = i < 5000 && i % 2 == 1;
+                Assert::AreEqual(expected, bloom.contains(i));
+                Assert::AreEqual(expected, fingerprint.find(i) != nullptr);
+            }
+        }
+
+        //Тест 22: Малый словарь хранит элементы внутри себя и переезжает в таблицу при росте
+        TEST_METHOD(Test_Small_Dictionary) {
+            Small_Dictionary<int, int, Dictionary<int, int>, 8> dict;
+            for (int i = 0; i < 8; ++i) {
+                Assert::IsTrue(dict.insert(i * 7, i));
+            }
+            Assert::IsTrue(dict.is_inline());
+            Assert::IsFalse(dict.insert(14, 100));
+            Assert::AreEqual(100, *dict.find(14));
+            Assert::IsTrue(dict.erase(0));
+            Assert::IsFalse(dict.contains(0));
+            Assert::IsTrue(dict.find(5) == nullptr);
+
+            for (int i = 8; i < 50; ++i) {
+                dict.insert(i * 7, i);
+            }
+            Assert::IsFalse(dict.is_inline());
+            Assert::AreEqual(static_cast<size_t>(49), dict.size());
+            Assert::AreEqual(100, *dict.find(14));
+            Assert::AreEqual(49, *dict.find(343));
+
+            dict.clear();
+            Assert::IsTrue(dict.is_inline());
+            Assert::IsTrue(dict.empty());
+        }
+
+        //Тест 23: Разбитый на части словарь под параллельной вставкой и удалением
+        TEST_METHOD(Test_Sharded_Dictionary) {
+            Sharded_Dictionary<int, int, Dictionary<int, int>> dict;
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&dict, t] {
+                    for (int i = t * 1000; i < (t + 1) * 1000; ++i) {
+                        dict.insert(i, i * 2);
+                    }
+                    for (int i = t * 1000; i < (t + 1) * 1000; i += 2) {
+                        dict.erase(i);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            Assert::AreEqual(static_cast<size_t>(2000), dict.size());
+            int value = 0;
+            Assert::IsTrue(dict.find(3001, value));
+            Assert::AreEqual(6002, value);
+            Assert::IsFalse(dict.contains(3000));
+        }
+
+        //Тест 24: Статистика хэш-таблицы и счётчик расширений
+        TEST_METHOD(Test_Hash_Stats) {
+            Dictionary<int, int, No_Filter, true> dict;
+            for (int i = 0; i < 100; ++i) {
+                dict.insert(i, i);
+            }
+            Hash_Stats stats = dict.stats();
+            Assert::AreEqual(static_cast<size_t>(100), stats.element_count);
+            Assert::AreEqual(static_cast<size_t>(256), stats.bucket_count);
+            Assert::AreEqual(static_cast<size_t>(4), stats.resize_count);
+            Assert::IsTrue(stats.counters_enabled);
+            size_t buckets = 0, elements = 0;
+            for (size_t k = 0; k < stats.chain_histogram.size(); ++k) {
+                buckets += stats.chain_histogram[k];
+                elements += k * stats.chain_histogram[k];
+            }
+            Assert::AreEqual(stats.bucket_count, buckets);
+            Assert::AreEqual(stats.element_count, elements);
+            Assert::AreEqual(double(stats.chain_histogram[0]) / 256, stats.empty_bucket_ratio);
+
+            dict.reset_stats();
+            Assert::AreEqual(static_cast<size_t>(0), dict.stats().resize_count);
+            dict.clear();
+
+            // Без Collect_Stats счётчики не ведутся, структурные показатели доступны
+            Dictionary<int, int> plain;
+            plain.insert(1, 1);
+            Assert::IsFalse(plain.stats().counters_enabled);
+            Assert::AreEqual(static_cast<size_t>(1), plain.stats().max_chain);
+            plain.clear();
+        }
+
+        //Тест 25: Запись трассы и её воспроизведение на другом словаре, ключи на краях 64-битного диапазона
+        TEST_METHOD(Test_Trace_Replay) {
+            std::stringstream stream;
+            {
+                Traced_Dictionary<int, int, Dictionary<int, int>> dict(stream);
+                for (int i = 0; i < 100; ++i) {
+                    dict.insert(i * 3, i);
+                }
+                dict.insert(3, 42);
+                Assert::IsTrue(dict.contains(297));
+                Assert::IsFalse(dict.contains(298));
+                Assert::IsTrue(dict.erase(0));
+                Assert::IsFalse(dict.erase(0));
+                Assert::AreEqual(static_cast<uint64_t>(105), dict.recorded());
+            }
+
+            std::vector<Trace_Op<int, int>> ops;
+            Assert::IsTrue(load_trace(stream, ops));
+            Assert::AreEqual(static_cast<size_t>(105), ops.size());
+            Assert::IsFalse(ops[100].result);   // повторная вставка ключа 3
+            Assert::AreEqual(42, ops[100].value);
+
+            RB_Dictionary<int, int> tree;
+            Replay_Result result = replay_trace(tree, ops);
+            Assert::AreEqual(static_cast<size_t>(105), result.operations);
+            Assert::AreEqual(static_cast<size_t>(0), result.divergences);
+            Assert::AreEqual(42, *tree.find(3));
+
+            // Трасса со строковыми ключами не читается как трасса с целыми
+            std::stringstream strings;
+            {
+                Traced_Dictionary<std::string, int, Dictionary<std::string, int>> dict(strings);
+                dict.insert("a", 1);
+            }
+            std::vector<Trace_Op<int, int>> wrong;
+            Assert::IsFalse(load_trace(strings, wrong));
+
+            // Разности ключей на краях 64-битного диапазона не переполняются
+            const int64_t signed_keys[] = { INT64_MIN, INT64_MAX, 0, INT64_MIN, -1, INT64_MAX };
+            const uint64_t unsigned_keys[] = { 0, UINT64_MAX, 1, UINT64_MAX - 1, 0 };
+            std::stringstream signed_stream, unsigned_stream;
+            {
+                Trace_Writer<int64_t, int> signed_writer(signed_stream);
+                for (int64_t key : signed_keys) {
+                    signed_writer.record(TRACE_FIND, key, nullptr, true);
+                }
+                Trace_Writer<uint64_t, int> unsigned_writer(unsigned_stream);
+                for (uint64_t key : unsigned_keys) {
+                    unsigned_writer.record(TRACE_FIND, key, nullptr, true);
+                }
+            }
+            std::vector<Trace_Op<int64_t, int>> signed_ops;
+            Assert::IsTrue(load_trace(signed_stream, signed_ops));
+            Assert::AreEqual(static_cast<size_t>(6), signed_ops.size());
+            for (size_t i = 0; i < signed_ops.size(); ++i) {
+                Assert::IsTrue(signed_ops[i].key == signed_keys[i]);
+            }
+            std::vector<Trace_Op<uint64_t, int>> unsigned_ops;
+            Assert::IsTrue(load_trace(unsigned_stream, unsigned_ops));
+            Assert::AreEqual(static_cast<size_t>(5), unsigned_ops.size());
+            for (size_t i = 0; i < unsigned_ops.size(); ++i) {
+                Assert::IsTrue(unsigned_ops[i].key == unsigned_keys[i]);
+            }
+        }
+
+        //Тест 26: Параллельная загрузка совпадает с вставкой по одной, в том числе на непотокобезопасной арене
+        TEST_METHOD(Test_Bulk_Insert) {
+            std::vector<std::pair<int, int>> pairs;
+            for (int i = 0; i < 20000; ++i) {
+                pairs.push_back({ (i * 7919) % 15000, i });
+            }
+            Dictionary<int, int> serial;
+            for (const auto& pair : pairs) {
+                serial.insert(pair.first, pair.second);
+            }
+
+            Dictionary<int, int> bulk;
+            bulk.insert(100000, -1);
+            bulk.bulk_insert(pairs, 4);
+            Assert::AreEqual(serial.size() + 1, bulk.size());
+            for (int key = 0; key < 15000; ++key) {
+                Assert::AreEqual(*serial.find(key), *bulk.find(key));
+            }
+            Assert::AreEqual(-1, *bulk.find(100000));
+
+            // Параллельное расширение сохраняет все элементы
+            bulk.reserve(200000, 4);
+            Assert::IsTrue(bulk.get_size() * bulk.get_max_load_factor() >= 200000);
+            Assert::AreEqual(serial.size() + 1, bulk.size());
+            Assert::IsTrue(bulk.contains(14999));
+
+            // Источник памяти без синхронизации: узлы выделяет только вызывающий поток
+            Huge_Page_Resource arena(HUGE_PAGES_OFF);
+            Dictionary<int, int> on_arena(&arena);
+            on_arena.bulk_insert(pairs, 4);
+            Assert::AreEqual(serial.size(), on_arena.size());
+            for (int key = 0; key < 15000; ++key) {
+                Assert::AreEqual(*serial.find(key), *on_arena.find(key));
+            }
+        }
+
+        //Тест 27: Узлы и таблица выделяются из переданного источника памяти
+        TEST_METHOD(Test_Memory_Resource) {
+            Counting_Resource counting;
+            Dictionary<int, int> dict(&counting);
+            Assert::IsTrue(dict.get_resource() == &counting);
+            size_t empty_bytes = counting.bytes;
+            Assert::AreEqual(dict.get_size() * sizeof(void*), empty_bytes);
+
+            for (int i = 0; i < 1000; ++i) {
+                dict.insert(i, i);
+            }
+            Assert::IsTrue(counting.bytes > 1000 * sizeof(int) * 2);
+            Assert::AreEqual(999, *dict.find(999));
+            dict.clear();
+            Assert::AreEqual(dict.get_size() * sizeof(void*), counting.bytes);
+
+            // Словари на одной арене
+            char buffer[1 << 14];
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            Dictionary<int, int> first(&arena), second(&arena);
+            first.insert(1, 10);
+            second.insert(1, 20);
+            Assert::AreEqual(10, *first.find(1));
+            Assert::AreEqual(20, *second.find(1));
+        }
+
+        //Тест 28: Словари с раздельными массивами ключей и значений
+        TEST_METHOD(Test_Split_Layout) {
+            Split_Hash_Dictionary<int, std::string> hash;
+            Split_RB_Dictionary<int, std::string> tree;
+            for (int i = 0; i < 500; ++i) {
+                Assert::IsTrue(hash.insert(i, std::to_string(i)));
+                Assert::IsTrue(tree.insert(i, std::to_string(i)));
+            }
+            Assert::IsFalse(hash.insert(7, "seven"));
+            Assert::IsFalse(tree.insert(7, "seven"));
+            for (int i = 0; i < 500; i += 2) {
+                Assert::IsTrue(hash.erase(i));
+                Assert::IsTrue(tree.erase(i));
+            }
+            Assert::IsFalse(hash.erase(0));
+            Assert::IsFalse(tree.erase(0));
+            Assert::AreEqual(static_cast<size_t>(250), hash.size());
+            Assert::AreEqual(static_cast<size_t>(250), tree.size());
+            Assert::AreEqual(std::string("seven"), *hash.find(7));
+            Assert::AreEqual(std::string("seven"), *tree.find(7));
+            Assert::AreEqual(std::string("499"), *tree.find(499));
+            Assert::IsTrue(hash.find(2) == nullptr);
+            Assert::IsTrue(tree.height() <= 17);
+
+            // Освобождённые слоты переиспользуются
+            Assert::IsTrue(hash.insert(1000, "new"));
+            Assert::IsTrue(hash.contains(1000));
+
+            Assert::IsTrue(check_key_order(tree, [](int key, const std::string&) { return key % 2 == 1; }).ordered);
+        }
+
+        //Тест 29: Кэш не превышает ёмкость и вытесняет элементы без обращений
+        TEST_METHOD(Test_Clock_Cache) {
+            Cache_Dictionary<int, int> cache(4);
+            for (int i = 0; i < 4; ++i) {
+                Assert::IsFalse(cache.insert(i, i * 10));
+            }
+            // Обращение к 0 и 2 даёт им второй шанс
+            Assert::AreEqual(0, *cache.find(0));
+            Assert::AreEqual(20, *cache.find(2));
+            Assert::IsTrue(cache.find(7) == nullptr);
+
+            Assert::IsTrue(cache.insert(4, 40));
+            Assert::AreEqual(static_cast<size_t>(4), cache.size());
+            Assert::IsFalse(cache.contains(1));
+            Assert::IsTrue(cache.contains(0));
+            Assert::IsTrue(cache.contains(2));
+            Assert::IsTrue(cache.insert(5, 50));
+            Assert::IsFalse(cache.contains(3));
+
+            // Освобождённый erase() слот занимается без вытеснения
+            Assert::IsTrue(cache.erase(5));
+            Assert::IsFalse(cache.insert(6, 60));
+            Assert::AreEqual(static_cast<size_t>(4), cache.size());
+
+            Cache_Stats stats = cache.stats();
+            Assert::AreEqual(static_cast<size_t>(2), stats.hits);
+            Assert::AreEqual(static_cast<size_t>(1), stats.misses);
+            Assert::AreEqual(static_cast<size_t>(2), stats.evictions);
+            Assert::AreEqual(static_cast<size_t>(4), stats.capacity);
+            cache.reset_stats();
+            Assert::AreEqual(static_cast<size_t>(0), cache.stats().hits);
+        }
+
+        //Тест 30: Арена больших страниц выдаёт узлы из кусков по 2 МиБ, переиспользует освобождённые и не теряет большие блоки
+        TEST_METHOD(Test_Huge_Page_Resource) {
+            for (Huge_Page_Mode mode : { HUGE_PAGES_OFF, HUGE_PAGES_AUTO }) {
+                Huge_Page_Resource arena(mode);
+                Assert::AreEqual(static_cast<size_t>(0), arena.stats().mapped_bytes);
+
+                void* first = arena.allocate(24, 8);
+                Assert::AreEqual(static_cast<size_t>(0), reinterpret_cast<uintptr_t>(first) % 8);
+                arena.deallocate(first, 24, 8);
+                Assert::IsTrue(arena.allocate(24, 8) == first);
+
+                // Блоки средних размеров переиспользуются по степени двойки
+                void* middle = arena.allocate(3000, 8);
+                arena.deallocate(middle, 3000, 8);
+                Assert::IsTrue(arena.allocate(4096, 8) == middle);
+
+                // Большой блок отображается отдельно и возвращается ОС в deallocate;
+                // невозвращённый большой блок освобождает деструктор арены
+                size_t before = arena.stats().mapped_bytes;
+                void* large = arena.allocate(Huge_Page_Resource::chunk_size, 8);
+                Assert::AreEqual(before + Huge_Page_Resource::chunk_size, arena.stats().mapped_bytes);
+                arena.deallocate(large, Huge_Page_Resource::chunk_size, 8);
+                Assert::AreEqual(before, arena.stats().mapped_bytes);
+                Assert::IsTrue(arena.allocate(Huge_Page_Resource::chunk_size, 8) != nullptr);
+
+                Dictionary<int, int> dict(&arena);
+                for (int i = 0; i < 100000; ++i) {
+                    dict.insert(i, i * 2);
+                }
+                for (int i = 0; i < 100000; i += 2) {
+                    dict.erase(i);
+                }
+                Assert::AreEqual(19998, *dict.find(9999));
+                Assert::IsTrue(dict.find(10000) == nullptr);
+                dict.clear();
+
+                Huge_Page_Stats stats = arena.stats();
+                Assert::IsTrue(stats.mapped_bytes > 0);
+                Assert::AreEqual(static_cast<size_t>(0), stats.mapped_bytes % Huge_Page_Resource::chunk_size);
+                if (mode == HUGE_PAGES_OFF) {
+                    Assert::AreEqual(static_cast<size_t>(0), stats.explicit_chunks + stats.transparent_chunks);
+                }
+            }
+        }
 	};
 }
@@ -1,5 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <vector>
+#include "Binary_Stream.h"
+#include "Membership_Filter.h"
+#include "Container_Stats.h"
 
 // Ñòðóêòóðà Chain ïðåäñòàâëÿåò ýëåìåíò öåïî÷êè äëÿ ìåòîäà ðàçðåøåíèÿ êîëëèçèé
 template <typename t_key, typename t_value>
@@ -18,11 +27,17 @@ struct Chain {
     }
 };
 
-// Êëàññ Dictionary ðåàëèçóåò õýø-òàáëèöó ñ ìåòîäîì öåïî÷åê
-template <typename t_key, typename t_value>
+// Êëàññ Dictionary ðåàëèçóåò õýø-òàáëèöó ñ ìåòîäîì öåïî÷åê.
+// Filter — íåîáÿçàòåëüíûé ôèëüòð ïðèíàäëåæíîñòè (ñì. Membership_Filter.h), îòñåêàþùèé ïðîìàõè.
+// Collect_Stats — âåñòè ñ÷¸ò÷èêè ñîáûòèé äëÿ stats() (ñì. Container_Stats.h)
+// Ïàìÿòü ïîä óçëû è òàáëèöó áåð¸òñÿ èç std::pmr::memory_resource, ïåðåäàííîãî â êîíñòðóêòîð:
+// íåñêîëüêî ñëîâàðåé ìîãóò äåëèòü îäèí ïóë; äåñòðóêòîð âîçâðàùàåò óçëû è òàáëèöó â resource.
+template <typename t_key, typename t_value, typename Filter = No_Filter, bool Collect_Stats = false>
 class Dictionary
 {
 private:
+    // Èñòî÷íèê ïàìÿòè äëÿ óçëîâ è òàáëèöû
+    std::pmr::memory_resource* resource;
     // Ðàçìåð õýø-òàáëèöû (íà÷àëüíîå çíà÷åíèå - 16)
     size_t table_size = 16;
     // Ìàññèâ óêàçàòåëåé íà öåïî÷êè (ñàìà õýø-òàáëèöà)
@@ -31,6 +46,32 @@ private:
     int element_count;
     // Ìàêñèìàëüíî äîïóñòèìûé êîýôôèöèåíò çàïîëíåíèÿ òàáëèöû (75%)
     float max_load_factor = 0.75f;
+    // Ôèëüòð ïðèíàäëåæíîñòè (ïóñòîé ïðè Filter = No_Filter)
+    Filter filter;
+    // Ñ÷¸ò÷èê ðàñøèðåíèé òàáëèöû (ïóñòîé ïðè Collect_Stats = false)
+    Stats_Counter<Collect_Stats> resizes;
+
+    // Ñîçäàíèå óçëà â ïàìÿòè èç resource
+    Chain<t_key, t_value>* create_chain(const t_key& key, const t_value& value) {
+        void* memory = resource->allocate(sizeof(Chain<t_key, t_value>), alignof(Chain<t_key, t_value>));
+        return new (memory) Chain<t_key, t_value>(key, value);
+    }
+
+    // Óäàëåíèå óçëà è âîçâðàò ïàìÿòè â resource
+    void destroy_chain(Chain<t_key, t_value>* node) {
+        node->~Chain();
+        resource->deallocate(node, sizeof(Chain<t_key, t_value>), alignof(Chain<t_key, t_value>));
+    }
+
+    // Ìàññèâ óêàçàòåëåé íà öåïî÷êè (íå îáíóë¸ííûé)
+    Chain<t_key, t_value>** allocate_table(size_t size) {
+        return static_cast<Chain<t_key, t_value>**>(
+            resource->allocate(size * sizeof(Chain<t_key, t_value>*), alignof(Chain<t_key, t_value>*)));
+    }
+
+    void free_table(Chain<t_key, t_value>** old_table, size_t size) {
+        resource->deallocate(old_table, size * sizeof(Chain<t_key, t_value>*), alignof(Chain<t_key, t_value>*));
+    }
 
     // Õýø-ôóíêöèÿ ñ ïåðåãðóçêîé äëÿ ðàçíûõ òèïîâ êëþ÷åé
     int hashFunction(const t_key& key) const {
@@ -56,48 +97,117 @@ private:
     // Ìåòîä óâåëè÷åíèÿ ðàçìåðà òàáëèöû è ïåðåðàñïðåäåëåíèÿ ýëåìåíòîâ
     void resize() {
         // Óäâàèâàåì ðàçìåð òàáëèöû
-        table_size *= 2;
-        // Ñîçäàåì íîâóþ òàáëèöó ñ îáíóëåííûìè óêàçàòåëÿìè
-        Chain<t_key, t_value>** new_table = new Chain<t_key, t_value>* [table_size]();
+        grow_to(table_size * 2, 1);
+    }
 
-        // Ïåðåíîñèì ýëåìåíòû â íîâóþ òàáëèöó
-        for (size_t i = 0; i < table_size / 2; ++i) {
-            Chain<t_key, t_value>* current = table[i];
-            while (current != nullptr) {
-                Chain<t_key, t_value>* next = current->next;
+    // Çàïóñêàåò work(t) äëÿ t = 0..threads-1; ÷àñòü 0 âûïîëíÿåòñÿ â âûçûâàþùåì ïîòîêå
+    template <typename Work>
+    static void run_parallel(unsigned threads, Work work) {
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work, t);
+        }
+        work(0u);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
 
-                // Âû÷èñëÿåì íîâûé èíäåêñ äëÿ ýëåìåíòà
-                size_t new_index = hashFunction(current->key);
+    // Ïåðåíîñ âñåõ ýëåìåíòîâ â òàáëèöó ðàçìåðà new_size (òåêóùèé ðàçìåð, óìíîæåííûé íà ñòåïåíü äâîéêè).
+    // Èíäåêñ êîðçèíû — ìëàäøèå áèòû õýøà, ïîýòîìó ýëåìåíò èç ñòàðîé êîðçèíû i ïîïàäàåò â íîâóþ
+    // êîðçèíó ñ òåì æå îñòàòêîì i ïî ìîäóëþ ñòàðîãî ðàçìåðà. Ïîòîêè äåëÿò ñòàðûå êîðçèíû
+    // íà íåïðåðûâíûå ÷àñòè è ïèøóò òîëüêî â «ñâîè» êîðçèíû íîâîé òàáëèöû, áåç áëîêèðîâîê.
+    void grow_to(size_t new_size, unsigned threads) {
+        size_t old_size = table_size;
+        table_size = new_size;
+        resizes.add();
+        // Ñîçäàåì íîâóþ òàáëèöó; îáíóëÿþò å¸ ïîòîêè, êàæäûé ñâîè êîðçèíû
+        Chain<t_key, t_value>** new_table = allocate_table(table_size);
+        // Ìåëêèå òàáëèöû íå ñòîèò äåëèòü ìåæäó ïîòîêàìè
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, old_size / 4096 + 1)));
 
-                // Äîáàâëÿåì ýëåìåíò â íà÷àëî íîâîé öåïî÷êè
-                current->next = new_table[new_index];
-                new_table[new_index] = current;
+        run_parallel(threads, [&](unsigned t) {
+            size_t begin = old_size * t / threads;
+            size_t end = old_size * (t + 1) / threads;
+            for (size_t offset = 0; offset < table_size; offset += old_size) {
+                std::fill(new_table + offset + begin, new_table + offset + end, nullptr);
+            }
 
-                current = next;
+            // Ïåðåíîñèì ýëåìåíòû â íîâóþ òàáëèöó
+            for (size_t i = begin; i < end; ++i) {
+                Chain<t_key, t_value>* current = table[i];
+                while (current != nullptr) {
+                    Chain<t_key, t_value>* next = current->next;
+
+                    // Âû÷èñëÿåì íîâûé èíäåêñ äëÿ ýëåìåíòà
+                    size_t new_index = hashFunction(current->key);
+
+                    // Äîáàâëÿåì ýëåìåíò â íà÷àëî íîâîé öåïî÷êè
+                    current->next = new_table[new_index];
+                    new_table[new_index] = current;
+
+                    current = next;
+                }
             }
-        }
+        });
 
         // Óäàëÿåì ñòàðóþ òàáëèöó (íå óäàëÿåì ýëåìåíòû!)
-        delete[] table;
+        free_table(table, old_size);
 
         // Îáíîâëÿåì óêàçàòåëü íà òàáëèöó è åå ðàçìåð
         table = new_table;
+
+        // Ôèëüòð ïåðåñîáèðàåì ïîä íîâóþ âìåñòèìîñòü òàáëèöû
+        rebuild_filter();
+    }
+
+    // Ïåðåñáîðêà ôèëüòðà ïî âñåì êëþ÷àì òàáëèöû
+    void rebuild_filter() {
+        if constexpr (Filter::enabled) {
+            rebuild_membership_filter(filter, static_cast<size_t>(table_size * max_load_factor), [&](auto add) {
+                for_each([&](const t_key& key, const t_value&) {
+                    add(membership_hash(key));
+                });
+            });
+        }
     }
 
 public:
-    // Êîíñòðóêòîð ïî óìîë÷àíèþ
-    Dictionary() : table(new Chain<t_key, t_value>* [16]()), table_size(16), element_count(0) {
+    // Êîíñòðóêòîð ïî óìîë÷àíèþ: ïàìÿòü èç std::pmr::get_default_resource() (îáû÷íûå new/delete)
+    Dictionary() : Dictionary(std::pmr::get_default_resource()) {
+    }
+
+    // Êîíñòðóêòîð ñ èñòî÷íèêîì ïàìÿòè; resource äîëæåí æèòü äîëüøå ñëîâàðÿ
+    explicit Dictionary(std::pmr::memory_resource* memory)
+        : resource(memory), table_size(16), element_count(0) {
+        table = allocate_table(table_size);
         // Èíèöèàëèçèðóåì âñå óêàçàòåëè òàáëèöû çíà÷åíèåì nullptr
         for (size_t i = 0; i < table_size; ++i) {
             table[i] = nullptr;
         }
+        rebuild_filter();
     }
 
+    // Äåñòðóêòîð: óçëû è òàáëèöà âîçâðàùàþòñÿ â resource
+    ~Dictionary() {
+        clear();
+        free_table(table, table_size);
+    }
+
+    // Ñëîâàðü âëàäååò óçëàìè è òàáëèöåé, êîïèðîâàíèå è ïåðåìåùåíèå çàïðåùåíû
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
     // Ïîëó÷èòü òåêóùèé ðàçìåð òàáëèöû
     size_t get_size() {
         return table_size;
     }
 
+    // Èñòî÷íèê ïàìÿòè ñëîâàðÿ
+    std::pmr::memory_resource* get_resource() const {
+        return resource;
+    }
+
     // Ïîëó÷èòü ìàêñèìàëüíûé êîýôôèöèåíò çàïîëíåíèÿ
     float get_max_load_factor() {
         return max_load_factor;
@@ -124,20 +234,117 @@ public:
         // Äîáàâëÿåì íîâûé ýëåìåíò â öåïî÷êó
         if (table[index] == nullptr) {
             // Äîáàâëåíèå â ïóñòóþ ÿ÷åéêó
-            table[index] = new Chain<t_key, t_value>(key, value);
+            table[index] = create_chain(key, value);
         }
         else {
             // Äîáàâëåíèå â íà÷àëî ñóùåñòâóþùåé öåïî÷êè
-            Chain<t_key, t_value>* temp = new Chain<t_key, t_value>(key, value);
+            Chain<t_key, t_value>* temp = create_chain(key, value);
             temp->next = table[index];
             table[index] = temp;
         }
         // Óâåëè÷èâàåì ñ÷åò÷èê ýëåìåíòîâ
         element_count++;
+
+        if constexpr (Filter::enabled) {
+            if (!filter.add(membership_hash(key))) {
+                rebuild_filter();
+            }
+        }
+    }
+
+    // Ðàñøèðÿåò òàáëèöó òàê, ÷òîáû count ýëåìåíòîâ ïîìåñòèëèñü áåç ðàñøèðåíèé ïðè âñòàâêå.
+    // Ïåðåðàñïðåäåëåíèå ýëåìåíòîâ âûïîëíÿåòñÿ threads ïîòîêàìè.
+    void reserve(size_t count, unsigned threads = 1) {
+        size_t new_size = table_size;
+        while (count > new_size * max_load_factor) {
+            new_size *= 2;
+        }
+        if (new_size != table_size) {
+            grow_to(new_size, threads);
+        }
+    }
+
+    // Âñòàâêà íàáîðà ïàð (äèàïàçîí ñ ïðîèçâîëüíûì äîñòóïîì, ýëåìåíòû ñ ïîëÿìè first è second)
+    // íåñêîëüêèìè ïîòîêàìè. Òàáëèöà çàðàíåå ðàñøèðÿåòñÿ ïîä èòîãîâîå ÷èñëî ýëåìåíòîâ, çàòåì
+    // ïàðû äåëÿòñÿ ïî èíäåêñó êîðçèíû íà íåïåðåñåêàþùèåñÿ äèàïàçîíû êîðçèí, è êàæäûé ïîòîê
+    // ñòðîèò öåïî÷êè ñâîåãî äèàïàçîíà áåç áëîêèðîâîê. Ðåçóëüòàò òîò æå, ÷òî ó âñòàâêè ïî
+    // îäíîé: äëÿ ïîâòîðÿþùèõñÿ êëþ÷åé îñòà¸òñÿ ïîñëåäíåå çíà÷åíèå.
+    // Ïàìÿòü ïîä óçëû âûäåëÿåò âûçûâàþùèé ïîòîê (ïî áëîêó íà ïàðó, ëèøíèå áëîêè ïîâòîðÿþùèõñÿ
+    // êëþ÷åé âîçâðàùàþòñÿ â êîíöå), ïîòîêè òîëüêî êîíñòðóèðóþò è ñâÿçûâàþò óçëû, ïîýòîìó
+    // resource íå îáÿçàí áûòü ïîòîêîáåçîïàñíûì (àðåíû, Huge_Page_Resource).
+    template <typename Range>
+    void bulk_insert(const Range& pairs, unsigned threads = std::thread::hardware_concurrency()) {
+        auto first = std::begin(pairs);
+        size_t count = static_cast<size_t>(std::end(pairs) - first);
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, count / 4096 + 1)));
+        reserve(static_cast<size_t>(element_count) + count, threads);
+
+        // Áëîêè ïîä óçëû; ïîòîê, êîòîðîìó äîñòàëàñü ïàðà, çàáèðàåò å¸ áëîê (îáíóëÿåò óêàçàòåëü)
+        std::vector<void*> memory(count);
+        for (size_t i = 0; i < count; ++i) {
+            memory[i] = resource->allocate(sizeof(Chain<t_key, t_value>), alignof(Chain<t_key, t_value>));
+        }
+
+        // Ðàçáèåíèå: ïîòîê s ðàñêëàäûâàåò ñâîþ ÷àñòü âõîäà ïî äèàïàçîíàì êîðçèí
+        struct Slot {
+            size_t index;      // êîðçèíà
+            size_t position;   // íîìåð ïàðû âî âõîäå
+        };
+        std::vector<std::vector<std::vector<Slot>>> slots(threads, std::vector<std::vector<Slot>>(threads));
+        run_parallel(threads, [&](unsigned s) {
+            size_t begin = count * s / threads;
+            size_t end = count * (s + 1) / threads;
+            for (auto& part : slots[s]) {
+                part.reserve((end - begin) / threads + 16);
+            }
+            for (size_t i = begin; i < end; ++i) {
+                size_t index = hashFunction(first[i].first);
+                slots[s][index * threads / table_size].push_back({ index, i });
+            }
+        });
+
+        // Ïîñòðîåíèå: ïîòîê p ïðîõîäèò ÷àñòè âñåõ ïîòîêîâ ïî ïîðÿäêó, ñîõðàíÿÿ ïîðÿäîê âõîäà
+        std::vector<size_t> added(threads, 0);
+        run_parallel(threads, [&](unsigned p) {
+            for (unsigned s = 0; s < threads; ++s) {
+                for (const Slot& slot : slots[s][p]) {
+                    const auto& pair = first[slot.position];
+                    Chain<t_key, t_value>* temp = table[slot.index];
+                    while (temp != nullptr && !(temp->key == pair.first)) {
+                        temp = temp->next;
+                    }
+                    if (temp != nullptr) {
+                        temp->value = pair.second;
+                        continue;
+                    }
+                    temp = new (memory[slot.position]) Chain<t_key, t_value>(pair.first, pair.second);
+                    memory[slot.position] = nullptr;
+                    temp->next = table[slot.index];
+                    table[slot.index] = temp;
+                    ++added[p];
+                }
+            }
+        });
+
+        for (size_t n : added) {
+            element_count += static_cast<int>(n);
+        }
+        for (void* unused : memory) {
+            if (unused != nullptr) {
+                resource->deallocate(unused, sizeof(Chain<t_key, t_value>), alignof(Chain<t_key, t_value>));
+            }
+        }
+        rebuild_filter();
     }
 
     // Ïîèñê çíà÷åíèÿ ïî êëþ÷ó
     t_value* find(const t_key& key) const {
+        // Ôèëüòð òî÷íî îòâå÷àåò íà îòñóòñòâèå êëþ÷à, íå òðîãàÿ öåïî÷êó
+        if constexpr (Filter::enabled) {
+            if (!filter.may_contain(membership_hash(key))) {
+                return nullptr;
+            }
+        }
         // Âû÷èñëÿåì èíäåêñ äëÿ ïîèñêà
         int index = hashFunction(key);
 
@@ -154,6 +361,11 @@ public:
 
     // Ïðîâåðêà íàëè÷èÿ êëþ÷à â òàáëèöå
     bool contains(const t_key& key) const {
+        if constexpr (Filter::enabled) {
+            if (!filter.may_contain(membership_hash(key))) {
+                return false;
+            }
+        }
         int index = hashFunction(key);
         // Ïðîâåðÿåì öåïî÷êó íà íàëè÷èå êëþ÷à
         for (Chain<t_key, t_value>* temp = table[index]; temp != nullptr; temp = temp->next) {
@@ -183,7 +395,10 @@ public:
                     // Óäàëåíèå ýëåìåíòà èç ñåðåäèíû/êîíöà öåïî÷êè
                     before->next = current->next;
                 }
-                delete current;
+                destroy_chain(current);
+                if constexpr (Filter::enabled) {
+                    filter.remove(membership_hash(key));
+                }
                 return;
             }
             before = current;
@@ -200,18 +415,98 @@ public:
         }
     }
 
+    // Îáõîä âñåõ ïàð: âûçûâàåò func(key, value) äëÿ êàæäîãî ýëåìåíòà (ïîðÿäîê íå îïðåäåë¸í)
+    template <typename Func>
+    void for_each(Func func) const {
+        for (size_t i = 0; i < table_size; ++i) {
+            for (Chain<t_key, t_value>* temp = table[i]; temp != nullptr; temp = temp->next) {
+                func(temp->key, temp->value);
+            }
+        }
+    }
+
+    // Ñîõðàíåíèå âñåõ ïàð â äâîè÷íûé ïîòîê (ôîðìàò îïèñàí â Binary_Stream.h)
+    bool save(std::ostream& out) const {
+        Binary_Writer writer(out);
+        writer.write_header(BINARY_HASH, element_count);
+        for_each([&](const t_key& key, const t_value& value) {
+            writer.write(key);
+            writer.write(value);
+        });
+        return writer.finish();
+    }
+
+    // Çàãðóçêà ïàð èç äâîè÷íîãî ïîòîêà; ïðè îøèáêå èëè íåñîâïàäåíèè CRC òàáëèöà îñòà¸òñÿ ïóñòîé
+    bool load(std::istream& in) {
+        clear();
+        Binary_Reader reader(in);
+        uint64_t count = 0;
+        if (!reader.read_header(BINARY_HASH, count)) {
+            return false;
+        }
+        t_key key;
+        t_value value;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!reader.read(key) || !reader.read(value)) {
+                clear();
+                return false;
+            }
+            insert(key, value);
+        }
+        if (!reader.finish()) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
     // Î÷èñòêà âñåé òàáëèöû
     void clear() {
         for (size_t i = 0; i < table_size; ++i) {
             Chain<t_key, t_value>* current = table[i];
             while (current != nullptr) {
                 Chain<t_key, t_value>* next = current->next;
-                delete current;
+                destroy_chain(current);
                 current = next;
             }
             table[i] = nullptr;
         }
         element_count = 0;
+        rebuild_filter();
+    }
+
+    // Ñíèìîê âíóòðåííåãî óñòðîéñòâà òàáëèöû (îáõîäèò âñå êîðçèíû, O(n))
+    Hash_Stats stats() const {
+        Hash_Stats result;
+        result.element_count = static_cast<size_t>(element_count);
+        result.bucket_count = table_size;
+        result.load_factor = double(element_count) / double(table_size);
+        size_t empty_buckets = 0;
+        for (size_t i = 0; i < table_size; ++i) {
+            size_t length = 0;
+            for (Chain<t_key, t_value>* temp = table[i]; temp != nullptr; temp = temp->next) {
+                ++length;
+            }
+            if (length == 0) {
+                ++empty_buckets;
+            }
+            if (length >= result.chain_histogram.size()) {
+                result.chain_histogram.resize(length + 1);
+            }
+            ++result.chain_histogram[length];
+            result.max_chain = std::max(result.max_chain, length);
+        }
+        result.empty_bucket_ratio = double(empty_buckets) / double(table_size);
+        result.bytes = sizeof(*this) + table_size * sizeof(Chain<t_key, t_value>*) +
+            result.element_count * sizeof(Chain<t_key, t_value>);
+        result.counters_enabled = Collect_Stats;
+        result.resize_count = resizes.value();
+        return result;
+    }
+
+    // Îáíóëåíèå ñ÷¸ò÷èêîâ ñîáûòèé
+    void reset_stats() {
+        resizes.reset();
     }
 
     // Ïîëó÷èòü êîëè÷åñòâî ýëåìåíòîâ â òàáëèöå
@@ -0,0 +1,274 @@
+﻿// Huge_Page_Resource.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+//------------------------------------------------------------------------------------------------
+//  Арена для узлов на больших страницах (2 МиБ).
+//
+//  При 10 млн узлов и больше поиск в RB_Dictionary и Dictionary упирается в промахи dTLB:
+//  узлы, выделенные через new, разбросаны по страницам в 4 КиБ, и почти каждый переход
+//  по указателю требует обхода таблиц страниц. Арена берёт у ОС куски по 2 МиБ и нарезает
+//  из них узлы подряд; один кусок на большой странице покрывается одной записью TLB.
+//
+//  Способы получить большую страницу (по порядку, HUGE_PAGES_AUTO):
+//    - Linux: mmap с MAP_HUGETLB (нужны заранее выделенные страницы, vm.nr_hugepages);
+//    - Linux: прозрачные большие страницы — кусок выравнивается на 2 МиБ и помечается
+//      madvise(MADV_HUGEPAGE) (transparent_hugepage = always или madvise);
+//    - Windows: VirtualAlloc с MEM_LARGE_PAGES (нужна привилегия SeLockMemoryPrivilege);
+//    - иначе обычные страницы.
+//  HUGE_PAGES_OFF берёт обычные страницы той же арены (в Linux с MADV_NOHUGEPAGE),
+//  чтобы сравнение «с большими страницами и без» отличалось только размером страницы.
+//
+//  Освобождённые блоки до 512 байт попадают в список свободных своего размера (шаг 16 байт),
+//  блоки до четверти куска — в список своей степени двойки (таблицы корзин Dictionary
+//  и так имеют размер степени двойки); блоки из этих списков переиспользуются.
+//  Блоки больше четверти куска (большие таблицы корзин, пулы указателей) получают
+//  отдельное отображение: оно возвращается ОС в deallocate или, если контейнер не вернул
+//  блок, в деструкторе — вместе со всеми кусками.
+//  Ресурс не потокобезопасен, как std::pmr::unsynchronized_pool_resource.
+//------------------------------------------------------------------------------------------------
+
+enum Huge_Page_Mode {
+    HUGE_PAGES_OFF,           // только обычные страницы
+    HUGE_PAGES_AUTO,          // MAP_HUGETLB, затем прозрачные большие страницы, затем обычные
+    HUGE_PAGES_TRANSPARENT    // только прозрачные большие страницы (или обычные)
+};
+
+// Как были получены куски арены (включая отдельные отображения больших блоков)
+struct Huge_Page_Stats {
+    size_t explicit_chunks = 0;      // MAP_HUGETLB / MEM_LARGE_PAGES
+    size_t transparent_chunks = 0;   // помечено madvise(MADV_HUGEPAGE); выделит ли ядро — его дело
+    size_t normal_chunks = 0;        // обычные страницы
+    size_t mapped_bytes = 0;         // получено у ОС сейчас
+};
+
+class Huge_Page_Resource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t chunk_size = size_t(2) << 20;
+
+private:
+    static constexpr size_t size_step = 16;
+    static constexpr size_t max_small = 512;
+    static constexpr size_t mid_classes = 11;   // 1 КиБ .. 512 КиБ = chunk_size / 4
+
+    struct Free_Block {
+        Free_Block* next;
+    };
+
+    struct Mapping {
+        void*  address;
+        size_t bytes;
+    };
+
+    Huge_Page_Mode       mode;
+    std::vector<Mapping> chunks;
+    std::vector<Mapping> large_blocks;           // отдельные отображения больших блоков
+    char*                cursor = nullptr;       // свободное место текущего куска
+    char*                limit = nullptr;
+    Free_Block*          free_lists[max_small / size_step + 1] = {};
+    Free_Block*          mid_lists[mid_classes] = {};   // блоки max_small << k байт
+    Huge_Page_Stats      counters;
+
+    // Получает у ОС bytes (кратно chunk_size) памяти, выровненной на chunk_size
+    void* map(size_t bytes) {
+#if defined(__linux__)
+        if (mode == HUGE_PAGES_AUTO) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                ++counters.explicit_chunks;
+                counters.mapped_bytes += bytes;
+                return p;
+            }
+        }
+        // С запасом в один кусок, чтобы выровнять начало на 2 МиБ; лишнее отдаём обратно
+        size_t reserve = bytes + chunk_size;
+        void* raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + chunk_size - 1) & ~uintptr_t(chunk_size - 1);
+        if (aligned > begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (aligned + bytes < begin + reserve) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), begin + reserve - aligned - bytes);
+        }
+        void* p = reinterpret_cast<void*>(aligned);
+        if (mode != HUGE_PAGES_OFF && madvise(p, bytes, MADV_HUGEPAGE) == 0) {
+            ++counters.transparent_chunks;
+        }
+        else {
+            if (mode == HUGE_PAGES_OFF) {
+                madvise(p, bytes, MADV_NOHUGEPAGE);
+            }
+            ++counters.normal_chunks;
+        }
+        counters.mapped_bytes += bytes;
+        return p;
+#elif defined(_WIN32)
+        if (mode != HUGE_PAGES_OFF && GetLargePageMinimum() != 0 && chunk_size % GetLargePageMinimum() == 0) {
+            void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (p != nullptr) {
+                ++counters.explicit_chunks;
+                counters.mapped_bytes += bytes;
+                return p;
+            }
+        }
+        void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        ++counters.normal_chunks;
+        counters.mapped_bytes += bytes;
+        return p;
+#else
+        ++counters.normal_chunks;
+        counters.mapped_bytes += bytes;
+        return ::operator new(bytes, std::align_val_t(chunk_size));
+#endif
+    }
+
+    void unmap(void* p, size_t bytes) {
+        counters.mapped_bytes -= bytes;
+#if defined(__linux__)
+        munmap(p, bytes);
+#elif defined(_WIN32)
+        (void)bytes;
+        VirtualFree(p, 0, MEM_RELEASE);
+#else
+        ::operator delete(p, std::align_val_t(chunk_size));
+#endif
+    }
+
+    static size_t round_up(size_t bytes) {
+        return (bytes + chunk_size - 1) / chunk_size * chunk_size;
+    }
+
+    static size_t size_class(size_t bytes) {
+        return (bytes + size_step - 1) / size_step;
+    }
+
+    // Наименьшее k >= 1, при котором max_small << k вмещает bytes
+    static size_t mid_class(size_t bytes) {
+        size_t k = 1;
+        while ((max_small << k) < bytes) {
+            ++k;
+        }
+        return k;
+    }
+
+    static bool is_large(size_t bytes) {
+        return bytes > chunk_size / 4;
+    }
+
+    // Снимает блок с головы списка свободных (nullptr, если список пуст)
+    static void* pop(Free_Block*& list) {
+        Free_Block* block = list;
+        if (block != nullptr) {
+            list = block->next;
+        }
+        return block;
+    }
+
+    static void push(Free_Block*& list, void* p) {
+        Free_Block* block = static_cast<Free_Block*>(p);
+        block->next = list;
+        list = block;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (is_large(bytes)) {
+            void* p = map(round_up(bytes));
+            large_blocks.push_back({ p, round_up(bytes) });
+            return p;
+        }
+        if (bytes == 0) {
+            bytes = 1;
+        }
+
+        // Повторное использование освобождённого блока того же класса размера
+        if (alignment <= size_step) {
+            Free_Block*& list = bytes <= max_small ? free_lists[size_class(bytes)] : mid_lists[mid_class(bytes)];
+            if (void* block = pop(list)) {
+                return block;
+            }
+            bytes = bytes <= max_small ? size_class(bytes) * size_step : max_small << mid_class(bytes);
+        }
+
+        uintptr_t start = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~uintptr_t(alignment - 1);
+        if (cursor == nullptr || start + bytes > reinterpret_cast<uintptr_t>(limit)) {
+            cursor = static_cast<char*>(map(chunk_size));
+            limit = cursor + chunk_size;
+            chunks.push_back({ cursor, chunk_size });
+            start = reinterpret_cast<uintptr_t>(cursor);
+        }
+        cursor = reinterpret_cast<char*>(start + bytes);
+        return reinterpret_cast<void*>(start);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (is_large(bytes)) {
+            for (size_t i = 0; i < large_blocks.size(); ++i) {
+                if (large_blocks[i].address == p) {
+                    large_blocks[i] = large_blocks.back();
+                    large_blocks.pop_back();
+                    break;
+                }
+            }
+            unmap(p, round_up(bytes));
+            return;
+        }
+        if (bytes == 0) {
+            bytes = 1;
+        }
+        // Блоки с большим выравниванием не переиспользуются и ждут деструктора
+        if (alignment <= size_step) {
+            push(bytes <= max_small ? free_lists[size_class(bytes)] : mid_lists[mid_class(bytes)], p);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit Huge_Page_Resource(Huge_Page_Mode page_mode = HUGE_PAGES_AUTO) : mode(page_mode) {
+    }
+
+    ~Huge_Page_Resource() override {
+        for (const Mapping& block : large_blocks) {
+            unmap(block.address, block.bytes);
+        }
+        for (const Mapping& chunk : chunks) {
+            unmap(chunk.address, chunk.bytes);
+        }
+    }
+
+    Huge_Page_Resource(const Huge_Page_Resource&) = delete;
+    Huge_Page_Resource& operator=(const Huge_Page_Resource&) = delete;
+
+    Huge_Page_Mode page_mode() const {
+        return mode;
+    }
+
+    Huge_Page_Stats stats() const {
+        return counters;
+    }
+};
@@ -0,0 +1,613 @@
+﻿// LSM_Dictionary.h
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>      // std::remove
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "RB_Dictionary.h"       // память-таблица (memtable)
+#include "Binary_Stream.h"       // crc32_update()
+#include "Membership_Filter.h"   // Blocked_Bloom_Filter, membership_hash()
+#include "Container_Stats.h"     // LSM_Stats
+
+//------------------------------------------------------------------------------------------------
+//  Упорядоченный словарь, который не помещается в память (LSM-дерево).
+//
+//  Запись идёт в память-таблицу — обычное RB_Dictionary. Когда она достигает бюджета
+//  памяти, её пары по порядку выписываются в новый неизменяемый файл-прогон (run)
+//  на локальном диске, а таблица очищается (узлы остаются в пуле и переиспользуются).
+//  Удаление — запись «надгробия» (tombstone), которое закрывает старые версии ключа.
+//
+//  Файл прогона — последовательность блоков по block_records записей; запись кодируется
+//  как в Binary_Stream.h: [флаг][ключ][значение], строки — varint-длина и байты.
+//  В памяти от прогона остаются только разреженный индекс (первый ключ и смещение
+//  каждого блока, CRC-32 блока) и блочный фильтр Блума по всем ключам прогона.
+//
+//  Поиск: память-таблица, затем прогоны от новых к старым. Прогон, чей фильтр отвечает
+//  «нет», пропускается без чтения диска; иначе читается ровно один блок.
+//  Когда прогонов набирается compaction_trigger, фоновый поток сливает их в один
+//  (при слиянии с самым старым прогоном надгробия больше ничего не закрывают и
+//  отбрасываются); пока идёт слияние, запись и поиск продолжаются. Если запись обгоняет
+//  слияние и прогонов становится stall_factor * compaction_trigger, выписывание
+//  памяти-таблицы ждёт слияния (write stall), иначе число прогонов и цена поиска не ограничены.
+//  Ошибка чтения или CRC блока останавливает поиск (старые прогоны не спрашиваются,
+//  чтобы не вернуть устаревшую версию) и переводит словарь в состояние !ok().
+//
+//  Файлы прогонов — рабочая память одного объекта: они называются path_prefix_N.run
+//  и удаляются вместе с объектом. Методы словаря вызываются из одного потока.
+//------------------------------------------------------------------------------------------------
+
+struct LSM_Config {
+    size_t memtable_bytes = size_t(64) << 20;   // бюджет памяти-таблицы (по узлам дерева)
+    size_t block_records = 64;                  // записей в блоке = шаг разреженного индекса
+    size_t compaction_trigger = 4;              // столько прогонов запускают слияние
+    size_t stall_factor = 4;                    // столько раз по compaction_trigger — запись ждёт слияния
+    bool   background = true;                   // сливать в отдельном потоке
+};
+
+namespace lsm_detail {
+
+    inline void put_varint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline bool get_varint(const char*& p, const char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            unsigned char byte = static_cast<unsigned char>(*p++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    inline void put(std::string& out, const T& value) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            put_varint(out, value.size());
+            out.append(value);
+        }
+        else {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "LSM_Dictionary: тип должен быть строкой или тривиально копируемым");
+            out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+    template <typename T>
+    inline bool get(const char*& p, const char* end, T& value) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            uint64_t length;
+            if (!get_varint(p, end, length) || length > uint64_t(end - p)) {
+                return false;
+            }
+            value.assign(p, static_cast<size_t>(length));
+            p += length;
+        }
+        else {
+            if (sizeof(T) > size_t(end - p)) {
+                return false;
+            }
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+        }
+        return true;
+    }
+
+}
+
+template <typename Key, typename Value>
+class LSM_Dictionary {
+    // Значение в памяти-таблице и в прогонах; deleted — надгробие
+    struct Entry {
+        Value value{};
+        bool  deleted = false;
+    };
+
+    using Record = std::pair<Key, Entry>;
+
+    struct Run {
+        std::string           path;
+        std::ifstream         file;          // для поиска из потока владельца
+        std::vector<Key>      first_keys;    // первый ключ каждого блока
+        std::vector<uint64_t> offsets;       // начало каждого блока и конец файла
+        std::vector<uint32_t> crcs;          // CRC-32 каждого блока
+        Blocked_Bloom_Filter  filter;
+        size_t                records = 0;
+
+        ~Run() {
+            file.close();
+            std::remove(path.c_str());
+        }
+
+        uint64_t bytes() const {
+            return offsets.empty() ? 0 : offsets.back();
+        }
+
+        bool read_block(std::ifstream& in, size_t block, std::string& data) const {
+            data.resize(static_cast<size_t>(offsets[block + 1] - offsets[block]));
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(offsets[block]));
+            if (!in.read(&data[0], static_cast<std::streamsize>(data.size()))) {
+                return false;
+            }
+            return crc32_update(0, data.data(), data.size()) == crcs[block];
+        }
+    };
+
+    using Run_Ptr = std::shared_ptr<Run>;
+
+    // Запись прогона: пары подаются строго по возрастанию ключей
+    class Run_Writer {
+        Run_Ptr       run;
+        std::ofstream out;
+        std::string   block;
+        size_t        in_block = 0;
+        size_t        block_records;
+        uint64_t      written = 0;
+
+        void end_block() {
+            run->offsets.push_back(written);
+            run->crcs.push_back(crc32_update(0, block.data(), block.size()));
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            written += block.size();
+            block.clear();
+            in_block = 0;
+        }
+
+    public:
+        Run_Writer(const std::string& path, size_t expected, size_t records_per_block)
+            : run(std::make_shared<Run>()), block_records(records_per_block) {
+            run->path = path;
+            run->filter.reset(std::max<size_t>(expected, 1));
+            out.open(path, std::ios::binary | std::ios::trunc);
+        }
+
+        void add(const Key& key, const Entry& entry) {
+            if (in_block == 0) {
+                run->first_keys.push_back(key);
+            }
+            block.push_back(entry.deleted ? 1 : 0);
+            lsm_detail::put(block, key);
+            if (!entry.deleted) {
+                lsm_detail::put(block, entry.value);
+            }
+            run->filter.add(membership_hash(key));
+            ++run->records;
+            if (++in_block == block_records) {
+                end_block();
+            }
+        }
+
+        // Возвращает готовый прогон или nullptr при ошибке записи
+        Run_Ptr finish() {
+            if (in_block > 0) {
+                end_block();
+            }
+            run->offsets.push_back(written);
+            out.close();
+            if (!out) {
+                return nullptr;
+            }
+            run->file.open(run->path, std::ios::binary);
+            return run->file ? run : nullptr;
+        }
+    };
+
+    // Разбор блока; false — блок повреждён
+    static bool decode_block(const std::string& data, std::vector<Record>& records) {
+        records.clear();
+        const char* p = data.data();
+        const char* end = p + data.size();
+        while (p < end) {
+            Record record;
+            record.second.deleted = *p++ != 0;
+            if (!lsm_detail::get(p, end, record.first) ||
+                (!record.second.deleted && !lsm_detail::get(p, end, record.second.value))) {
+                return false;
+            }
+            records.push_back(std::move(record));
+        }
+        return true;
+    }
+
+    // Последовательное чтение прогона по блокам со своим файловым потоком,
+    // чтобы фоновое слияние не мешало поиску владельца
+    struct Run_Cursor {
+        Run_Ptr             run;
+        std::ifstream       in;
+        std::string         data;
+        std::vector<Record> records;
+        size_t              block = 0;
+        size_t              pos = 0;
+        bool                good = true;
+
+        explicit Run_Cursor(const Run_Ptr& r) : run(r), in(r->path, std::ios::binary) {
+            good = static_cast<bool>(in);
+            load();
+        }
+
+        void load() {
+            records.clear();
+            pos = 0;
+            while (good && records.empty() && block + 1 < run->offsets.size()) {
+                good = run->read_block(in, block, data) && decode_block(data, records);
+                ++block;
+            }
+        }
+
+        bool done() const {
+            return pos == records.size();
+        }
+
+        const Record& current() const {
+            return records[pos];
+        }
+
+        void next() {
+            if (++pos == records.size()) {
+                load();
+            }
+        }
+    };
+
+    // Слияние курсоров; cursors[0] — самый новый. Для каждого ключа вызывает
+    // emit(key, entry) с самой новой версией. Возвращает false при ошибке чтения.
+    template <typename Emit>
+    static bool merge_cursors(std::vector<std::unique_ptr<Run_Cursor>>& cursors, Emit emit) {
+        while (true) {
+            const Record* best = nullptr;
+            for (auto& cursor : cursors) {
+                if (!cursor->good) {
+                    return false;
+                }
+                if (!cursor->done() && (best == nullptr || cursor->current().first < best->first)) {
+                    best = &cursor->current();
+                }
+            }
+            if (best == nullptr) {
+                return true;
+            }
+            Record record = *best;
+            for (auto& cursor : cursors) {
+                if (!cursor->done() && !(record.first < cursor->current().first)) {
+                    cursor->next();
+                }
+            }
+            emit(record.first, record.second);
+        }
+    }
+
+    RB_Dictionary<Key, Entry> memtable;
+    LSM_Config                config;
+    size_t                    memtable_limit;
+    std::string               prefix;
+    size_t                    next_file = 0;
+
+    std::vector<Run_Ptr>      runs;               // от старых к новым; под runs_mutex
+    mutable std::mutex        runs_mutex;
+    std::thread               worker;
+    std::atomic<bool>         compacting{ false };
+    mutable bool              good = true;        // false после ошибки записи или чтения
+    std::atomic<bool>         worker_failed{ false };
+
+    size_t                    flushes = 0;
+    size_t                    write_stalls = 0;
+    std::atomic<size_t>       compactions{ 0 };
+    mutable size_t            blocks_read = 0;
+    mutable size_t            filter_skips = 0;
+    mutable std::string       block_buffer;
+
+    std::string next_path() {
+        return prefix + "_" + std::to_string(next_file++) + ".run";
+    }
+
+    enum Run_Lookup {
+        RUN_ABSENT,   // ключа в прогоне нет
+        RUN_FOUND,    // есть запись (значение или надгробие)
+        RUN_ERROR     // блок не прочитан, не сошлась CRC или запись не разбирается
+    };
+
+    // Поиск в одном прогоне
+    Run_Lookup run_lookup(const Run& run, const Key& key, Entry& entry) const {
+        if (!run.filter.may_contain(membership_hash(key))) {
+            ++filter_skips;
+            return RUN_ABSENT;
+        }
+        auto it = std::upper_bound(run.first_keys.begin(), run.first_keys.end(), key);
+        if (it == run.first_keys.begin()) {
+            return RUN_ABSENT;
+        }
+        size_t block = static_cast<size_t>(it - run.first_keys.begin()) - 1;
+        ++blocks_read;
+        if (!run.read_block(const_cast<std::ifstream&>(run.file), block, block_buffer)) {
+            return RUN_ERROR;
+        }
+        const char* p = block_buffer.data();
+        const char* end = p + block_buffer.size();
+        Key current;
+        while (p < end) {
+            bool deleted = *p++ != 0;
+            if (!lsm_detail::get(p, end, current)) {
+                return RUN_ERROR;
+            }
+            bool match = !(current < key) && !(key < current);
+            if (!deleted) {
+                Value value;
+                if (!lsm_detail::get(p, end, value)) {
+                    return RUN_ERROR;
+                }
+                if (match) {
+                    entry.value = std::move(value);
+                }
+            }
+            if (match) {
+                entry.deleted = deleted;
+                return RUN_FOUND;
+            }
+            if (key < current) {
+                return RUN_ABSENT;
+            }
+        }
+        return RUN_ABSENT;
+    }
+
+    // Слияние старейших прогонов (снимок ещё не изменённого начала списка) в один
+    void compact(std::vector<Run_Ptr> sources, std::string path) {
+        std::vector<std::unique_ptr<Run_Cursor>> cursors;
+        size_t expected = 0;
+        for (auto it = sources.rbegin(); it != sources.rend(); ++it) {
+            cursors.push_back(std::make_unique<Run_Cursor>(*it));
+            expected += (*it)->records;
+        }
+        Run_Writer writer(path, expected, config.block_records);
+        // В слиянии участвует самый старый прогон: надгробиям больше нечего закрывать
+        bool merged = merge_cursors(cursors, [&](const Key& key, const Entry& entry) {
+            if (!entry.deleted) {
+                writer.add(key, entry);
+            }
+        });
+        Run_Ptr result = writer.finish();
+        cursors.clear();
+        if (!merged || result == nullptr) {
+            worker_failed = true;
+            compacting = false;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(runs_mutex);
+            runs.erase(runs.begin(), runs.begin() + sources.size());
+            if (result->records > 0) {
+                runs.insert(runs.begin(), result);
+            }
+        }
+        // Файлы слитых прогонов удаляются, когда на них не остаётся ссылок
+        sources.clear();
+        ++compactions;
+        compacting = false;
+    }
+
+    void maybe_compact() {
+        if (compacting) {
+            return;
+        }
+        if (worker.joinable()) {
+            worker.join();
+        }
+        std::vector<Run_Ptr> sources;
+        {
+            std::lock_guard<std::mutex> lock(runs_mutex);
+            if (runs.size() < config.compaction_trigger) {
+                return;
+            }
+            sources = runs;
+        }
+        compacting = true;
+        if (config.background) {
+            worker = std::thread(&LSM_Dictionary::compact, this, std::move(sources), next_path());
+        }
+        else {
+            compact(std::move(sources), next_path());
+        }
+    }
+
+    void check_memtable() {
+        if (memtable.size() >= memtable_limit) {
+            flush();
+        }
+    }
+
+public:
+    // path_prefix — начало имён файлов прогонов (каталог должен существовать)
+    LSM_Dictionary(const std::string& path_prefix, const LSM_Config& cfg = LSM_Config())
+        : config(cfg), prefix(path_prefix) {
+        if (config.block_records == 0) {
+            config.block_records = 1;
+        }
+        if (config.compaction_trigger < 2) {
+            config.compaction_trigger = 2;
+        }
+        if (config.stall_factor < 1) {
+            config.stall_factor = 1;
+        }
+        memtable_limit = std::max<size_t>(config.memtable_bytes /
+            RB_Dictionary<Key, Entry>::node_bytes(), 1);
+    }
+
+    ~LSM_Dictionary() {
+        wait_compaction();
+    }
+
+    LSM_Dictionary(const LSM_Dictionary&) = delete;
+    LSM_Dictionary& operator=(const LSM_Dictionary&) = delete;
+
+    // Вставка или обновление
+    void insert(const Key& key, const Value& value) {
+        memtable.insert(key, Entry{ value, false });
+        check_memtable();
+    }
+
+    // Удаление: надгробие в памяти-таблице (наличие ключа на диске не проверяется)
+    void erase(const Key& key) {
+        memtable.insert(key, Entry{ Value(), true });
+        check_memtable();
+    }
+
+    bool find(const Key& key, Value& value) const {
+        if (const Entry* entry = memtable.find(key)) {
+            if (entry->deleted) {
+                return false;
+            }
+            value = entry->value;
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(runs_mutex);
+        Entry entry;
+        for (auto it = runs.rbegin(); it != runs.rend(); ++it) {
+            Run_Lookup result = run_lookup(**it, key, entry);
+            if (result == RUN_ERROR) {
+                good = false;
+                return false;
+            }
+            if (result == RUN_FOUND) {
+                if (entry.deleted) {
+                    return false;
+                }
+                value = std::move(entry.value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const Key& key) const {
+        Value value;
+        return find(key, value);
+    }
+
+    // Выписывает память-таблицу в новый прогон. Возвращает false при ошибке записи
+    // (память-таблица тогда сохраняется). Если прогонов слишком много, ждёт слияния.
+    bool flush() {
+        if (memtable.size() == 0) {
+            return true;
+        }
+        Run_Writer writer(next_path(), memtable.size(), config.block_records);
+        memtable.for_each([&](const Key& key, const Entry& entry) {
+            writer.add(key, entry);
+        });
+        Run_Ptr run = writer.finish();
+        if (run == nullptr) {
+            good = false;
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(runs_mutex);
+            runs.push_back(std::move(run));
+        }
+        memtable.clear();
+        ++flushes;
+        maybe_compact();
+        if (run_count() >= config.stall_factor * config.compaction_trigger) {
+            // Слияние отстало: дожидаемся его и сразу сливаем накопившиеся прогоны
+            ++write_stalls;
+            wait_compaction();
+            maybe_compact();
+        }
+        return true;
+    }
+
+    // Дожидается окончания фонового слияния
+    void wait_compaction() {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // false, если запись или слияние прогона завершились ошибкой
+    bool ok() const {
+        return good && !worker_failed;
+    }
+
+    size_t run_count() const {
+        std::lock_guard<std::mutex> lock(runs_mutex);
+        return runs.size();
+    }
+
+    size_t memtable_size() const {
+        return memtable.size();
+    }
+
+    // Обход живых пар по возрастанию ключей (читает все прогоны с диска)
+    template <typename Func>
+    bool for_each(Func func) const {
+        std::vector<std::unique_ptr<Run_Cursor>> cursors;
+        {
+            std::lock_guard<std::mutex> lock(runs_mutex);
+            for (auto it = runs.rbegin(); it != runs.rend(); ++it) {
+                cursors.push_back(std::make_unique<Run_Cursor>(*it));
+            }
+        }
+        // Память-таблица новее всех прогонов: сливаем её с результатом слияния прогонов
+        std::vector<Record> fresh;
+        fresh.reserve(memtable.size());
+        memtable.for_each([&](const Key& key, const Entry& entry) {
+            fresh.emplace_back(key, entry);
+        });
+        size_t i = 0;
+        bool merged = merge_cursors(cursors, [&](const Key& key, const Entry& entry) {
+            for (; i < fresh.size() && fresh[i].first < key; ++i) {
+                if (!fresh[i].second.deleted) {
+                    func(fresh[i].first, fresh[i].second.value);
+                }
+            }
+            if (i < fresh.size() && !(key < fresh[i].first)) {
+                return;   // ключ перекрыт памятью-таблицей
+            }
+            if (!entry.deleted) {
+                func(key, entry.value);
+            }
+        });
+        for (; i < fresh.size(); ++i) {
+            if (!fresh[i].second.deleted) {
+                func(fresh[i].first, fresh[i].second.value);
+            }
+        }
+        return merged;
+    }
+
+    LSM_Stats stats() const {
+        LSM_Stats result;
+        result.memtable_count = memtable.size();
+        result.memtable_limit = memtable_limit;
+        result.flushes = flushes;
+        result.write_stalls = write_stalls;
+        result.compactions = compactions;
+        result.blocks_read = blocks_read;
+        result.filter_skips = filter_skips;
+        std::lock_guard<std::mutex> lock(runs_mutex);
+        result.run_count = runs.size();
+        for (const Run_Ptr& run : runs) {
+            result.run_records += run->records;
+            result.disk_bytes += run->bytes();
+            result.index_bytes += run->first_keys.size() * (sizeof(Key) + sizeof(uint64_t) + sizeof(uint32_t));
+        }
+        return result;
+    }
+};
@@ -0,0 +1,587 @@
+﻿// Mapped_Dictionary.h
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Hash_Dictionary.h"
+#include "RB_Dictionary.h"
+#include "Eytzinger_Dictionary.h"
+
+//------------------------------------------------------------------------------------------------
+//  Двоичный формат словаря, который отображается в память (mmap) и читается на месте.
+//
+//  [ заголовок | секция 1 | секция 2 | ... ]
+//  Каждая секция начинается с границы страницы (4 КиБ), вместо указателей хранятся
+//  смещения и индексы. При открытии файла ничего не строится: платим только за те
+//  страницы, к которым обращаются запросы.
+//
+//  Хэш-раскладка:         buckets (bucket_count + 1 индексов), keys, values, blob
+//  Упорядоченная раскладка: keys и values в порядке Эйтцингера (индекс 0 не используется),
+//                         ranks (позиция в отсортированном порядке), blob
+//  blob — байты строковых ключей; для ключей фиксированного размера пуст.
+//------------------------------------------------------------------------------------------------
+
+static constexpr uint64_t mapped_page_size = 4096;
+static constexpr uint32_t mapped_version = 1;
+
+enum Mapped_Layout : uint32_t { MAPPED_HASH = 1, MAPPED_ORDERED = 2 };
+enum Mapped_Key_Kind : uint32_t { MAPPED_KEY_FIXED = 0, MAPPED_KEY_STRING = 1 };
+
+struct Mapped_Header {
+    char     magic[8];       // "DICTMAP"
+    uint32_t version;
+    uint32_t layout;         // Mapped_Layout
+    uint32_t key_kind;       // Mapped_Key_Kind
+    uint32_t key_size;       // размер хранимого ключа
+    uint32_t value_size;
+    uint32_t reserved;
+    uint64_t count;          // число элементов
+    uint64_t bucket_count;   // только для хэш-раскладки (степень двойки)
+    uint64_t buckets_offset; // смещения секций от начала файла
+    uint64_t keys_offset;
+    uint64_t values_offset;
+    uint64_t ranks_offset;
+    uint64_t blob_offset;
+    uint64_t blob_size;
+    uint64_t file_size;
+};
+
+// Перемешивание 64-битного значения (финализатор fmix64 из MurmurHash3)
+inline uint64_t mapped_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// FNV-1a: хэш не зависит от реализации std::hash, поэтому файл переносим между сборками
+inline uint64_t mapped_hash_bytes(const char* data, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Секция blob отображённого файла
+struct Mapped_Blob {
+    const char* data = nullptr;
+    uint64_t    size = 0;
+};
+
+// Как ключ хранится в файле: ключи фиксированного размера — как есть
+template <typename Key>
+struct Mapped_Key {
+    static_assert(std::is_trivially_copyable<Key>::value,
+        "Mapped_Dictionary: ключ должен быть строкой или тривиально копируемым типом");
+
+    using Stored = Key;
+    static constexpr Mapped_Key_Kind kind = MAPPED_KEY_FIXED;
+
+    static Stored store(const Key& key, std::vector<char>&) {
+        return key;
+    }
+    static bool less(const Stored& stored, const Key& key, const Mapped_Blob&) {
+        return stored < key;
+    }
+    static bool equal(const Stored& stored, const Key& key, const Mapped_Blob&) {
+        return stored == key;
+    }
+    static uint64_t hash(const Key& key) {
+        if constexpr (std::is_integral<Key>::value) {
+            return mapped_mix(static_cast<uint64_t>(key));
+        }
+        else {
+            return mapped_hash_bytes(reinterpret_cast<const char*>(&key), sizeof(Key));
+        }
+    }
+};
+
+// Строковые ключи: смещение и длина внутри секции blob
+template <>
+struct Mapped_Key<std::string> {
+    struct Stored {
+        uint64_t offset;
+        uint64_t length;
+    };
+    static constexpr Mapped_Key_Kind kind = MAPPED_KEY_STRING;
+
+    static Stored store(const std::string& key, std::vector<char>& blob) {
+        Stored stored{ blob.size(), key.size() };
+        blob.insert(blob.end(), key.begin(), key.end());
+        return stored;
+    }
+    // Строка лежит внутри blob (смещение и длина из файла не проверены при открытии)
+    static bool valid(const Stored& stored, const Mapped_Blob& blob) {
+        return stored.offset <= blob.size && stored.length <= blob.size - stored.offset;
+    }
+    // Повреждённая ссылка читается как пустая строка
+    static std::string_view view(const Stored& stored, const Mapped_Blob& blob) {
+        if (!valid(stored, blob)) {
+            return std::string_view();
+        }
+        return std::string_view(blob.data + stored.offset, static_cast<size_t>(stored.length));
+    }
+    static bool less(const Stored& stored, const std::string& key, const Mapped_Blob& blob) {
+        return view(stored, blob) < key;
+    }
+    static bool equal(const Stored& stored, const std::string& key, const Mapped_Blob& blob) {
+        return valid(stored, blob) && view(stored, blob) == key;
+    }
+    static uint64_t hash(const std::string& key) {
+        return mapped_hash_bytes(key.data(), key.size());
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Файл, отображённый в память только для чтения
+//------------------------------------------------------------------------------------------------
+class Mapped_File {
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+
+public:
+    Mapped_File() = default;
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+
+    ~Mapped_File() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        // Отображение остаётся действительным и после закрытия дескрипторов
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            return false;
+        }
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+#if defined(_WIN32)
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // Вытесняет файл из страничного кэша ОС (для измерения «холодного» старта).
+    // Возвращает false, если платформа этого не умеет.
+    static bool drop_page_cache(const std::string& path) {
+#if defined(__linux__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        fdatasync(fd);
+        bool dropped = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        ::close(fd);
+        return dropped;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Запись
+//------------------------------------------------------------------------------------------------
+
+// Дописывает секцию с границы страницы и возвращает её смещение
+inline uint64_t mapped_append_section(std::vector<char>& file, const void* data, size_t bytes) {
+    size_t offset = static_cast<size_t>(
+        (file.size() + mapped_page_size - 1) / mapped_page_size * mapped_page_size);
+    file.resize(offset + bytes);
+    if (bytes != 0) {
+        std::memcpy(file.data() + offset, data, bytes);
+    }
+    return offset;
+}
+
+// Заполняет заголовок, дописывает выравнивание до конца страницы и сохраняет файл
+inline bool mapped_write_file(std::vector<char>& file, Mapped_Header& header, const std::string& path) {
+    std::memcpy(header.magic, "DICTMAP", 8);
+    header.version = mapped_version;
+    file.resize(static_cast<size_t>(
+        (file.size() + mapped_page_size - 1) / mapped_page_size * mapped_page_size));
+    header.file_size = file.size();
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(file.data(), static_cast<std::streamsize>(file.size()));
+    return static_cast<bool>(out);
+}
+
+// Сохраняет пары, перечисляемые for_each, в хэш-раскладке
+template <typename Key, typename Value, typename Container>
+bool save_mapped_hash(const Container& source, size_t count, const std::string& path) {
+    static_assert(std::is_trivially_copyable<Value>::value,
+        "Mapped_Dictionary: значение должно быть тривиально копируемым");
+    using Traits = Mapped_Key<Key>;
+    using Stored = typename Traits::Stored;
+
+    // Число корзин — степень двойки не меньше числа элементов
+    uint64_t bucket_count = 1;
+    while (bucket_count < count) {
+        bucket_count *= 2;
+    }
+
+    // Сортировка подсчётом: сначала размеры корзин, затем раскладка по ним
+    std::vector<uint64_t> buckets(bucket_count + 1, 0);
+    source.for_each([&](const Key& key, const Value&) {
+        ++buckets[(Traits::hash(key) & (bucket_count - 1)) + 1];
+    });
+    for (uint64_t b = 0; b < bucket_count; ++b) {
+        buckets[b + 1] += buckets[b];
+    }
+
+    std::vector<const Key*> ordered_keys(count);
+    std::vector<Value> values(count);
+    std::vector<uint64_t> next(buckets.begin(), buckets.end() - 1);
+    source.for_each([&](const Key& key, const Value& value) {
+        uint64_t slot = next[Traits::hash(key) & (bucket_count - 1)]++;
+        ordered_keys[slot] = &key;
+        values[slot] = value;
+    });
+
+    // Строки кладём в blob в порядке корзин, чтобы ключи одной корзины лежали рядом
+    std::vector<char> blob;
+    std::vector<Stored> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = Traits::store(*ordered_keys[i], blob);
+    }
+
+    Mapped_Header header = {};
+    header.layout = MAPPED_HASH;
+    header.key_kind = Traits::kind;
+    header.key_size = sizeof(Stored);
+    header.value_size = sizeof(Value);
+    header.count = count;
+    header.bucket_count = bucket_count;
+
+    std::vector<char> file(sizeof(Mapped_Header));
+    header.buckets_offset = mapped_append_section(file, buckets.data(), buckets.size() * sizeof(uint64_t));
+    header.keys_offset = mapped_append_section(file, keys.data(), keys.size() * sizeof(Stored));
+    header.values_offset = mapped_append_section(file, values.data(), values.size() * sizeof(Value));
+    header.blob_offset = mapped_append_section(file, blob.data(), blob.size());
+    header.blob_size = blob.size();
+    return mapped_write_file(file, header, path);
+}
+
+// Сохраняет пары, перечисляемые for_each в порядке возрастания ключей, в раскладке Эйтцингера
+template <typename Key, typename Value, typename Container>
+bool save_mapped_ordered(const Container& source, size_t count, const std::string& path) {
+    static_assert(std::is_trivially_copyable<Value>::value,
+        "Mapped_Dictionary: значение должно быть тривиально копируемым");
+    using Traits = Mapped_Key<Key>;
+    using Stored = typename Traits::Stored;
+
+    std::vector<const Key*> sorted_keys;
+    std::vector<Value> sorted_values;
+    sorted_keys.reserve(count);
+    sorted_values.reserve(count);
+    source.for_each([&](const Key& key, const Value& value) {
+        sorted_keys.push_back(&key);
+        sorted_values.push_back(value);
+    });
+
+    std::vector<uint64_t> ranks(count + 1, 0);
+    size_t k = eytzinger_first(count);
+    for (size_t i = 0; i < count; ++i) {
+        ranks[k] = i;
+        k = eytzinger_next(k, count);
+    }
+
+    // Обходим в порядке Эйтцингера: верхние уровни дерева и их строки попадают в первые страницы
+    std::vector<char> blob;
+    std::vector<Stored> keys(count + 1, Stored{});
+    std::vector<Value> values(count + 1, Value{});
+    for (size_t e = 1; e <= count; ++e) {
+        keys[e] = Traits::store(*sorted_keys[ranks[e]], blob);
+        values[e] = sorted_values[ranks[e]];
+    }
+
+    Mapped_Header header = {};
+    header.layout = MAPPED_ORDERED;
+    header.key_kind = Traits::kind;
+    header.key_size = sizeof(Stored);
+    header.value_size = sizeof(Value);
+    header.count = count;
+
+    std::vector<char> file(sizeof(Mapped_Header));
+    header.keys_offset = mapped_append_section(file, keys.data(), keys.size() * sizeof(Stored));
+    header.values_offset = mapped_append_section(file, values.data(), values.size() * sizeof(Value));
+    header.ranks_offset = mapped_append_section(file, ranks.data(), ranks.size() * sizeof(uint64_t));
+    header.blob_offset = mapped_append_section(file, blob.data(), blob.size());
+    header.blob_size = blob.size();
+    return mapped_write_file(file, header, path);
+}
+
+template <typename Key, typename Value, typename Filter, bool Collect_Stats>
+bool save_mapped(const Dictionary<Key, Value, Filter, Collect_Stats>& dict, const std::string& path) {
+    size_t count = 0;
+    dict.for_each([&](const Key&, const Value&) { ++count; });
+    return save_mapped_hash<Key, Value>(dict, count, path);
+}
+
+template <typename Key, typename Value, typename Filter, bool Collect_Stats>
+bool save_mapped(const RB_Dictionary<Key, Value, Filter, Collect_Stats>& tree, const std::string& path) {
+    return save_mapped_ordered<Key, Value>(tree, tree.size(), path);
+}
+
+template <typename Key, typename Value>
+bool save_mapped(const Eytzinger_Dictionary<Key, Value>& snapshot, const std::string& path) {
+    return save_mapped_ordered<Key, Value>(snapshot, snapshot.size(), path);
+}
+
+//------------------------------------------------------------------------------------------------
+//  Чтение
+//------------------------------------------------------------------------------------------------
+
+// Секция из count элементов по size байт начинается с границы страницы и целиком
+// лежит в файле; сравнения построены так, чтобы не переполняться при любых полях заголовка
+inline bool mapped_section_fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size) {
+    return offset % mapped_page_size == 0 &&
+        offset <= file_size &&
+        (size == 0 || count <= (file_size - offset) / size);
+}
+
+// Проверяет заголовок и границы секций keys, values и blob; nullptr, если файл не подходит.
+// Секции buckets и ranks проверяют сами словари.
+template <typename Key, typename Value>
+const Mapped_Header* mapped_validate(const Mapped_File& file, Mapped_Layout layout) {
+    if (file.size() < sizeof(Mapped_Header)) {
+        return nullptr;
+    }
+    const Mapped_Header* header = reinterpret_cast<const Mapped_Header*>(file.data());
+    if (std::memcmp(header->magic, "DICTMAP", 8) != 0 ||
+        header->version != mapped_version ||
+        header->layout != layout ||
+        header->key_kind != Mapped_Key<Key>::kind ||
+        header->key_size != sizeof(typename Mapped_Key<Key>::Stored) ||
+        header->value_size != sizeof(Value) ||
+        header->file_size > file.size() ||
+        header->count == UINT64_MAX) {
+        return nullptr;
+    }
+    // В упорядоченной раскладке индекс 0 не используется
+    uint64_t slots = layout == MAPPED_ORDERED ? header->count + 1 : header->count;
+    if (!mapped_section_fits(header->keys_offset, slots, sizeof(typename Mapped_Key<Key>::Stored), file.size()) ||
+        !mapped_section_fits(header->values_offset, slots, sizeof(Value), file.size()) ||
+        !mapped_section_fits(header->blob_offset, header->blob_size, 1, file.size())) {
+        return nullptr;
+    }
+    return header;
+}
+
+// Хэш-таблица, читаемая прямо из отображённого файла
+template <typename Key, typename Value>
+class Mapped_Hash_Dictionary {
+    using Traits = Mapped_Key<Key>;
+    using Stored = typename Traits::Stored;
+
+    Mapped_File     file;
+    const uint64_t* buckets = nullptr;
+    const Stored*   keys = nullptr;
+    const Value*    values = nullptr;
+    Mapped_Blob     blob;
+    uint64_t        bucket_mask = 0;
+    size_t          count = 0;
+
+public:
+    explicit Mapped_Hash_Dictionary(const std::string& path) {
+        if (!file.open(path)) {
+            return;
+        }
+        const Mapped_Header* header = mapped_validate<Key, Value>(file, MAPPED_HASH);
+        if (header == nullptr || header->bucket_count == 0 ||
+            (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+            !mapped_section_fits(header->buckets_offset, header->bucket_count + 1, sizeof(uint64_t), file.size())) {
+            file.close();
+            return;
+        }
+        buckets = reinterpret_cast<const uint64_t*>(file.data() + header->buckets_offset);
+        keys = reinterpret_cast<const Stored*>(file.data() + header->keys_offset);
+        values = reinterpret_cast<const Value*>(file.data() + header->values_offset);
+        blob = { file.data() + header->blob_offset, header->blob_size };
+        bucket_mask = header->bucket_count - 1;
+        count = static_cast<size_t>(header->count);
+    }
+
+    bool is_open() const {
+        return file.data() != nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        if (!is_open()) {
+            return nullptr;
+        }
+        // Границы корзины читаются из файла, поэтому ограничиваются числом элементов
+        uint64_t bucket = Traits::hash(key) & bucket_mask;
+        uint64_t end = buckets[bucket + 1] < count ? buckets[bucket + 1] : count;
+        for (uint64_t i = buckets[bucket]; i < end; ++i) {
+            if (Traits::equal(keys[i], key, blob)) {
+                return &values[i];
+            }
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+// Упорядоченный словарь (раскладка Эйтцингера), читаемый прямо из отображённого файла
+template <typename Key, typename Value>
+class Mapped_Ordered_Dictionary {
+    using Traits = Mapped_Key<Key>;
+    using Stored = typename Traits::Stored;
+
+    Mapped_File     file;
+    const Stored*   keys = nullptr;
+    const Value*    values = nullptr;
+    const uint64_t* ranks = nullptr;
+    Mapped_Blob     blob;
+    size_t          count = 0;
+
+    // Индекс первого ключа, не меньшего key, либо 0
+    inline size_t search(const Key& key) const {
+        size_t k = 1;
+        while (k <= count) {
+            k = 2 * k + Traits::less(keys[k], key, blob);
+        }
+        return eytzinger_lower_bound(k);
+    }
+
+public:
+    explicit Mapped_Ordered_Dictionary(const std::string& path) {
+        if (!file.open(path)) {
+            return;
+        }
+        const Mapped_Header* header = mapped_validate<Key, Value>(file, MAPPED_ORDERED);
+        if (header == nullptr ||
+            !mapped_section_fits(header->ranks_offset, header->count + 1, sizeof(uint64_t), file.size())) {
+            file.close();
+            return;
+        }
+        keys = reinterpret_cast<const Stored*>(file.data() + header->keys_offset);
+        values = reinterpret_cast<const Value*>(file.data() + header->values_offset);
+        ranks = reinterpret_cast<const uint64_t*>(file.data() + header->ranks_offset);
+        blob = { file.data() + header->blob_offset, header->blob_size };
+        count = static_cast<size_t>(header->count);
+    }
+
+    bool is_open() const {
+        return file.data() != nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        if (!is_open()) {
+            return nullptr;
+        }
+        size_t k = search(key);
+        if (k != 0 && Traits::equal(keys[k], key, blob)) {
+            return &values[k];
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Количество ключей, строго меньших key
+    size_t rank(const Key& key) const {
+        if (!is_open()) {
+            return 0;
+        }
+        // Ранг читается из файла, поэтому ограничивается числом элементов
+        size_t k = search(key);
+        return k != 0 && ranks[k] < count ? static_cast<size_t>(ranks[k]) : count;
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
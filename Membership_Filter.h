@@ -0,0 +1,267 @@
+﻿// Membership_Filter.h
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------
+//  Приближённые фильтры принадлежности для отсечения промахов в find()/contains().
+//
+//  Фильтр подключается к словарю параметром шаблона и обновляется при вставке и удалении.
+//  Ответ «нет» всегда точен, ответ «возможно» требует обычного поиска.
+//
+//  Интерфейс фильтра:
+//      enabled              — false только у No_Filter, чтобы проверки исчезали при компиляции
+//      reset(expected)      — очистить и подготовить место под expected ключей
+//      needs_rebuild(count) — пора ли пересобрать фильтр под count ключей
+//      add(hash)            — добавить ключ; false, если места не хватило — тогда фильтр
+//                             до пересборки отвечает «возможно» на всё, а пересобирать его
+//                             нужно с большим запасом (см. rebuild_membership_filter)
+//      remove(hash)         — удалить ключ (Bloom удалять не умеет и ничего не делает)
+//      may_contain(hash)    — возможно ли, что ключ присутствует
+//------------------------------------------------------------------------------------------------
+
+// 64-битный хэш ключа для фильтров (не зависит от хэш-функции самой таблицы)
+template <typename Key>
+inline uint64_t membership_hash(const Key& key) {
+    uint64_t x;
+    if constexpr (std::is_integral<Key>::value) {
+        x = static_cast<uint64_t>(key);
+    }
+    else if constexpr (std::is_same<Key, std::string>::value) {
+        // FNV-1a
+        x = 0xcbf29ce484222325ULL;
+        for (char ch : key) {
+            x ^= static_cast<unsigned char>(ch);
+            x *= 0x100000001b3ULL;
+        }
+    }
+    else {
+        x = static_cast<uint64_t>(std::hash<Key>{}(key));
+    }
+    // Финализатор splitmix64: равномерно перемешивает все биты
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Пересобирает filter по хэшам, которые for_each_hash передаёт своему аргументу.
+// Если add() не справляется, место под ключи удваивается; после max_attempts неудач
+// фильтр остаётся в состоянии «возможно» на всё — медленно, но без ложных «нет».
+template <typename Filter, typename For_Each_Hash>
+void rebuild_membership_filter(Filter& filter, size_t expected, For_Each_Hash for_each_hash) {
+    static constexpr int max_attempts = 8;
+    for (int attempt = 0; attempt < max_attempts; ++attempt, expected *= 2) {
+        filter.reset(expected);
+        bool complete = true;
+        for_each_hash([&](uint64_t hash) {
+            complete = complete && filter.add(hash);
+        });
+        if (complete) {
+            return;
+        }
+    }
+}
+
+// Фильтр по умолчанию: ничего не хранит, на всё отвечает «возможно»
+struct No_Filter {
+    static constexpr bool enabled = false;
+
+    void reset(size_t) {}
+    bool needs_rebuild(size_t) const { return false; }
+    bool add(uint64_t) { return true; }
+    void remove(uint64_t) {}
+    bool may_contain(uint64_t) const { return true; }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Блочный фильтр Блума: все 8 бит одного ключа лежат в одном 32-байтном блоке
+//  (по одному биту в каждом 32-битном слове), так что проверка — один промах кэша.
+//  12 бит на ключ дают около 0.5% ложных срабатываний. Удаление не поддерживается:
+//  после удалений биты остаются до следующей пересборки.
+//------------------------------------------------------------------------------------------------
+class Blocked_Bloom_Filter {
+    static constexpr size_t bits_per_key = 12;
+
+    struct Block {
+        uint32_t words[8];
+    };
+
+    std::vector<Block> blocks;
+    uint64_t           block_mask = 0;
+    size_t             capacity = 0;
+
+    // Номер бита в каждом из 8 слов: старшие 5 бит произведения младшей половины хэша на «соль»
+    static inline uint32_t bit_in_word(uint32_t h, int i) {
+        static const uint32_t salt[8] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        return 1u << ((h * salt[i]) >> 27);
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    void reset(size_t expected) {
+        size_t needed = (expected * bits_per_key + 255) / 256;
+        size_t count = 1;
+        while (count < needed) {
+            count *= 2;
+        }
+        blocks.assign(count, Block{});
+        block_mask = count - 1;
+        capacity = count * 256 / bits_per_key;
+    }
+
+    bool needs_rebuild(size_t count) const {
+        return count > capacity;
+    }
+
+    bool add(uint64_t hash) {
+        Block& block = blocks[(hash >> 32) & block_mask];
+        uint32_t h = static_cast<uint32_t>(hash);
+        for (int i = 0; i < 8; ++i) {
+            block.words[i] |= bit_in_word(h, i);
+        }
+        return true;
+    }
+
+    void remove(uint64_t) {}
+
+    bool may_contain(uint64_t hash) const {
+        const Block& block = blocks[(hash >> 32) & block_mask];
+        uint32_t h = static_cast<uint32_t>(hash);
+        uint32_t missing = 0;
+        for (int i = 0; i < 8; ++i) {
+            missing |= bit_in_word(h, i) & ~block.words[i];
+        }
+        return missing == 0;
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Таблица отпечатков с удалением (Robin Hood по 16-битным отпечаткам ключей).
+//  Хэш делится на частное q (старшие биты — номер «домашней» ячейки) и 16-битный остаток r.
+//  В ячейке хранится только r и смещение от домашней ячейки, по которому q восстанавливается.
+//  Записи одного кластера упорядочены по q (хэширование Robin Hood), поэтому поиск
+//  останавливается, как только встречает запись, ушедшую от дома меньше, чем искомая.
+//  Удаление — обратный сдвиг хвоста кластера. Ложные срабатывания — около 2^-16 на пробу.
+//  Это не настоящий фильтр частного: ячейка занимает 4 байта (остаток, смещение, флаг)
+//  при заполнении от 37.5% до 75%, то есть 5.3-10.7 байта на ключ — в 5-10 раз больше,
+//  чем у Blocked_Bloom_Filter (1.5 байта). Брать его стоит, только если нужно удаление.
+//  Если кластер длиннее max_distance, add() вытесненную запись уже не сохранит: фильтр
+//  помечается переполненным и до reset() отвечает «возможно» на всё.
+//------------------------------------------------------------------------------------------------
+class Fingerprint_Filter {
+    static constexpr uint8_t max_distance = 255;
+
+    struct Slot {
+        uint16_t remainder;
+        uint8_t  distance;   // смещение от домашней ячейки
+        uint8_t  used;
+    };
+
+    std::vector<Slot> slots;
+    uint64_t          slot_mask = 0;
+    unsigned          quotient_bits = 0;
+    size_t            capacity = 0;
+    bool              overflowed = false;   // запись потеряна, ответ «нет» ненадёжен
+
+    inline uint64_t home(uint64_t hash) const {
+        return hash >> (64 - quotient_bits);
+    }
+
+    static inline uint16_t remainder_of(uint64_t hash) {
+        return static_cast<uint16_t>(hash);
+    }
+
+    // Позиция записи (q, r) или -1
+    int64_t locate(uint64_t hash) const {
+        uint64_t q = home(hash);
+        uint16_t r = remainder_of(hash);
+        uint64_t i = q;
+        for (unsigned distance = 0; distance <= max_distance; ++distance, i = (i + 1) & slot_mask) {
+            const Slot& slot = slots[i];
+            if (!slot.used || slot.distance < distance) {
+                return -1;
+            }
+            if (slot.distance == distance && slot.remainder == r) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return -1;
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    void reset(size_t expected) {
+        // Заполнение не выше 75%, не меньше 16 ячеек
+        quotient_bits = 4;
+        while ((uint64_t(1) << quotient_bits) * 3 / 4 < expected && quotient_bits < 48) {
+            ++quotient_bits;
+        }
+        slots.assign(size_t(1) << quotient_bits, Slot{ 0, 0, 0 });
+        slot_mask = slots.size() - 1;
+        capacity = slots.size() * 3 / 4;
+        overflowed = false;
+    }
+
+    bool needs_rebuild(size_t count) const {
+        return count > capacity;
+    }
+
+    bool add(uint64_t hash) {
+        if (overflowed) {
+            return false;
+        }
+        Slot carry{ remainder_of(hash), 0, 1 };
+        uint64_t i = home(hash);
+        while (slots[i].used) {
+            // Робин Гуд: запись, ушедшая от дома меньше, уступает место
+            if (slots[i].distance < carry.distance) {
+                std::swap(slots[i], carry);
+            }
+            if (carry.distance == max_distance) {
+                overflowed = true;
+                return false;
+            }
+            ++carry.distance;
+            i = (i + 1) & slot_mask;
+        }
+        slots[i] = carry;
+        return true;
+    }
+
+    void remove(uint64_t hash) {
+        if (overflowed) {
+            return;
+        }
+        int64_t found = locate(hash);
+        if (found < 0) {
+            return;
+        }
+        // Сдвигаем хвост кластера на одну ячейку назад
+        uint64_t i = static_cast<uint64_t>(found);
+        uint64_t next = (i + 1) & slot_mask;
+        while (slots[next].used && slots[next].distance > 0) {
+            slots[i] = slots[next];
+            --slots[i].distance;
+            i = next;
+            next = (next + 1) & slot_mask;
+        }
+        slots[i] = Slot{ 0, 0, 0 };
+    }
+
+    bool may_contain(uint64_t hash) const {
+        return overflowed || locate(hash) >= 0;
+    }
+};
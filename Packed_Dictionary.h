@@ -0,0 +1,370 @@
+﻿// Packed_Dictionary.h
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PACKED_DICTIONARY_SSE2 1
+#endif
+
+#include "RB_Dictionary.h"
+
+//------------------------------------------------------------------------------------------------
+//  Упорядоченный словарь для целых ключей со сжатием ключей.
+//
+//  Ключи отсортированы и разбиты на блоки не более чем по block_keys штук. В блоке хранится
+//  только первый ключ (в верхнем индексе first_keys), а остальные — как разности соседних
+//  ключей минус 1, упакованные по width бит (width — длина наибольшей разности блока).
+//  Для плотных ключей (1, 2, 3, ...) width равна 0 и ключи блока не занимают ничего.
+//  Значения лежат рядом в обычном массиве блока.
+//
+//  Поиск: двоичный поиск блока по верхнему индексу, распаковка блока (для 32-битных
+//  ключей префиксные суммы считаются по 4 за шаг SSE2) и двоичный поиск в распакованном.
+//  Вставка и удаление распаковывают один блок и упаковывают его заново; переполненный
+//  блок делится пополам, опустевший наполовину сливается с соседом.
+//  Указатель, возвращённый find(), действителен до следующего изменения словаря.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value>
+class Packed_Int_Dictionary {
+    static_assert(std::is_integral<Key>::value, "Packed_Int_Dictionary: ключ должен быть целым");
+
+    using Unsigned = typename std::make_unsigned<Key>::type;
+
+public:
+    static constexpr size_t block_keys = 128;
+
+private:
+    // Знаковый бит переворачивается, чтобы порядок беззнаковых совпадал с порядком ключей
+    static constexpr Unsigned sign_flip = std::is_signed<Key>::value ?
+        Unsigned(Unsigned(1) << (sizeof(Key) * 8 - 1)) : Unsigned(0);
+
+    struct Block {
+        std::vector<uint64_t> bits;     // упакованные разности (и одно слово запаса)
+        std::vector<Value>    values;
+        uint8_t               width = 0;
+    };
+
+    std::vector<Key>   first_keys;   // верхний индекс: первый ключ каждого блока
+    std::vector<Block> blocks;
+    size_t             count = 0;
+
+    static Unsigned to_unsigned(Key key) {
+        return static_cast<Unsigned>(static_cast<Unsigned>(key) ^ sign_flip);
+    }
+
+    static Key to_key(Unsigned value) {
+        return static_cast<Key>(static_cast<Unsigned>(value ^ sign_flip));
+    }
+
+    // Хранимая разность соседних ключей (ключи различны, поэтому разность не меньше 1)
+    static uint64_t gap(Unsigned previous, Unsigned next) {
+        return uint64_t(Unsigned(next - previous)) - 1;
+    }
+
+    // Распаковывает ключи блока b в out (block_keys + 1 ячеек)
+    void decode(size_t b, Unsigned* out) const {
+        const Block& block = blocks[b];
+        const size_t n = block.values.size();
+        const unsigned width = block.width;
+        out[0] = to_unsigned(first_keys[b]);
+        if (width == 0) {
+            for (size_t i = 1; i < n; ++i) {
+                out[i] = static_cast<Unsigned>(out[0] + i);
+            }
+            return;
+        }
+
+        // Разности независимы друг от друга: цикл без ветвлений
+        const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+        const uint64_t* bits = block.bits.data();
+        for (size_t i = 1; i < n; ++i) {
+            size_t position = (i - 1) * width;
+            size_t word = position >> 6;
+            unsigned offset = static_cast<unsigned>(position & 63);
+            uint64_t value = (bits[word] >> offset) | ((bits[word + 1] << 1) << (63 - offset));
+            out[i] = static_cast<Unsigned>((value & mask) + 1);
+        }
+
+        // Префиксные суммы
+        size_t i = 1;
+#if defined(PACKED_DICTIONARY_SSE2)
+        if constexpr (sizeof(Unsigned) == 4) {
+            __m128i carry = _mm_set1_epi32(static_cast<int>(out[0]));
+            for (; i + 4 <= n; i += 4) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i));
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+                x = _mm_add_epi32(x, carry);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+                carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = static_cast<Unsigned>(out[i] + out[i - 1]);
+        }
+    }
+
+    // Упаковывает n > 0 отсортированных ключей в блок b
+    void encode(size_t b, const Unsigned* keys, size_t n) {
+        first_keys[b] = to_key(keys[0]);
+        uint64_t widest = 0;
+        for (size_t i = 1; i < n; ++i) {
+            widest |= gap(keys[i - 1], keys[i]);
+        }
+        unsigned width = 0;
+        while (width < 64 && (widest >> width) != 0) {
+            ++width;
+        }
+
+        Block& block = blocks[b];
+        block.width = static_cast<uint8_t>(width);
+        if (width == 0) {
+            block.bits = std::vector<uint64_t>();
+            return;
+        }
+        std::vector<uint64_t> bits(((n - 1) * width + 63) / 64 + 1, 0);
+        for (size_t i = 1; i < n; ++i) {
+            uint64_t value = gap(keys[i - 1], keys[i]);
+            size_t position = (i - 1) * width;
+            size_t word = position >> 6;
+            unsigned offset = static_cast<unsigned>(position & 63);
+            bits[word] |= value << offset;
+            if (offset + width > 64) {
+                bits[word + 1] |= value >> (64 - offset);
+            }
+        }
+        block.bits = std::move(bits);
+    }
+
+    // Блок, в котором должен лежать ключ (для ключа меньше всех — первый)
+    size_t block_of(Key key) const {
+        size_t b = static_cast<size_t>(std::upper_bound(first_keys.begin(), first_keys.end(), key) - first_keys.begin());
+        return b == 0 ? 0 : b - 1;
+    }
+
+    // Сливает блок b со следующим, если вместе они помещаются в один
+    void merge_with_next(size_t b) {
+        if (b + 1 >= blocks.size() ||
+            blocks[b].values.size() + blocks[b + 1].values.size() > block_keys) {
+            return;
+        }
+        Unsigned keys[2 * block_keys + 1];
+        decode(b, keys);
+        size_t n = blocks[b].values.size();
+        decode(b + 1, keys + n);
+        n += blocks[b + 1].values.size();
+        blocks[b].values.insert(blocks[b].values.end(),
+            blocks[b + 1].values.begin(), blocks[b + 1].values.end());
+        encode(b, keys, n);
+        blocks.erase(blocks.begin() + b + 1);
+        first_keys.erase(first_keys.begin() + b + 1);
+    }
+
+public:
+    Packed_Int_Dictionary() = default;
+
+    // Строит словарь из отсортированных пар без повторов ключей
+    Packed_Int_Dictionary(const std::vector<Key>& sorted_keys, const std::vector<Value>& sorted_values) {
+        assign_sorted(sorted_keys, sorted_values);
+    }
+
+    // Строит словарь по текущему содержимому дерева
+    template <typename Filter, bool Collect_Stats>
+    explicit Packed_Int_Dictionary(const RB_Dictionary<Key, Value, Filter, Collect_Stats>& tree) {
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        keys.reserve(tree.size());
+        values.reserve(tree.size());
+        tree.for_each([&](const Key& key, const Value& value) {
+            keys.push_back(key);
+            values.push_back(value);
+        });
+        assign_sorted(keys, values);
+    }
+
+    // Заменяет содержимое отсортированными парами без повторов ключей; блоки заполняются целиком
+    void assign_sorted(const std::vector<Key>& sorted_keys, const std::vector<Value>& sorted_values) {
+        clear();
+        count = sorted_keys.size();
+        size_t block_count = (count + block_keys - 1) / block_keys;
+        first_keys.resize(block_count);
+        blocks.resize(block_count);
+        Unsigned keys[block_keys + 1];
+        for (size_t b = 0; b < block_count; ++b) {
+            size_t begin = b * block_keys;
+            size_t n = std::min(block_keys, count - begin);
+            for (size_t i = 0; i < n; ++i) {
+                keys[i] = to_unsigned(sorted_keys[begin + i]);
+            }
+            blocks[b].values.assign(sorted_values.begin() + begin, sorted_values.begin() + begin + n);
+            encode(b, keys, n);
+        }
+    }
+
+    // Возвращает true, если ключ новый; иначе обновляет значение
+    bool insert(Key key, const Value& value) {
+        if (blocks.empty()) {
+            first_keys.push_back(key);
+            blocks.emplace_back();
+            blocks[0].values.push_back(value);
+            count = 1;
+            return true;
+        }
+
+        size_t b = block_of(key);
+        Unsigned keys[block_keys + 1];
+        decode(b, keys);
+        Block& block = blocks[b];
+        size_t n = block.values.size();
+        Unsigned target = to_unsigned(key);
+        size_t pos = static_cast<size_t>(std::lower_bound(keys, keys + n, target) - keys);
+        if (pos < n && keys[pos] == target) {
+            block.values[pos] = value;
+            return false;
+        }
+
+        std::copy_backward(keys + pos, keys + n, keys + n + 1);
+        keys[pos] = target;
+        block.values.insert(block.values.begin() + pos, value);
+        ++n;
+        ++count;
+
+        if (n <= block_keys) {
+            encode(b, keys, n);
+            return true;
+        }
+
+        // Переполненный блок делится пополам
+        size_t half = n / 2;
+        Block right;
+        right.values.assign(block.values.begin() + half, block.values.end());
+        block.values.erase(block.values.begin() + half, block.values.end());
+        block.values.shrink_to_fit();
+        blocks.insert(blocks.begin() + b + 1, std::move(right));
+        first_keys.insert(first_keys.begin() + b + 1, Key());
+        encode(b, keys, half);
+        encode(b + 1, keys + half, n - half);
+        return true;
+    }
+
+    bool erase(Key key) {
+        if (blocks.empty()) {
+            return false;
+        }
+        size_t b = block_of(key);
+        Unsigned keys[block_keys + 1];
+        decode(b, keys);
+        Block& block = blocks[b];
+        size_t n = block.values.size();
+        Unsigned target = to_unsigned(key);
+        size_t pos = static_cast<size_t>(std::lower_bound(keys, keys + n, target) - keys);
+        if (pos == n || keys[pos] != target) {
+            return false;
+        }
+
+        --count;
+        if (n == 1) {
+            blocks.erase(blocks.begin() + b);
+            first_keys.erase(first_keys.begin() + b);
+            return true;
+        }
+        std::copy(keys + pos + 1, keys + n, keys + pos);
+        block.values.erase(block.values.begin() + pos);
+        encode(b, keys, n - 1);
+
+        // Малый блок сливается с соседом
+        if (n - 1 < block_keys / 4) {
+            if (b + 1 < blocks.size()) {
+                merge_with_next(b);
+            }
+            else if (b > 0) {
+                merge_with_next(b - 1);
+            }
+        }
+        return true;
+    }
+
+    Value* find(Key key) {
+        return const_cast<Value*>(static_cast<const Packed_Int_Dictionary*>(this)->find(key));
+    }
+
+    const Value* find(Key key) const {
+        if (blocks.empty() || key < first_keys[0]) {
+            return nullptr;
+        }
+        size_t b = block_of(key);
+        Unsigned keys[block_keys + 1];
+        decode(b, keys);
+        size_t n = blocks[b].values.size();
+        Unsigned target = to_unsigned(key);
+        size_t pos = static_cast<size_t>(std::lower_bound(keys, keys + n, target) - keys);
+        if (pos < n && keys[pos] == target) {
+            return &blocks[b].values[pos];
+        }
+        return nullptr;
+    }
+
+    bool contains(Key key) const {
+        return find(key) != nullptr;
+    }
+
+    void clear() {
+        first_keys.clear();
+        blocks.clear();
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Обход в порядке возрастания ключей
+    template <typename Func>
+    void for_each(Func func) const {
+        Unsigned keys[block_keys + 1];
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            decode(b, keys);
+            for (size_t i = 0; i < blocks[b].values.size(); ++i) {
+                func(to_key(keys[i]), blocks[b].values[i]);
+            }
+        }
+    }
+
+    size_t block_count() const {
+        return blocks.size();
+    }
+
+    // Байты на хранение ключей: верхний индекс, описатели блоков и упакованные разности
+    size_t key_bytes() const {
+        size_t result = sizeof(*this) + first_keys.capacity() * sizeof(Key) + blocks.capacity() * sizeof(Block);
+        for (const Block& block : blocks) {
+            result += block.bits.capacity() * sizeof(uint64_t);
+        }
+        return result;
+    }
+
+    // Всего байт, включая значения
+    size_t bytes() const {
+        size_t result = key_bytes();
+        for (const Block& block : blocks) {
+            result += block.values.capacity() * sizeof(Value);
+        }
+        return result;
+    }
+};
+
+// Упорядоченный словарь, выбираемый по типу ключа при компиляции:
+// для целых ключей — Packed_Int_Dictionary, для остальных — RB_Dictionary
+template <typename Key, typename Value>
+using Ordered_Dictionary = typename std::conditional<std::is_integral<Key>::value,
+    Packed_Int_Dictionary<Key, Value>, RB_Dictionary<Key, Value>>::type;
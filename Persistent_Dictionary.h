@@ -0,0 +1,396 @@
+﻿// Persistent_Dictionary.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------
+//  Персистентное упорядоченное дерево с копированием пути (path copying).
+//
+//  snapshot() за O(1) возвращает неизменяемую версию дерева: снимок лишь захватывает
+//  ссылку на корень. Запись после снимка копирует только узлы на изменяемом пути
+//  (O(log n) штук), остальные поддеревья остаются общими для всех версий. Узел, на который
+//  ссылается лишь текущая версия (счётчик ссылок равен 1), изменяется на месте, поэтому
+//  без снимков дерево работает почти как обычное.
+//
+//  Балансировка — левостороннее красно-чёрное дерево (LLRB, Седжвик): вставка и удаление
+//  рекурсивны и меняют только узлы пути и их соседей, поэтому не нужны ни указатели
+//  на родителя, ни пул узлов с переиспользованием на месте (в отличие от RB_Dictionary:
+//  узел может принадлежать сразу нескольким версиям). Версии освобождаются подсчётом ссылок.
+//
+//  Запись и snapshot() выполняются из одного потока (или под внешней блокировкой);
+//  снимки можно читать и уничтожать в любых потоках одновременно с записью.
+//------------------------------------------------------------------------------------------------
+
+namespace persistent_detail {
+
+    template <typename Key, typename Value>
+    struct Node {
+        Key                   key;
+        Value                 value;
+        Node*                 left = nullptr;
+        Node*                 right = nullptr;
+        std::atomic<uint32_t> refs{ 1 };
+        bool                  red = true;
+
+        Node(const Key& k, const Value& v) : key(k), value(v) {
+        }
+    };
+
+    template <typename Key, typename Value>
+    inline void retain(Node<Key, Value>* node) {
+        if (node != nullptr) {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Снимает ссылку; узлы, на которые больше никто не ссылается, удаляются вместе с поддеревьями
+    template <typename Key, typename Value>
+    inline void release(Node<Key, Value>* node) {
+        std::vector<Node<Key, Value>*> stack;
+        while (true) {
+            if (node != nullptr && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                stack.push_back(node->left);
+                stack.push_back(node->right);
+                delete node;
+            }
+            if (stack.empty()) {
+                return;
+            }
+            node = stack.back();
+            stack.pop_back();
+        }
+    }
+
+    template <typename Key, typename Value>
+    inline const Value* find(const Node<Key, Value>* node, const Key& key) {
+        while (node != nullptr) {
+            if (key < node->key) {
+                node = node->left;
+            }
+            else if (node->key < key) {
+                node = node->right;
+            }
+            else {
+                return &node->value;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename Key, typename Value, typename Func>
+    inline void for_each(const Node<Key, Value>* root, Func func) {
+        std::vector<const Node<Key, Value>*> stack;
+        const Node<Key, Value>* curr = root;
+        while (curr != nullptr || !stack.empty()) {
+            while (curr != nullptr) {
+                stack.push_back(curr);
+                curr = curr->left;
+            }
+            curr = stack.back();
+            stack.pop_back();
+            func(curr->key, curr->value);
+            curr = curr->right;
+        }
+    }
+
+}
+
+// Неизменяемая версия дерева; копирование — O(1)
+template <typename Key, typename Value>
+class RB_Snapshot {
+    using Node = persistent_detail::Node<Key, Value>;
+
+    Node*  root = nullptr;
+    size_t count = 0;
+
+    template <typename, typename>
+    friend class Persistent_RB_Dictionary;
+
+    RB_Snapshot(Node* r, size_t n) : root(r), count(n) {
+        persistent_detail::retain(root);
+    }
+
+public:
+    RB_Snapshot() = default;
+
+    RB_Snapshot(const RB_Snapshot& other) : root(other.root), count(other.count) {
+        persistent_detail::retain(root);
+    }
+
+    RB_Snapshot(RB_Snapshot&& other) noexcept : root(other.root), count(other.count) {
+        other.root = nullptr;
+        other.count = 0;
+    }
+
+    RB_Snapshot& operator=(RB_Snapshot other) noexcept {
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    ~RB_Snapshot() {
+        persistent_detail::release(root);
+    }
+
+    const Value* find(const Key& key) const {
+        return persistent_detail::find(root, key);
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Симметричный обход в порядке возрастания ключей
+    template <typename Func>
+    void for_each(Func func) const {
+        persistent_detail::for_each(root, func);
+    }
+};
+
+template <typename Key, typename Value>
+class Persistent_RB_Dictionary {
+    using Node = persistent_detail::Node<Key, Value>;
+
+    Node*  root = nullptr;
+    size_t node_count = 0;
+    size_t copied = 0;   // узлов скопировано из-за общих версий
+
+    static bool is_red(const Node* node) {
+        return node != nullptr && node->red;
+    }
+
+    // Возвращает узел, который можно менять: сам узел, если он принадлежит только этой
+    // версии, иначе его копию. Ссылка на результат хранится там же, где была ссылка на node.
+    Node* own(Node* node) {
+        if (node == nullptr || node->refs.load(std::memory_order_acquire) == 1) {
+            return node;
+        }
+        Node* copy = new Node(node->key, node->value);
+        copy->left = node->left;
+        copy->right = node->right;
+        copy->red = node->red;
+        persistent_detail::retain(copy->left);
+        persistent_detail::retain(copy->right);
+        persistent_detail::release(node);
+        ++copied;
+        return copy;
+    }
+
+    Node* rotate_left(Node* h) {
+        Node* x = own(h->right);
+        h->right = x->left;
+        x->left = h;
+        x->red = h->red;
+        h->red = true;
+        return x;
+    }
+
+    Node* rotate_right(Node* h) {
+        Node* x = own(h->left);
+        h->left = x->right;
+        x->right = h;
+        x->red = h->red;
+        h->red = true;
+        return x;
+    }
+
+    void flip_colors(Node* h) {
+        h->left = own(h->left);
+        h->right = own(h->right);
+        h->red = !h->red;
+        h->left->red = !h->left->red;
+        h->right->red = !h->right->red;
+    }
+
+    Node* balance(Node* h) {
+        if (is_red(h->right) && !is_red(h->left)) {
+            h = rotate_left(h);
+        }
+        if (is_red(h->left) && is_red(h->left->left)) {
+            h = rotate_right(h);
+        }
+        if (is_red(h->left) && is_red(h->right)) {
+            flip_colors(h);
+        }
+        return h;
+    }
+
+    // h уже принадлежит этой версии
+    Node* move_red_left(Node* h) {
+        flip_colors(h);
+        if (is_red(h->right->left)) {
+            h->right = rotate_right(h->right);
+            h = rotate_left(h);
+            flip_colors(h);
+        }
+        return h;
+    }
+
+    Node* move_red_right(Node* h) {
+        flip_colors(h);
+        if (is_red(h->left->left)) {
+            h = rotate_right(h);
+            flip_colors(h);
+        }
+        return h;
+    }
+
+    Node* insert_at(Node* h, const Key& key, const Value& value, bool& inserted) {
+        if (h == nullptr) {
+            inserted = true;
+            return new Node(key, value);
+        }
+        h = own(h);
+        if (key < h->key) {
+            h->left = insert_at(h->left, key, value, inserted);
+        }
+        else if (h->key < key) {
+            h->right = insert_at(h->right, key, value, inserted);
+        }
+        else {
+            h->value = value;
+        }
+        return balance(h);
+    }
+
+    Node* erase_min(Node* h) {
+        h = own(h);
+        if (h->left == nullptr) {
+            persistent_detail::release(h);
+            return nullptr;
+        }
+        if (!is_red(h->left) && !is_red(h->left->left)) {
+            h = move_red_left(h);
+        }
+        h->left = erase_min(h->left);
+        return balance(h);
+    }
+
+    // Ключ обязан присутствовать в поддереве h
+    Node* erase_at(Node* h, const Key& key) {
+        h = own(h);
+        if (key < h->key) {
+            if (!is_red(h->left) && !is_red(h->left->left)) {
+                h = move_red_left(h);
+            }
+            h->left = erase_at(h->left, key);
+        }
+        else {
+            if (is_red(h->left)) {
+                h = rotate_right(h);
+            }
+            if (!(key < h->key) && !(h->key < key) && h->right == nullptr) {
+                persistent_detail::release(h);
+                return nullptr;
+            }
+            if (!is_red(h->right) && !is_red(h->right->left)) {
+                h = move_red_right(h);
+            }
+            if (!(key < h->key) && !(h->key < key)) {
+                const Node* successor = h->right;
+                while (successor->left != nullptr) {
+                    successor = successor->left;
+                }
+                h->key = successor->key;
+                h->value = successor->value;
+                h->right = erase_min(h->right);
+            }
+            else {
+                h->right = erase_at(h->right, key);
+            }
+        }
+        return balance(h);
+    }
+
+public:
+    Persistent_RB_Dictionary() = default;
+
+    ~Persistent_RB_Dictionary() {
+        persistent_detail::release(root);
+    }
+
+    Persistent_RB_Dictionary(const Persistent_RB_Dictionary&) = delete;
+    Persistent_RB_Dictionary& operator=(const Persistent_RB_Dictionary&) = delete;
+
+    // Продолжает запись от снимка: O(1), узлы снимка копируются по мере изменения
+    explicit Persistent_RB_Dictionary(const RB_Snapshot<Key, Value>& from)
+        : root(from.root), node_count(from.count) {
+        persistent_detail::retain(root);
+    }
+
+    // Возвращает true, если ключ новый; иначе обновляет значение
+    bool insert(const Key& key, const Value& value) {
+        bool inserted = false;
+        root = insert_at(root, key, value, inserted);
+        root->red = false;
+        node_count += inserted;
+        return inserted;
+    }
+
+    bool erase(const Key& key) {
+        if (!contains(key)) {
+            return false;
+        }
+        root = own(root);
+        if (!is_red(root->left) && !is_red(root->right)) {
+            root->red = true;
+        }
+        root = erase_at(root, key);
+        if (root != nullptr) {
+            root = own(root);
+            root->red = false;
+        }
+        --node_count;
+        return true;
+    }
+
+    // Указатель действителен до следующего изменения словаря
+    const Value* find(const Key& key) const {
+        return persistent_detail::find(root, key);
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t size() const {
+        return node_count;
+    }
+
+    bool empty() const {
+        return node_count == 0;
+    }
+
+    void clear() {
+        persistent_detail::release(root);
+        root = nullptr;
+        node_count = 0;
+    }
+
+    template <typename Func>
+    void for_each(Func func) const {
+        persistent_detail::for_each(root, func);
+    }
+
+    // Неизменяемая версия текущего состояния за O(1)
+    RB_Snapshot<Key, Value> snapshot() const {
+        return RB_Snapshot<Key, Value>(root, node_count);
+    }
+
+    // Сколько узлов скопировано с момента создания из-за того, что их делили версии
+    size_t copied_nodes() const {
+        return copied;
+    }
+};
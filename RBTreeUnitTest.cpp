@@ -1,12 +1,68 @@
 ﻿#include "pch.h"
 #include "CppUnitTest.h"
+#include <sstream>
+#include <memory_resource>
+#include <type_traits>
 #include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\RB_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Eytzinger_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Mapped_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Small_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Persistent_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Top_Down_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\LSM_Dictionary.h"
+#include "C:\Users\PC\OneDrive - vyatsu\УЧЕБА\2 курс 4 семестр\Курсовой проект\Dict\Packed_Dictionary.h"
 
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace RBTreeUnitTest
 {
+    // Источник памяти, который считает занятые байты
+    struct Counting_Resource : std::pmr::memory_resource {
+        size_t bytes = 0;
+        void* do_allocate(size_t size, size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            bytes -= size;
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // Итог проверки обхода for_each: ключи строго возрастают и каждая пара прошла проверку
+    struct Key_Order {
+        bool   ordered = true;
+        bool   complete = true;   // for_each, возвращающий bool, дошёл до конца
+        size_t count = 0;
+        int    last = 0;          // последний ключ обхода
+    };
+
+    template <typename Container, typename Check>
+    Key_Order check_key_order(const Container& dict, Check check) {
+        Key_Order order;
+        auto visit = [&](const int& key, const auto& value) {
+            order.ordered = order.ordered && (order.count == 0 || order.last < key) && check(key, value);
+            order.last = key;
+            ++order.count;
+        };
+        if constexpr (std::is_same<decltype(dict.for_each(visit)), bool>::value) {
+            order.complete = dict.for_each(visit);
+        }
+        else {
+            dict.for_each(visit);
+        }
+        return order;
+    }
+
+    template <typename Container>
+    Key_Order check_key_order(const Container& dict) {
+        return check_key_order(dict, [](const int&, const auto&) { return true; });
+    }
+
 	TEST_CLASS(RBTreeUnitTest)
 	{
 	public:
@@ -179,5 +235,399 @@ namespace RBTreeUnitTest
             Assert::IsNull(dict.find(1));
             Assert::AreEqual(static_cast<size_t>(0), dict.size());
         }
+
+        // Тест 16: Обход for_each идёт в порядке возрастания ключей
+        TEST_METHOD(Test_For_Each_Order)
+        {
+            RB_Dictionary<int, int> dict;
+            for (int i = 9; i >= 0; --i)
+                dict.insert(i * 3 % 10, i);
+
+            int expected = 0;
+            dict.for_each([&](const int& key, const int&) {
+                Assert::AreEqual(expected, key);
+                ++expected;
+            });
+            Assert::AreEqual(10, expected);
+        }
+
+        // Тест 17: Снимок Эйтцингера: поиск, lower_bound и rank
+        TEST_METHOD(Test_Freeze_Snapshot)
+        {
+            RB_Dictionary<int, int> dict;
+            for (int i = 1; i <= 100; ++i)
+                dict.insert(i * 2, i);   // чётные ключи 2..200
+
+            Eytzinger_Dictionary<int, int> snapshot = dict.freeze();
+            Assert::AreEqual(static_cast<size_t>(100), snapshot.size());
+
+            for (int i = 1; i <= 100; ++i) {
+                Assert::AreEqual(i, *snapshot.find(i * 2));
+                Assert::IsNull(snapshot.find(i * 2 + 1));
+                if (i < 100)
+                    Assert::AreEqual(i * 2 + 2, *snapshot.lower_bound(i * 2 + 1));
+                Assert::AreEqual(static_cast<size_t>(i - 1), snapshot.rank(i * 2));
+            }
+            Assert::AreEqual(2, *snapshot.lower_bound(-5));
+            Assert::IsNull(snapshot.lower_bound(201));
+            Assert::AreEqual(static_cast<size_t>(100), snapshot.rank(1000));
+
+            // Значений меньше, чем ключей
+            Assert::ExpectException<std::invalid_argument>([] {
+                Eytzinger_Dictionary<int, int> broken(std::vector<int>{ 1, 2, 3 }, std::vector<int>{ 1 });
+            });
+        }
+
+        // Тест 18: Упорядоченный отображаемый файл из дерева и из снимка
+        TEST_METHOD(Test_Mapped_File)
+        {
+            RB_Dictionary<int, int> dict;
+            for (int i = 1; i <= 1000; ++i)
+                dict.insert(i * 2, i);
+
+            Assert::IsTrue(save_mapped(dict, "tree_test.dmap"));
+            Assert::IsTrue(save_mapped(dict.freeze(), "snapshot_test.dmap"));
+
+            for (const char* path : { "tree_test.dmap", "snapshot_test.dmap" }) {
+                Mapped_Ordered_Dictionary<int, int> mapped(path);
+                Assert::IsTrue(mapped.is_open());
+                Assert::AreEqual(static_cast<size_t>(1000), mapped.size());
+                for (int i = 1; i <= 1000; ++i) {
+                    Assert::AreEqual(i, *mapped.find(i * 2));
+                    Assert::IsNull(mapped.find(i * 2 + 1));
+                    Assert::AreEqual(static_cast<size_t>(i - 1), mapped.rank(i * 2));
+                }
+            }
+        }
+
+        // Тест 19: Сохранение в поток и загрузка с построением дерева за линейное время
+        TEST_METHOD(Test_Save_Load)
+        {
+            RB_Dictionary<std::string, int> dict;
+            for (int i = 0; i < 1000; ++i)
+                dict.insert("key" + std::to_string(i), i);
+
+            std::stringstream stream;
+            Assert::IsTrue(dict.save(stream));
+            std::string bytes = stream.str();
+
+            RB_Dictionary<std::string, int> loaded;
+            Assert::IsTrue(loaded.load(stream));
+            Assert::AreEqual(static_cast<size_t>(1000), loaded.size());
+            for (int i = 0; i < 1000; ++i)
+                Assert::AreEqual(i, *loaded.find("key" + std::to_string(i)));
+
+            // Загруженное дерево остаётся рабочим: вставки и удаления с балансировкой
+            for (int i = 0; i < 1000; i += 2)
+                Assert::IsTrue(loaded.erase("key" + std::to_string(i)));
+            Assert::IsTrue(loaded.insert("new", -1));
+            Assert::AreEqual(static_cast<size_t>(501), loaded.size());
+
+            bytes[bytes.size() / 2] ^= 1;
+            std::stringstream corrupted(bytes);
+            Assert::IsFalse(loaded.load(corrupted));
+            Assert::AreEqual(static_cast<size_t>(0), loaded.size());
+        }
+
+        // Тест 20: Фильтр отпечатков отслеживает вставки и удаления и переживает переполнение кластера
+        TEST_METHOD(Test_Fingerprint_Filter)
+        {
+            RB_Dictionary<int, int, Fingerprint_Filter> dict;
+            for (int i = 0; i < 5000; ++i)
+                dict.insert(i, i);
+            for (int i = 0; i < 5000; i += 2)
+                Assert::IsTrue(dict.erase(i));
+            Assert::IsFalse(dict.erase(0));
+
+            for (int i = 0; i < 10000; ++i) {
+                bool expected = i < 5000 && i % 2 == 1;
+                Assert::AreEqual(expected, dict.contains(i));
+            }
+            dict[0] = 7;
+            Assert::AreEqual(7, *dict.find(0));
+
+            // Переполненный кластер: фильтр не теряет ключи, а отвечает «возможно» на всё
+            Fingerprint_Filter filter;
+            filter.reset(1000);
+            bool added = true;
+            for (uint64_t i = 0; i < 300; ++i) {
+                added = added && filter.add(i);   // одна домашняя ячейка у всех
+            }
+            Assert::IsFalse(added);
+            for (uint64_t i = 0; i < 300; ++i) {
+                Assert::IsTrue(filter.may_contain(i));
+            }
+            // Пересборка удваивает место, пока кластеры не станут короче max_distance
+            rebuild_membership_filter(filter, 1000, [](auto add) {
+                for (uint64_t i = 0; i < 300; ++i) {
+                    add(i << 44);
+                }
+            });
+            Assert::IsTrue(filter.may_contain(uint64_t(299) << 44));
+            Assert::IsFalse(filter.may_contain(uint64_t(12345)));
+        }
+
+        // Тест 21: Малый словарь сохраняет порядок обхода до и после переезда в дерево
+        TEST_METHOD(Test_Small_Dictionary_Order)
+        {
+            Small_Dictionary<std::string, int, RB_Dictionary<std::string, int>, 4> dict;
+            dict.insert("d", 4);
+            dict.insert("b", 2);
+            dict.insert("a", 1);
+            dict.insert("c", 3);
+            Assert::IsTrue(dict.is_inline());
+
+            std::string order;
+            dict.for_each([&](const std::string& key, int) { order += key; });
+            Assert::AreEqual(std::string("abcd"), order);
+
+            dict.insert("e", 5);
+            Assert::IsFalse(dict.is_inline());
+            order.clear();
+            dict.for_each([&](const std::string& key, int) { order += key; });
+            Assert::AreEqual(std::string("abcde"), order);
+            Assert::IsTrue(dict.erase("a"));
+            Assert::AreEqual(static_cast<size_t>(4), dict.size());
+        }
+
+        // Тест 22: Статистика дерева: высота, чёрная высота, пул и повороты
+        TEST_METHOD(Test_RB_Stats)
+        {
+            RB_Dictionary<int, int, No_Filter, true> dict;
+            for (int i = 1; i <= 7; ++i) {
+                dict.insert(i, i);
+            }
+            RB_Stats stats = dict.stats();
+            Assert::AreEqual(static_cast<size_t>(7), stats.element_count);
+            Assert::IsTrue(stats.height <= 4);
+            Assert::AreEqual(static_cast<size_t>(2), stats.black_height);
+            Assert::IsTrue(stats.rotations > 0);
+            Assert::AreEqual(static_cast<size_t>(0), stats.pool_free);
+
+            dict.reset_stats();
+            dict.erase(1);
+            dict.erase(2);
+            stats = dict.stats();
+            Assert::AreEqual(static_cast<size_t>(2), stats.pool_free);
+            Assert::IsTrue(stats.average_depth >= 1.0 && stats.average_depth <= double(stats.height));
+
+            RB_Dictionary<int, int> plain;
+            plain.insert(1, 1);
+            Assert::IsFalse(plain.stats().counters_enabled);
+            Assert::AreEqual(static_cast<size_t>(0), plain.stats().rotations);
+            Assert::AreEqual(static_cast<size_t>(1), plain.stats().height);
+        }
+
+        // Тест 23: Снимок персистентного дерева не меняется при последующей записи
+        TEST_METHOD(Test_Persistent_Snapshot)
+        {
+            Persistent_RB_Dictionary<int, int> dict;
+            for (int i = 0; i < 100; ++i) {
+                dict.insert(i, i);
+            }
+            RB_Snapshot<int, int> before = dict.snapshot();
+            RB_Snapshot<int, int> copy = before;
+
+            Assert::IsTrue(dict.erase(10));
+            Assert::IsFalse(dict.insert(20, -20));
+            Assert::IsTrue(dict.insert(200, 200));
+            Assert::IsTrue(dict.copied_nodes() > 0);
+
+            Assert::AreEqual(static_cast<size_t>(100), before.size());
+            Assert::IsTrue(before.contains(10));
+            Assert::AreEqual(20, *before.find(20));
+            Assert::IsFalse(copy.contains(200));
+            Assert::IsFalse(dict.contains(10));
+            Assert::AreEqual(-20, *dict.find(20));
+
+            // Запись от старого снимка не затрагивает ни его, ни текущую версию
+            Persistent_RB_Dictionary<int, int> branch(before);
+            branch.erase(0);
+            Assert::IsTrue(before.contains(0));
+            Assert::IsTrue(dict.contains(0));
+
+            Assert::IsTrue(check_key_order(dict).ordered);
+            Assert::AreEqual(static_cast<size_t>(100), dict.size());
+        }
+
+        // Тест 24: Объединение, пересечение и разность поэлементно и слиянием
+        TEST_METHOD(Test_Set_Operations)
+        {
+            // Второй словарь сравним по размеру — слияние; маленький — поэлементно
+            for (int step : { 2, 500 }) {
+                RB_Dictionary<int, int> base, delta;
+                for (int i = 0; i < 1000; ++i) {
+                    base.insert(i, i);
+                }
+                for (int i = 500; i < 1500; i += step) {
+                    delta.insert(i, -i);
+                }
+
+                RB_Dictionary<int, int> united, common, rest;
+                united.unite(base);
+                united.unite(delta, [](const int& mine, const int& theirs) { return mine + theirs; }, 4);
+                common.unite(base);
+                common.intersect(delta, 4);
+                rest.unite(base);
+                rest.subtract(delta, 4);
+
+                size_t shared = (500 + step - 1) / step;
+                Assert::AreEqual(base.size() + delta.size() - shared, united.size());
+                Assert::AreEqual(0, *united.find(500));
+                Assert::AreEqual(-1000, *united.find(1000));
+                Assert::AreEqual(shared, common.size());
+                Assert::AreEqual(500, *common.find(500));
+                Assert::AreEqual(base.size() - shared, rest.size());
+                Assert::IsFalse(rest.contains(500));
+                Assert::IsTrue(rest.contains(499));
+
+                Assert::IsTrue(check_key_order(united).ordered);
+                Assert::IsTrue(united.stats().height <= 2 * united.stats().black_height + 1);
+            }
+        }
+
+        // Тест 25: Дерево без указателей на родителя остаётся сбалансированным при вставках и удалениях
+        TEST_METHOD(Test_Top_Down_Tree)
+        {
+            Top_Down_RB_Dictionary<int, int> dict;
+            for (int i = 0; i < 1000; ++i) {
+                Assert::IsTrue(dict.insert(i, i));
+            }
+            Assert::IsFalse(dict.insert(10, -10));
+            Assert::AreEqual(-10, *dict.find(10));
+            for (int i = 0; i < 1000; i += 3) {
+                Assert::IsTrue(dict.erase(i));
+            }
+            Assert::IsFalse(dict.erase(0));
+            Assert::AreEqual(static_cast<size_t>(666), dict.size());
+            Assert::IsFalse(dict.contains(999));
+            Assert::IsTrue(dict.contains(998));
+
+            RB_Stats stats = dict.stats();
+            Assert::IsTrue(stats.height <= 2 * stats.black_height + 1);
+            Assert::AreEqual(static_cast<size_t>(334), stats.pool_free);
+            Assert::IsTrue(Top_Down_RB_Dictionary<int, int>::node_bytes() < RB_Dictionary<int, int>::node_bytes());
+
+            Assert::IsTrue(check_key_order(dict, [](int key, int) { return key % 3 != 0; }).ordered);
+            dict.clear();
+            Assert::IsTrue(dict.empty());
+        }
+
+        // Тест 26: Деревья берут узлы из общего источника памяти и возвращают их при уничтожении
+        TEST_METHOD(Test_Memory_Resource)
+        {
+            Counting_Resource counting;
+            {
+                RB_Dictionary<int, int> first(&counting);
+                RB_Dictionary<int, int> second(&counting);
+                Assert::IsTrue(first.get_resource() == &counting);
+                size_t empty_bytes = counting.bytes;
+                for (int i = 0; i < 100; ++i) {
+                    first.insert(i, i);
+                    second.insert(-i, i);
+                }
+                Assert::IsTrue(counting.bytes >= empty_bytes + 200 * RB_Dictionary<int, int>::node_bytes());
+                first.erase(5);
+                Assert::IsFalse(first.contains(5));
+                Assert::AreEqual(99, *second.find(-99));
+            }
+            Assert::AreEqual(static_cast<size_t>(0), counting.bytes);
+        }
+
+        // Тест 27: LSM-словарь выгружает данные в прогоны на диске и находит их там, порча блока обнаруживается
+        TEST_METHOD(Test_LSM_Dictionary)
+        {
+            LSM_Config config;
+            config.memtable_bytes = 100 * RB_Dictionary<int, std::pair<int, bool>>::node_bytes();
+            config.block_records = 8;
+            config.compaction_trigger = 3;
+            {
+                LSM_Dictionary<int, int> dict("lsm_test", config);
+                for (int i = 0; i < 2000; ++i) {
+                    dict.insert(i, i * 2);
+                }
+                for (int i = 0; i < 2000; i += 2) {
+                    dict.erase(i);
+                }
+                dict.insert(10, 7);   // новая версия после надгробия
+                Assert::IsTrue(dict.run_count() <= config.stall_factor * config.compaction_trigger);
+                dict.wait_compaction();
+                Assert::IsTrue(dict.ok());
+                Assert::IsTrue(dict.stats().flushes > 0);
+
+                int value = 0;
+                Assert::IsTrue(dict.find(1999, value));
+                Assert::AreEqual(3998, value);
+                Assert::IsFalse(dict.find(1998, value));
+                Assert::IsTrue(dict.find(10, value));
+                Assert::AreEqual(7, value);
+                Assert::IsFalse(dict.contains(5000));
+
+                Key_Order order = check_key_order(dict, [](int key, int v) {
+                    return key == 10 ? v == 7 : key % 2 == 1 && v == key * 2;
+                });
+                Assert::IsTrue(order.complete);
+                Assert::IsTrue(order.ordered);
+                Assert::AreEqual(static_cast<size_t>(1001), order.count);
+            }
+            // Файлы прогонов удаляются вместе со словарём
+            Assert::IsFalse(static_cast<bool>(std::ifstream("lsm_test_0.run")));
+
+            // Повреждённый блок нового прогона не подменяется старой версией ключа
+            config.background = false;
+            config.compaction_trigger = 100;
+            {
+                LSM_Dictionary<int, int> dict("lsm_bad", config);
+                for (int i = 0; i < 200; ++i) {
+                    dict.insert(i % 100, i);
+                }
+                Assert::AreEqual(static_cast<size_t>(2), dict.run_count());
+                std::fstream run("lsm_bad_1.run", std::ios::binary | std::ios::in | std::ios::out);
+                run.seekp(1);
+                run.put('\x7f');
+                run.close();
+
+                int value = 0;
+                Assert::IsFalse(dict.find(5, value));
+                Assert::IsFalse(dict.ok());
+            }
+        }
+
+        // Тест 28: Сжатый словарь целых ключей делит и сливает блоки и сохраняет порядок
+        TEST_METHOD(Test_Packed_Int_Dictionary)
+        {
+            Packed_Int_Dictionary<int, int> dict;
+            for (int i = 0; i < 1000; ++i) {
+                Assert::IsTrue(dict.insert((i * 7919) % 1000 * 3 - 1500, i));
+            }
+            Assert::IsFalse(dict.insert(-1500, 42));
+            Assert::AreEqual(static_cast<size_t>(1000), dict.size());
+            Assert::IsTrue(dict.block_count() > 1000 / Packed_Int_Dictionary<int, int>::block_keys);
+            Assert::AreEqual(42, *dict.find(-1500));
+            Assert::IsNull(dict.find(-1499));
+            Assert::IsNull(dict.find(1500));
+
+            for (int key = -1500; key < 0; key += 3) {
+                Assert::IsTrue(dict.erase(key));
+            }
+            Assert::IsFalse(dict.erase(-3));
+            Assert::AreEqual(static_cast<size_t>(500), dict.size());
+
+            Key_Order order = check_key_order(dict, [](int key, int) { return key % 3 == 0; });
+            Assert::IsTrue(order.ordered);
+            Assert::AreEqual(1497, order.last);
+
+            // Плотные ключи: разности равны 1 и не занимают места
+            std::vector<int> keys, values;
+            for (int i = 1; i <= 10000; ++i) {
+                keys.push_back(i);
+                values.push_back(-i);
+            }
+            Packed_Int_Dictionary<int, int> dense(keys, values);
+            Assert::AreEqual(-777, *dense.find(777));
+            Assert::IsTrue(dense.key_bytes() < dense.size());
+            Assert::IsTrue((std::is_same<Ordered_Dictionary<int, int>, Packed_Int_Dictionary<int, int>>::value));
+            Assert::IsTrue((std::is_same<Ordered_Dictionary<std::string, int>, RB_Dictionary<std::string, int>>::value));
+        }
 	};
 }
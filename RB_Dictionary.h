@@ -1,10 +1,26 @@
 ﻿// RB_Dictionary.h
 #pragma once
 
+#include <algorithm>
+#include <memory_resource>   // источник памяти для узлов
+#include <new>
 #include <vector>   // для NodePool
 #include <stack>    // для clear()
+#include <thread>   // для параллельного слияния в unite()/intersect()/subtract()
+
+#include "Binary_Stream.h"   // для save()/load()
+#include "Membership_Filter.h"
+#include "Container_Stats.h"   // для stats()
 
 template <typename Key, typename Value>
+class Eytzinger_Dictionary;   // неизменяемый снимок, см. Eytzinger_Dictionary.h
+
+// Filter — необязательный фильтр принадлежности (см. Membership_Filter.h):
+// промахи find()/contains()/erase() отсекаются без спуска по дереву.
+// Collect_Stats — вести счётчик поворотов для stats() (см. Container_Stats.h)
+// Узлы выделяются из std::pmr::memory_resource, переданного в конструктор: несколько
+// деревьев могут делить один пул или арену.
+template <typename Key, typename Value, typename Filter = No_Filter, bool Collect_Stats = false>
 class RB_Dictionary {
 private:
     enum Color : unsigned char { RED = 0, BLACK = 1 };
@@ -27,16 +43,37 @@ private:
     //  Пул узлов: для ускоренного переиспользования памяти
     //  Вместо delete/new узел возвращается в пул при erase/clear, 
     //  и повторно используется при insert.
+    //  Новые узлы и сам список берутся из resource; в resource узлы возвращаются при уничтожении пула.
     //--------------------------------------------------------------------------------------------
     class NodePool {
-        std::vector<Node*> pool;
+        std::pmr::memory_resource* resource;
+        std::pmr::vector<Node*> pool;
     public:
+        explicit NodePool(std::pmr::memory_resource* r) : resource(r), pool(r) {
+        }
+
         ~NodePool() {
             for (auto p : pool) {
-                delete p;
+                release(p);
             }
         }
 
+        // Новый узел из resource
+        inline Node* allocate(const Key& key, const Value& value) {
+            void* memory = resource->allocate(sizeof(Node), alignof(Node));
+            return new (memory) Node(key, value);
+        }
+
+        // Уничтожает узел и возвращает память в resource (минуя пул)
+        inline void release(Node* node) {
+            node->~Node();
+            resource->deallocate(node, sizeof(Node), alignof(Node));
+        }
+
+        std::pmr::memory_resource* get_resource() const {
+            return resource;
+        }
+
         // Если есть узел в пуле, возвращаем его, иначе — nullptr
         inline Node* allocate_from_pool() {
             if (!pool.empty()) {
@@ -51,12 +88,25 @@ private:
         inline void deallocate(Node* node) {
             pool.push_back(node);
         }
+
+        size_t free_count() const {
+            return pool.size();
+        }
+
+        size_t capacity() const {
+            return pool.capacity();
+        }
     };
 
     Node* root;       // корень дерева
     Node* nil;        // единственный «sentinel» узел, вместо nullptr
     size_t      node_count; // число элементов
     NodePool    pool;       // пул узлов
+    Filter      filter;     // фильтр принадлежности (пустой при Filter = No_Filter)
+    Stats_Counter<Collect_Stats> rotations; // счётчик поворотов (пустой при Collect_Stats = false)
+
+    // Начальная вместимость фильтра
+    static constexpr size_t initial_filter_capacity = 16;
 
 
     // Создаёт новый узел, либо берёт из пула и переинициализирует, либо выделяет через new
@@ -71,8 +121,8 @@ private:
             x->color = RED;
             return x;
         }
-        // В пуле ничего нет — вызываем new
-        x = new Node(key, value);
+        // В пуле ничего нет — выделяем новый
+        x = pool.allocate(key, value);
         x->left = nil;
         x->right = nil;
         x->parent = nil;
@@ -80,6 +130,26 @@ private:
         return x;
     }
 
+    // Пересборка фильтра по всем ключам дерева с запасом под рост
+    void rebuild_filter(size_t expected) {
+        if constexpr (Filter::enabled) {
+            rebuild_membership_filter(filter, expected, [&](auto add) {
+                for_each([&](const Key& key, const Value&) {
+                    add(membership_hash(key));
+                });
+            });
+        }
+    }
+
+    // Учитывает в фильтре только что вставленный ключ (node_count уже увеличен)
+    inline void filter_insert(const Key& key) {
+        if constexpr (Filter::enabled) {
+            if (filter.needs_rebuild(node_count) || !filter.add(membership_hash(key))) {
+                rebuild_filter(node_count * 2);
+            }
+        }
+    }
+
     // Освобождает узел — помещает его в пул (не вызывает delete)
     inline void destroy_node(Node* x) {
         pool.deallocate(x);
@@ -87,6 +157,7 @@ private:
 
     // Левый поворот вокруг узла x
     inline void leftRotate(Node* x) {
+        rotations.add();
         Node* y = x->right;
         x->right = y->left;
         if (y->left != nil) {
@@ -108,6 +179,7 @@ private:
 
     // Правый поворот вокруг узла x
     inline void rightRotate(Node* x) {
+        rotations.add();
         Node* y = x->left;
         x->left = y->right;
         if (y->right != nil) {
@@ -261,24 +333,178 @@ private:
         x->color = BLACK;
     }
 
+    // Строит идеально сбалансированное поддерево из отсортированных пар [lo, hi) за линейное время.
+    // Узлы на глубине red_depth (самый нижний, возможно неполный, уровень) красные, остальные чёрные:
+    // тогда на любом пути от корня до nil одинаковое число чёрных узлов.
+    Node* build_sorted(const std::vector<Key>& keys, const std::vector<Value>& values,
+                       size_t lo, size_t hi, size_t depth, size_t red_depth, Node* parent) {
+        if (lo >= hi) {
+            return nil;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        Node* x = create_node(keys[mid], values[mid]);
+        x->parent = parent;
+        x->color = depth == red_depth ? RED : BLACK;
+        x->left = build_sorted(keys, values, lo, mid, depth + 1, red_depth, x);
+        x->right = build_sorted(keys, values, mid + 1, hi, depth + 1, red_depth, x);
+        return x;
+    }
+
+    // Заменяет содержимое дерева строго возрастающей последовательностью пар
+    void assign_sorted(const std::vector<Key>& keys, const std::vector<Value>& values) {
+        clear();
+        size_t red_depth = 0;   // floor(log2(n)) — глубина нижнего уровня
+        while ((size_t(2) << red_depth) <= keys.size()) {
+            ++red_depth;
+        }
+        root = build_sorted(keys, values, 0, keys.size(), 0, red_depth, nil);
+        root->color = BLACK;
+        nil->color = BLACK;
+        node_count = keys.size();
+        rebuild_filter(std::max(node_count, initial_filter_capacity));
+    }
+
+    // Все пары в порядке возрастания ключей
+    void to_sorted(std::vector<Key>& keys, std::vector<Value>& values) const {
+        keys.reserve(node_count);
+        values.reserve(node_count);
+        for_each([&](const Key& key, const Value& value) {
+            keys.push_back(key);
+            values.push_back(value);
+        });
+    }
+
+    enum class Set_Op { UNION, INTERSECTION, DIFFERENCE };
+
+    // Слияние отсортированных отрезков A[a_lo, a_hi) и B[b_lo, b_hi) за линейное время
+    template <typename Merge>
+    static void merge_sorted(Set_Op op, Merge& merge,
+                             const std::vector<Key>& a_keys, const std::vector<Value>& a_values, size_t a_lo, size_t a_hi,
+                             const std::vector<Key>& b_keys, const std::vector<Value>& b_values, size_t b_lo, size_t b_hi,
+                             std::vector<Key>& keys, std::vector<Value>& values) {
+        size_t i = a_lo, j = b_lo;
+        while (i < a_hi && j < b_hi) {
+            if (a_keys[i] < b_keys[j]) {
+                if (op != Set_Op::INTERSECTION) {
+                    keys.push_back(a_keys[i]);
+                    values.push_back(a_values[i]);
+                }
+                ++i;
+            }
+            else if (b_keys[j] < a_keys[i]) {
+                if (op == Set_Op::UNION) {
+                    keys.push_back(b_keys[j]);
+                    values.push_back(b_values[j]);
+                }
+                ++j;
+            }
+            else {
+                if (op == Set_Op::UNION) {
+                    keys.push_back(a_keys[i]);
+                    values.push_back(merge(a_values[i], b_values[j]));
+                }
+                else if (op == Set_Op::INTERSECTION) {
+                    keys.push_back(a_keys[i]);
+                    values.push_back(a_values[i]);
+                }
+                ++i;
+                ++j;
+            }
+        }
+        if (op != Set_Op::INTERSECTION) {
+            keys.insert(keys.end(), a_keys.begin() + i, a_keys.begin() + a_hi);
+            values.insert(values.end(), a_values.begin() + i, a_values.begin() + a_hi);
+        }
+        if (op == Set_Op::UNION) {
+            keys.insert(keys.end(), b_keys.begin() + j, b_keys.begin() + b_hi);
+            values.insert(values.end(), b_values.begin() + j, b_values.begin() + b_hi);
+        }
+    }
+
+    // Слияние с перестройкой дерева: O(n + m). Большие входы делятся на threads частей
+    // по ключам A (границы в B находятся бинарным поиском), части сливаются параллельно
+    // и склеиваются по порядку; дерево строится из результата за линейное время.
+    template <typename Merge>
+    void merge_with(const RB_Dictionary& other, Set_Op op, Merge merge, unsigned threads) {
+        std::vector<Key> a_keys, b_keys;
+        std::vector<Value> a_values, b_values;
+        to_sorted(a_keys, a_values);
+        other.to_sorted(b_keys, b_values);
+
+        // Мелкие входы не стоит делить: накладные расходы на потоки больше выигрыша
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(
+            threads, (a_keys.size() + b_keys.size()) / 65536 + 1)));
+        threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, a_keys.size())));
+        std::vector<size_t> a_bounds(threads + 1), b_bounds(threads + 1);
+        for (unsigned t = 0; t <= threads; ++t) {
+            a_bounds[t] = a_keys.size() * t / threads;
+            b_bounds[t] = t == 0 ? 0 : t == threads ? b_keys.size() :
+                size_t(std::lower_bound(b_keys.begin(), b_keys.end(), a_keys[a_bounds[t]]) - b_keys.begin());
+        }
+
+        std::vector<std::vector<Key>> part_keys(threads);
+        std::vector<std::vector<Value>> part_values(threads);
+        auto work = [&](unsigned t) {
+            merge_sorted(op, merge, a_keys, a_values, a_bounds[t], a_bounds[t + 1],
+                         b_keys, b_values, b_bounds[t], b_bounds[t + 1], part_keys[t], part_values[t]);
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        std::vector<Key>& keys = part_keys[0];
+        std::vector<Value>& values = part_values[0];
+        for (unsigned t = 1; t < threads; ++t) {
+            keys.insert(keys.end(), part_keys[t].begin(), part_keys[t].end());
+            values.insert(values.end(), part_values[t].begin(), part_values[t].end());
+        }
+        assign_sorted(keys, values);
+    }
+
+    // Поэлементная обработка m ключей (O(m log n)) выгоднее слияния (O(n + m)), если m·log2(n) < n + m
+    static bool prefer_pointwise(size_t m, size_t n) {
+        size_t log_n = 1;
+        while (log_n < 64 && (size_t(1) << log_n) < n) {
+            ++log_n;
+        }
+        return m * log_n < n + m;
+    }
+
 public:
 
     //  Конструктор: создаём единственный sentinel nil; весь «пустой» указатель указывает на nil.
 
     RB_Dictionary()
-        : node_count(0)
+        : RB_Dictionary(std::pmr::get_default_resource())
+    {
+    }
+
+    // Конструктор с источником памяти для узлов; resource должен жить дольше дерева
+    explicit RB_Dictionary(std::pmr::memory_resource* resource)
+        : node_count(0), pool(resource)
     {
         // Создаём sentinel-узел nil (чёрный), потомки и родитель указывают на самого себя
-        nil = new Node(Key(), Value());
+        nil = pool.allocate(Key(), Value());
         nil->color = BLACK;
         nil->left = nil->right = nil->parent = nil;
         root = nil;
+        filter.reset(initial_filter_capacity);
     }
 
 
     ~RB_Dictionary() {
         clear();
-        delete nil;
+        pool.release(nil);
+    }
+
+    // Источник памяти для узлов
+    std::pmr::memory_resource* get_resource() const {
+        return pool.get_resource();
     }
 
     bool insert(const Key& key, const Value& value) {
@@ -317,6 +543,7 @@ public:
 
         insertFixup(z);
         ++node_count;
+        filter_insert(key);
         return true;
     }
 
@@ -353,10 +580,16 @@ public:
 
         insertFixup(z);
         ++node_count;
+        filter_insert(key);
         return z->value;
     }
 
     Value* find(const Key& key) const {
+        if constexpr (Filter::enabled) {
+            if (!filter.may_contain(membership_hash(key))) {
+                return nullptr;
+            }
+        }
         Node* x = root;
         while (x != nil) {
             if (key < x->key) {
@@ -373,7 +606,16 @@ public:
     }
 
 
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
     bool erase(const Key& key) {
+        if constexpr (Filter::enabled) {
+            if (!filter.may_contain(membership_hash(key))) {
+                return false;
+            }
+        }
         Node* z = root;
         // Ищем узел с ключом key
         while (z != nil) {
@@ -426,6 +668,10 @@ public:
             y->color = z->color;
         }
 
+        if constexpr (Filter::enabled) {
+            filter.remove(membership_hash(key));
+        }
+
         // Помещаем старый узел z в пул
         destroy_node(z);
         --node_count;
@@ -454,9 +700,208 @@ public:
         }
         root = nil;
         node_count = 0;
+        filter.reset(initial_filter_capacity);
     }
 
     inline size_t size() const {
         return node_count;
     }
+
+    // Симметричный обход: вызывает func(key, value) для всех пар в порядке возрастания ключей
+    template <typename Func>
+    void for_each(Func func) const {
+        std::vector<Node*> stack;
+        Node* curr = root;
+        while (curr != nil || !stack.empty()) {
+            while (curr != nil) {
+                stack.push_back(curr);
+                curr = curr->left;
+            }
+            curr = stack.back();
+            stack.pop_back();
+            func(curr->key, curr->value);
+            curr = curr->right;
+        }
+    }
+
+    // Сохранение пар в двоичный поток в порядке возрастания ключей (формат описан в Binary_Stream.h)
+    bool save(std::ostream& out) const {
+        Binary_Writer writer(out);
+        writer.write_header(BINARY_ORDERED, node_count);
+        for_each([&](const Key& key, const Value& value) {
+            writer.write(key);
+            writer.write(value);
+        });
+        return writer.finish();
+    }
+
+    // Загрузка из двоичного потока. Пары приходят отсортированными, поэтому дерево
+    // строится за линейное время без вставок и поворотов. При ошибке, несовпадении CRC
+    // или нарушении порядка ключей дерево остаётся пустым.
+    bool load(std::istream& in) {
+        clear();
+        Binary_Reader reader(in);
+        uint64_t count = 0;
+        if (!reader.read_header(BINARY_ORDERED, count)) {
+            return false;
+        }
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        Key key;
+        Value value;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!reader.read(key) || !reader.read(value) ||
+                (!keys.empty() && !(keys.back() < key))) {
+                return false;
+            }
+            keys.push_back(key);
+            values.push_back(value);
+        }
+        if (!reader.finish()) {
+            return false;
+        }
+        assign_sorted(keys, values);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------
+    //  Операции над множествами ключей. Если второй словарь намного меньше (m·log n < n + m),
+    //  его пары обрабатываются по одной за O(m log n); иначе оба словаря сливаются как
+    //  отсортированные последовательности и дерево перестраивается за O(n + m).
+    //  threads — число потоков для слияния больших входов.
+    //--------------------------------------------------------------------------------------------
+
+    // Объединение: добавляет пары other; для общих ключей значение = merge(своё, из other)
+    // (при threads > 1 merge может вызываться из нескольких потоков одновременно)
+    template <typename Merge>
+    void unite(const RB_Dictionary& other, Merge merge, unsigned threads = 1) {
+        if (prefer_pointwise(other.size(), node_count)) {
+            other.for_each([&](const Key& key, const Value& value) {
+                if (Value* mine = find(key)) {
+                    *mine = merge(*mine, value);
+                }
+                else {
+                    insert(key, value);
+                }
+            });
+            return;
+        }
+        merge_with(other, Set_Op::UNION, merge, threads);
+    }
+
+    // Объединение, при котором для общих ключей берётся значение из other
+    void unite(const RB_Dictionary& other) {
+        unite(other, [](const Value&, const Value& theirs) { return theirs; });
+    }
+
+    // Пересечение: остаются только ключи, которые есть и в other (значения свои)
+    void intersect(const RB_Dictionary& other, unsigned threads = 1) {
+        if (&other == this) {
+            return;
+        }
+        if (prefer_pointwise(std::min(node_count, other.size()), std::max(node_count, other.size()))) {
+            // Проверяем ключи меньшего словаря в большем; результат уже отсортирован
+            std::vector<Key> keys;
+            std::vector<Value> values;
+            if (other.size() < node_count) {
+                other.for_each([&](const Key& key, const Value&) {
+                    if (const Value* mine = find(key)) {
+                        keys.push_back(key);
+                        values.push_back(*mine);
+                    }
+                });
+            }
+            else {
+                for_each([&](const Key& key, const Value& value) {
+                    if (other.contains(key)) {
+                        keys.push_back(key);
+                        values.push_back(value);
+                    }
+                });
+            }
+            assign_sorted(keys, values);
+            return;
+        }
+        merge_with(other, Set_Op::INTERSECTION, [](const Value& mine, const Value&) { return mine; }, threads);
+    }
+
+    // Разность: удаляет ключи, которые есть в other
+    void subtract(const RB_Dictionary& other, unsigned threads = 1) {
+        if (&other == this) {
+            clear();
+            return;
+        }
+        if (prefer_pointwise(other.size(), node_count)) {
+            other.for_each([&](const Key& key, const Value&) {
+                erase(key);
+            });
+            return;
+        }
+        if (prefer_pointwise(node_count, other.size())) {
+            std::vector<Key> keys;
+            std::vector<Value> values;
+            for_each([&](const Key& key, const Value& value) {
+                if (!other.contains(key)) {
+                    keys.push_back(key);
+                    values.push_back(value);
+                }
+            });
+            assign_sorted(keys, values);
+            return;
+        }
+        merge_with(other, Set_Op::DIFFERENCE, [](const Value& mine, const Value&) { return mine; }, threads);
+    }
+
+    // Снимок внутреннего устройства дерева (обходит все узлы, O(n))
+    RB_Stats stats() const {
+        RB_Stats result;
+        result.element_count = node_count;
+        result.pool_free = pool.free_count();
+        result.bytes = sizeof(*this) + (node_count + result.pool_free + 1) * sizeof(Node) +
+            pool.capacity() * sizeof(Node*);
+        result.counters_enabled = Collect_Stats;
+        result.rotations = rotations.value();
+
+        // Обход в глубину с глубиной узла и числом чёрных узлов на пути от корня
+        struct Item {
+            Node*  node;
+            size_t depth;
+            size_t blacks;
+        };
+        std::vector<Item> stack;
+        size_t depth_sum = 0;
+        if (root != nil) {
+            stack.push_back({ root, 1, 1 });
+        }
+        while (!stack.empty()) {
+            Item item = stack.back();
+            stack.pop_back();
+            depth_sum += item.depth;
+            result.height = std::max(result.height, item.depth);
+            if (item.node->left == nil || item.node->right == nil) {
+                // У корректного дерева на всех путях до nil одно и то же число чёрных узлов
+                result.black_height = item.blacks;
+            }
+            for (Node* child : { item.node->left, item.node->right }) {
+                if (child != nil) {
+                    stack.push_back({ child, item.depth + 1, item.blacks + (child->color == BLACK) });
+                }
+            }
+        }
+        result.average_depth = node_count ? double(depth_sum) / double(node_count) : 0;
+        return result;
+    }
+
+    // Обнуление счётчиков событий
+    void reset_stats() {
+        rotations.reset();
+    }
+
+    // Размер узла в байтах
+    static constexpr size_t node_bytes() {
+        return sizeof(Node);
+    }
+
+    // Неизменяемый снимок в раскладке Эйтцингера (определён в Eytzinger_Dictionary.h)
+    Eytzinger_Dictionary<Key, Value> freeze() const;
 };
\ No newline at end of file
@@ -0,0 +1,192 @@
+﻿// Small_Dictionary.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SMALL_DICTIONARY_SSE2 1
+#endif
+
+#include "Hash_Dictionary.h"
+#include "RB_Dictionary.h"
+
+// Нужно ли хранить встроенные пары отсортированными (чтобы for_each сохранял порядок дерева)
+template <typename Large>
+struct small_keeps_order : std::false_type {};
+
+template <typename Key, typename Value, typename Filter, bool Collect_Stats>
+struct small_keeps_order<RB_Dictionary<Key, Value, Filter, Collect_Stats>> : std::true_type {};
+
+//------------------------------------------------------------------------------------------------
+//  Словарь с режимом малого размера.
+//  Пока элементов не больше N, пары лежат прямо внутри объекта в плоских массивах и ищутся
+//  линейным проходом (для int — по 4 ключа за сравнение SSE2). Куча не используется вовсе:
+//  ни 16 корзин Dictionary, ни sentinel-узла RB_Dictionary. Когда пары перестают помещаться,
+//  словарь один раз переезжает в полноценный Large (Dictionary или RB_Dictionary).
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Large, size_t N = 8>
+class Small_Dictionary {
+    static_assert(N > 0, "Small_Dictionary: N должно быть положительным");
+
+    // Для поиска по 4 ключа место под ключи округляется вверх до кратного 4
+    static constexpr size_t key_slots = (N + 3) / 4 * 4;
+    static constexpr bool   ordered = small_keeps_order<Large>::value;
+
+    Key                    keys[key_slots];
+    Value                  values[N];
+    size_t                 count = 0;      // число встроенных пар
+    std::unique_ptr<Large> large;          // полноценный словарь после переезда
+
+    // Индекс встроенного ключа или N, если его нет
+    inline size_t index_of(const Key& key) const {
+#if defined(SMALL_DICTIONARY_SSE2)
+        if constexpr (std::is_same<Key, int>::value) {
+            const __m128i needle = _mm_set1_epi32(key);
+            for (size_t i = 0; i < count; i += 4) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                unsigned mask = static_cast<unsigned>(
+                    _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle))));
+                // Ячейки за пределами count не участвуют
+                if (count - i < 4) {
+                    mask &= (1u << (count - i)) - 1;
+                }
+                if (mask != 0) {
+                    unsigned lane = 0;
+                    while ((mask & 1u) == 0) {
+                        mask >>= 1;
+                        ++lane;
+                    }
+                    return i + lane;
+                }
+            }
+            return N;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i) {
+            if (keys[i] == key) {
+                return i;
+            }
+        }
+        return N;
+    }
+
+    // Переезд в полноценный словарь
+    void promote() {
+        large = std::make_unique<Large>();
+        for (size_t i = 0; i < count; ++i) {
+            large->insert(keys[i], values[i]);
+        }
+        count = 0;
+    }
+
+public:
+    Small_Dictionary() : keys(), values() {
+    }
+
+    Small_Dictionary(const Small_Dictionary&) = delete;
+    Small_Dictionary& operator=(const Small_Dictionary&) = delete;
+
+    // Вставка пары; true, если ключ новый
+    bool insert(const Key& key, const Value& value) {
+        if (large) {
+            size_t before = static_cast<size_t>(large->size());
+            large->insert(key, value);
+            return static_cast<size_t>(large->size()) != before;
+        }
+        size_t i = index_of(key);
+        if (i != N) {
+            values[i] = value;
+            return false;
+        }
+        if (count == N) {
+            promote();
+            large->insert(key, value);
+            return true;
+        }
+        // Для упорядоченного словаря сдвигаем большие ключи вправо
+        size_t pos = count;
+        if constexpr (ordered) {
+            while (pos > 0 && key < keys[pos - 1]) {
+                keys[pos] = std::move(keys[pos - 1]);
+                values[pos] = std::move(values[pos - 1]);
+                --pos;
+            }
+        }
+        keys[pos] = key;
+        values[pos] = value;
+        ++count;
+        return true;
+    }
+
+    Value* find(const Key& key) const {
+        if (large) {
+            return large->find(key);
+        }
+        size_t i = index_of(key);
+        return i != N ? const_cast<Value*>(&values[i]) : nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Удаление по ключу; true, если ключ был
+    bool erase(const Key& key) {
+        if (large) {
+            size_t before = static_cast<size_t>(large->size());
+            large->erase(key);
+            return static_cast<size_t>(large->size()) != before;
+        }
+        size_t i = index_of(key);
+        if (i == N) {
+            return false;
+        }
+        // Сдвиг хвоста сохраняет порядок встроенных пар
+        for (size_t j = i + 1; j < count; ++j) {
+            keys[j - 1] = std::move(keys[j]);
+            values[j - 1] = std::move(values[j]);
+        }
+        --count;
+        keys[count] = Key();
+        values[count] = Value();
+        return true;
+    }
+
+    // Очистка возвращает словарь во встроенный режим
+    void clear() {
+        large.reset();
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = Key();
+            values[i] = Value();
+        }
+        count = 0;
+    }
+
+    size_t size() const {
+        return large ? static_cast<size_t>(large->size()) : count;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Находится ли словарь ещё во встроенном режиме
+    bool is_inline() const {
+        return !large;
+    }
+
+    template <typename Func>
+    void for_each(Func func) const {
+        if (large) {
+            large->for_each(func);
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            func(keys[i], values[i]);
+        }
+    }
+};
@@ -0,0 +1,454 @@
+﻿// Split_Dictionary.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Membership_Filter.h"   // membership_hash()
+
+//------------------------------------------------------------------------------------------------
+//  Словари с раздельным хранением ключей и значений («структура массивов»).
+//
+//  В Chain и RB_Dictionary::Node ключ, значение и указатели лежат рядом, поэтому поиск,
+//  которому нужны только ключи, тянет в кэш и байты значений. Здесь элемент — это номер
+//  слота: ключ и служебные поля (ссылки, цвет) лежат в плотном «горячем» массиве,
+//  значение — в параллельном «холодном» массиве под тем же номером. Сравнения при поиске
+//  трогают только горячий массив; значение читается один раз, когда ключ найден.
+//  Выигрыш растёт с размером значения: при значениях в сотни байт узел обычного словаря
+//  занимает несколько строк кэша, а горячая запись — 16-48 байт.
+//
+//  Ссылки — 32-битные номера слотов вместо указателей. Освобождённые слоты
+//  переиспользуются (список свободных слотов идёт через поле ссылки).
+//  Указатель, возвращённый find(), действителен до следующей вставки.
+//------------------------------------------------------------------------------------------------
+
+namespace split_detail {
+    constexpr uint32_t NONE = UINT32_MAX;
+}
+
+//------------------------------------------------------------------------------------------------
+//  Хэш-таблица с цепочками по номерам слотов
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value>
+class Split_Hash_Dictionary {
+    static constexpr uint32_t NONE = split_detail::NONE;
+
+    // Горячая часть элемента: ключ и следующий слот цепочки
+    struct Hot {
+        Key      key;
+        uint32_t next;
+    };
+
+    std::vector<uint32_t> buckets;     // первый слот цепочки каждой корзины
+    std::vector<Hot>      hot;         // ключи и ссылки
+    std::vector<Value>    values;      // значения по тем же номерам слотов
+    uint32_t              free_slot = NONE;
+    size_t                count = 0;
+    float                 max_load_factor = 0.75f;
+
+    size_t bucket_of(const Key& key) const {
+        return static_cast<size_t>(membership_hash(key)) & (buckets.size() - 1);
+    }
+
+    void grow() {
+        std::vector<uint32_t> old(buckets.size() * 2, NONE);
+        old.swap(buckets);
+        for (uint32_t head : old) {
+            while (head != NONE) {
+                uint32_t next = hot[head].next;
+                size_t index = bucket_of(hot[head].key);
+                hot[head].next = buckets[index];
+                buckets[index] = head;
+                head = next;
+            }
+        }
+    }
+
+    uint32_t find_slot(const Key& key) const {
+        for (uint32_t slot = buckets[bucket_of(key)]; slot != NONE; slot = hot[slot].next) {
+            if (hot[slot].key == key) {
+                return slot;
+            }
+        }
+        return NONE;
+    }
+
+public:
+    Split_Hash_Dictionary() : buckets(16, NONE) {
+    }
+
+    // Возвращает true, если ключ новый; иначе обновляет значение
+    bool insert(const Key& key, const Value& value) {
+        uint32_t slot = find_slot(key);
+        if (slot != NONE) {
+            values[slot] = value;
+            return false;
+        }
+        if (count >= buckets.size() * max_load_factor) {
+            grow();
+        }
+        size_t index = bucket_of(key);
+        if (free_slot != NONE) {
+            slot = free_slot;
+            free_slot = hot[slot].next;
+            hot[slot].key = key;
+            values[slot] = value;
+        }
+        else {
+            slot = static_cast<uint32_t>(hot.size());
+            hot.push_back({ key, NONE });
+            values.push_back(value);
+        }
+        hot[slot].next = buckets[index];
+        buckets[index] = slot;
+        ++count;
+        return true;
+    }
+
+    Value* find(const Key& key) {
+        uint32_t slot = find_slot(key);
+        return slot == NONE ? nullptr : &values[slot];
+    }
+
+    const Value* find(const Key& key) const {
+        uint32_t slot = find_slot(key);
+        return slot == NONE ? nullptr : &values[slot];
+    }
+
+    bool contains(const Key& key) const {
+        return find_slot(key) != NONE;
+    }
+
+    bool erase(const Key& key) {
+        uint32_t* link = &buckets[bucket_of(key)];
+        while (*link != NONE) {
+            uint32_t slot = *link;
+            if (hot[slot].key == key) {
+                *link = hot[slot].next;
+                hot[slot].next = free_slot;
+                free_slot = slot;
+                --count;
+                return true;
+            }
+            link = &hot[slot].next;
+        }
+        return false;
+    }
+
+    void clear() {
+        buckets.assign(16, NONE);
+        hot.clear();
+        values.clear();
+        free_slot = NONE;
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Обход всех пар (порядок не определён)
+    template <typename Func>
+    void for_each(Func func) const {
+        for (uint32_t head : buckets) {
+            for (uint32_t slot = head; slot != NONE; slot = hot[slot].next) {
+                func(hot[slot].key, values[slot]);
+            }
+        }
+    }
+
+    // Размер горячей записи в байтах
+    static constexpr size_t hot_bytes() {
+        return sizeof(Hot);
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+//  Красно-чёрное дерево на номерах слотов с балансировкой сверху вниз (как в
+//  Top_Down_Dictionary.h): без ссылки на родителя горячая запись для int-ключа — 16 байт.
+//  Слот 0 — фиктивная голова дерева (её правый потомок — корень), поэтому Key и Value
+//  должны конструироваться по умолчанию.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value>
+class Split_RB_Dictionary {
+    static constexpr uint32_t NONE = split_detail::NONE;
+    static constexpr uint32_t HEAD = 0;
+
+    // Горячая часть узла: ключ, потомки и цвет
+    struct Hot {
+        Key      key;
+        uint32_t link[2];
+        bool     red;
+    };
+
+    std::vector<Hot>   hot;
+    std::vector<Value> values;
+    uint32_t           free_slot = NONE;   // свободные слоты, связанные через link[0]
+    size_t             count = 0;
+
+    bool is_red(uint32_t x) const {
+        return x != NONE && hot[x].red;
+    }
+
+    bool same(const Key& a, const Key& b) const {
+        return !(a < b) && !(b < a);
+    }
+
+    uint32_t rotate(uint32_t x, int dir) {
+        uint32_t save = hot[x].link[!dir];
+        hot[x].link[!dir] = hot[save].link[dir];
+        hot[save].link[dir] = x;
+        hot[x].red = true;
+        hot[save].red = false;
+        return save;
+    }
+
+    uint32_t rotate_double(uint32_t x, int dir) {
+        hot[x].link[!dir] = rotate(hot[x].link[!dir], !dir);
+        return rotate(x, dir);
+    }
+
+    uint32_t create_slot(const Key& key, const Value& value) {
+        if (free_slot != NONE) {
+            uint32_t slot = free_slot;
+            free_slot = hot[slot].link[0];
+            hot[slot] = { key, { NONE, NONE }, true };
+            values[slot] = value;
+            return slot;
+        }
+        hot.push_back({ key, { NONE, NONE }, true });
+        values.push_back(value);
+        return static_cast<uint32_t>(hot.size() - 1);
+    }
+
+    void free_slot_at(uint32_t slot) {
+        hot[slot].link[0] = free_slot;
+        free_slot = slot;
+    }
+
+    uint32_t root() const {
+        return hot[HEAD].link[1];
+    }
+
+    uint32_t find_slot(const Key& key) const {
+        uint32_t x = root();
+        while (x != NONE) {
+            const Key& current = hot[x].key;
+            if (key < current) {
+                x = hot[x].link[0];
+            }
+            else if (current < key) {
+                x = hot[x].link[1];
+            }
+            else {
+                return x;
+            }
+        }
+        return NONE;
+    }
+
+public:
+    Split_RB_Dictionary() {
+        clear();
+    }
+
+    // Возвращает true, если ключ новый; иначе обновляет значение
+    bool insert(const Key& key, const Value& value) {
+        if (root() == NONE) {
+            uint32_t slot = create_slot(key, value);
+            hot[slot].red = false;
+            hot[HEAD].link[1] = slot;
+            ++count;
+            return true;
+        }
+
+        uint32_t t = HEAD, g = NONE, p = NONE, q = root();
+        int dir = 0, last = 0;
+        bool inserted = false;
+
+        while (true) {
+            if (q == NONE) {
+                q = create_slot(key, value);
+                hot[p].link[dir] = q;
+                inserted = true;
+            }
+            else if (is_red(hot[q].link[0]) && is_red(hot[q].link[1])) {
+                hot[q].red = true;
+                hot[hot[q].link[0]].red = false;
+                hot[hot[q].link[1]].red = false;
+            }
+
+            if (is_red(q) && is_red(p)) {
+                int dir2 = hot[t].link[1] == g;
+                if (q == hot[p].link[last]) {
+                    hot[t].link[dir2] = rotate(g, !last);
+                }
+                else {
+                    hot[t].link[dir2] = rotate_double(g, !last);
+                }
+            }
+
+            if (same(hot[q].key, key)) {
+                if (!inserted) {
+                    values[q] = value;
+                }
+                break;
+            }
+
+            last = dir;
+            dir = hot[q].key < key;
+            if (g != NONE) {
+                t = g;
+            }
+            g = p;
+            p = q;
+            q = hot[q].link[dir];
+        }
+
+        hot[root()].red = false;
+        count += inserted;
+        return inserted;
+    }
+
+    bool erase(const Key& key) {
+        if (root() == NONE) {
+            return false;
+        }
+
+        uint32_t q = HEAD, p = NONE, g = NONE, found = NONE;
+        int dir = 1;
+
+        while (hot[q].link[dir] != NONE) {
+            int last = dir;
+            g = p;
+            p = q;
+            q = hot[q].link[dir];
+            dir = hot[q].key < key;
+            if (same(hot[q].key, key)) {
+                found = q;
+            }
+
+            if (!is_red(q) && !is_red(hot[q].link[dir])) {
+                if (is_red(hot[q].link[!dir])) {
+                    uint32_t top = rotate(q, dir);
+                    hot[p].link[last] = top;
+                    p = top;
+                }
+                else {
+                    uint32_t s = hot[p].link[!last];
+                    if (s != NONE) {
+                        if (!is_red(hot[s].link[!last]) && !is_red(hot[s].link[last])) {
+                            hot[p].red = false;
+                            hot[s].red = true;
+                            hot[q].red = true;
+                        }
+                        else {
+                            int dir2 = hot[g].link[1] == p;
+                            uint32_t top = is_red(hot[s].link[last]) ? rotate_double(p, last) : rotate(p, last);
+                            hot[g].link[dir2] = top;
+                            hot[q].red = hot[top].red = true;
+                            hot[hot[top].link[0]].red = false;
+                            hot[hot[top].link[1]].red = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (found != NONE) {
+            if (found != q) {
+                hot[found].key = std::move(hot[q].key);
+                values[found] = std::move(values[q]);
+            }
+            hot[p].link[hot[p].link[1] == q] = hot[q].link[hot[q].link[0] == NONE];
+            free_slot_at(q);
+            --count;
+        }
+
+        if (root() != NONE) {
+            hot[root()].red = false;
+        }
+        return found != NONE;
+    }
+
+    Value* find(const Key& key) {
+        uint32_t slot = find_slot(key);
+        return slot == NONE ? nullptr : &values[slot];
+    }
+
+    const Value* find(const Key& key) const {
+        uint32_t slot = find_slot(key);
+        return slot == NONE ? nullptr : &values[slot];
+    }
+
+    bool contains(const Key& key) const {
+        return find_slot(key) != NONE;
+    }
+
+    void clear() {
+        hot.assign(1, Hot{ Key(), { NONE, NONE }, false });
+        values.assign(1, Value());
+        free_slot = NONE;
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Симметричный обход: вызывает func(key, value) в порядке возрастания ключей
+    template <typename Func>
+    void for_each(Func func) const {
+        std::vector<uint32_t> stack;
+        uint32_t curr = root();
+        while (curr != NONE || !stack.empty()) {
+            while (curr != NONE) {
+                stack.push_back(curr);
+                curr = hot[curr].link[0];
+            }
+            curr = stack.back();
+            stack.pop_back();
+            func(hot[curr].key, values[curr]);
+            curr = hot[curr].link[1];
+        }
+    }
+
+    // Высота дерева (число узлов на самом длинном пути), для проверки балансировки
+    size_t height() const {
+        struct Item {
+            uint32_t node;
+            size_t   depth;
+        };
+        std::vector<Item> stack;
+        size_t result = 0;
+        if (root() != NONE) {
+            stack.push_back({ root(), 1 });
+        }
+        while (!stack.empty()) {
+            Item item = stack.back();
+            stack.pop_back();
+            result = item.depth > result ? item.depth : result;
+            for (uint32_t child : hot[item.node].link) {
+                if (child != NONE) {
+                    stack.push_back({ child, item.depth + 1 });
+                }
+            }
+        }
+        return result;
+    }
+
+    // Размер горячей записи в байтах
+    static constexpr size_t hot_bytes() {
+        return sizeof(Hot);
+    }
+};
@@ -0,0 +1,362 @@
+﻿// Top_Down_Dictionary.h
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Container_Stats.h"   // для stats()
+
+//------------------------------------------------------------------------------------------------
+//  Красно-чёрное дерево с балансировкой сверху вниз (top-down, схема Гибаса–Седжвика
+//  в изложении Дж. Уокера).
+//
+//  В отличие от RB_Dictionary, вставка и удаление исправляют цвета и делают повороты
+//  за один проход от корня к листу: опасные ситуации устраняются заранее, по дороге вниз,
+//  поэтому возвращаться к корню не нужно. Отсюда:
+//    - у узла нет указателя на родителя — узел меньше на 8 байт (на 64-битной платформе);
+//    - нет sentinel-узла nil в куче: пустой потомок — nullptr;
+//    - поворот меняет два указателя вместо шести, обхода вверх с записью в родителей нет.
+//  Обход и очистка идут с явным стеком.
+//
+//  Освобождённые узлы переиспользуются, как в RB_Dictionary, но список свободных узлов
+//  хранится в самих узлах (через link[0]), а не в отдельном векторе указателей.
+//------------------------------------------------------------------------------------------------
+
+template <typename Key, typename Value>
+class Top_Down_RB_Dictionary {
+private:
+    // Ссылки на потомков и цвет; отдельно от ключа, чтобы фиктивная голова дерева
+    // при вставке и удалении не требовала конструкторов Key и Value
+    struct Links {
+        Links* link[2] = { nullptr, nullptr };   // [0] — левый, [1] — правый потомок
+        bool   red = true;
+    };
+
+    struct Node : Links {
+        Key   key;
+        Value value;
+
+        Node(const Key& k, const Value& v) : key(k), value(v) {
+        }
+    };
+
+    Links* root = nullptr;
+    Links* free_list = nullptr;   // освобождённые узлы, связанные через link[0]
+    size_t node_count = 0;
+    size_t free_count = 0;
+
+    static Node* node(Links* x) {
+        return static_cast<Node*>(x);
+    }
+
+    static bool is_red(const Links* x) {
+        return x != nullptr && x->red;
+    }
+
+    // Создаёт красный узел: из списка свободных или через new
+    Node* create_node(const Key& key, const Value& value) {
+        if (free_list != nullptr) {
+            Node* x = node(free_list);
+            free_list = free_list->link[0];
+            --free_count;
+            x->key = key;
+            x->value = value;
+            x->link[0] = x->link[1] = nullptr;
+            x->red = true;
+            return x;
+        }
+        return new Node(key, value);
+    }
+
+    void destroy_node(Links* x) {
+        x->link[0] = free_list;
+        free_list = x;
+        ++free_count;
+    }
+
+    // Поворот в сторону dir: потомок с противоположной стороны становится корнем поддерева
+    static Links* rotate(Links* x, int dir) {
+        Links* save = x->link[!dir];
+        x->link[!dir] = save->link[dir];
+        save->link[dir] = x;
+        x->red = true;
+        save->red = false;
+        return save;
+    }
+
+    static Links* rotate_double(Links* x, int dir) {
+        x->link[!dir] = rotate(x->link[!dir], !dir);
+        return rotate(x, dir);
+    }
+
+public:
+    Top_Down_RB_Dictionary() = default;
+
+    ~Top_Down_RB_Dictionary() {
+        clear();
+        while (free_list != nullptr) {
+            Links* next = free_list->link[0];
+            delete node(free_list);
+            free_list = next;
+        }
+    }
+
+    Top_Down_RB_Dictionary(const Top_Down_RB_Dictionary&) = delete;
+    Top_Down_RB_Dictionary& operator=(const Top_Down_RB_Dictionary&) = delete;
+
+    // Возвращает true, если ключ новый; иначе обновляет значение
+    bool insert(const Key& key, const Value& value) {
+        if (root == nullptr) {
+            root = create_node(key, value);
+            root->red = false;
+            ++node_count;
+            return true;
+        }
+
+        Links head;                 // фиктивная голова: корень — её правый потомок
+        Links* t = &head;           // прадед
+        Links* g = nullptr;         // дед
+        Links* p = nullptr;         // родитель
+        Links* q = root;            // текущий узел
+        int dir = 0, last = 0;
+        bool inserted = false;
+        head.link[1] = root;
+
+        while (true) {
+            if (q == nullptr) {
+                // Новый красный лист
+                p->link[dir] = q = create_node(key, value);
+                inserted = true;
+            }
+            else if (is_red(q->link[0]) && is_red(q->link[1])) {
+                // Смена цветов: у чёрного узла два красных потомка
+                q->red = true;
+                q->link[0]->red = false;
+                q->link[1]->red = false;
+            }
+
+            // Два красных подряд устраняются поворотом вокруг деда
+            if (is_red(q) && is_red(p)) {
+                int dir2 = t->link[1] == g;
+                if (q == p->link[last]) {
+                    t->link[dir2] = rotate(g, !last);
+                }
+                else {
+                    t->link[dir2] = rotate_double(g, !last);
+                }
+            }
+
+            const Key& current = node(q)->key;
+            if (!(current < key) && !(key < current)) {
+                if (!inserted) {
+                    node(q)->value = value;
+                }
+                break;
+            }
+
+            last = dir;
+            dir = current < key;
+            if (g != nullptr) {
+                t = g;
+            }
+            g = p;
+            p = q;
+            q = q->link[dir];
+        }
+
+        root = head.link[1];
+        root->red = false;
+        node_count += inserted;
+        return inserted;
+    }
+
+    // Удаление за один проход: по дороге вниз текущий узел делается красным, поэтому
+    // удалить лист можно без исправлений снизу. Найденный узел получает пару
+    // из последнего узла пути (предыдущего по порядку: после совпадения спуск идёт влево,
+    // затем до конца вправо), а удаляется этот последний узел.
+    bool erase(const Key& key) {
+        if (root == nullptr) {
+            return false;
+        }
+
+        Links head;
+        Links* q = &head;
+        Links* p = nullptr;
+        Links* g = nullptr;
+        Node* found = nullptr;
+        int dir = 1;
+        head.link[1] = root;
+
+        while (q->link[dir] != nullptr) {
+            int last = dir;
+            g = p;
+            p = q;
+            q = q->link[dir];
+            const Key& current = node(q)->key;
+            dir = current < key;
+            if (!(current < key) && !(key < current)) {
+                found = node(q);
+            }
+
+            // Проталкиваем красный цвет вниз
+            if (!is_red(q) && !is_red(q->link[dir])) {
+                if (is_red(q->link[!dir])) {
+                    p = p->link[last] = rotate(q, dir);
+                }
+                else {
+                    Links* s = p->link[!last];
+                    if (s != nullptr) {
+                        if (!is_red(s->link[!last]) && !is_red(s->link[last])) {
+                            // Смена цветов
+                            p->red = false;
+                            s->red = true;
+                            q->red = true;
+                        }
+                        else {
+                            int dir2 = g->link[1] == p;
+                            if (is_red(s->link[last])) {
+                                g->link[dir2] = rotate_double(p, last);
+                            }
+                            else {
+                                g->link[dir2] = rotate(p, last);
+                            }
+                            // Восстанавливаем цвета после поворота
+                            q->red = g->link[dir2]->red = true;
+                            g->link[dir2]->link[0]->red = false;
+                            g->link[dir2]->link[1]->red = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (found != nullptr) {
+            if (found != q) {
+                found->key = std::move(node(q)->key);
+                found->value = std::move(node(q)->value);
+            }
+            p->link[p->link[1] == q] = q->link[q->link[0] == nullptr];
+            destroy_node(q);
+            --node_count;
+        }
+
+        root = head.link[1];
+        if (root != nullptr) {
+            root->red = false;
+        }
+        return found != nullptr;
+    }
+
+    Value* find(const Key& key) const {
+        Links* x = root;
+        while (x != nullptr) {
+            const Key& current = node(x)->key;
+            if (key < current) {
+                x = x->link[0];
+            }
+            else if (current < key) {
+                x = x->link[1];
+            }
+            else {
+                return &node(x)->value;
+            }
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    Value& operator[](const Key& key) {
+        if (Value* value = find(key)) {
+            return *value;
+        }
+        insert(key, Value());
+        return *find(key);
+    }
+
+    void clear() {
+        if (root == nullptr) {
+            return;
+        }
+        std::vector<Links*> stack;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            Links* curr = stack.back();
+            stack.pop_back();
+            if (curr->link[0] != nullptr) stack.push_back(curr->link[0]);
+            if (curr->link[1] != nullptr) stack.push_back(curr->link[1]);
+            destroy_node(curr);
+        }
+        root = nullptr;
+        node_count = 0;
+    }
+
+    size_t size() const {
+        return node_count;
+    }
+
+    bool empty() const {
+        return node_count == 0;
+    }
+
+    // Симметричный обход: вызывает func(key, value) для всех пар в порядке возрастания ключей
+    template <typename Func>
+    void for_each(Func func) const {
+        std::vector<Links*> stack;
+        Links* curr = root;
+        while (curr != nullptr || !stack.empty()) {
+            while (curr != nullptr) {
+                stack.push_back(curr);
+                curr = curr->link[0];
+            }
+            curr = stack.back();
+            stack.pop_back();
+            func(node(curr)->key, node(curr)->value);
+            curr = curr->link[1];
+        }
+    }
+
+    // Снимок внутреннего устройства дерева (обходит все узлы, O(n)); поворотов не считает
+    RB_Stats stats() const {
+        RB_Stats result;
+        result.element_count = node_count;
+        result.pool_free = free_count;
+        result.bytes = sizeof(*this) + (node_count + free_count) * sizeof(Node);
+
+        struct Item {
+            Links* node;
+            size_t depth;
+            size_t blacks;
+        };
+        std::vector<Item> stack;
+        size_t depth_sum = 0;
+        if (root != nullptr) {
+            stack.push_back({ root, 1, 1 });
+        }
+        while (!stack.empty()) {
+            Item item = stack.back();
+            stack.pop_back();
+            depth_sum += item.depth;
+            result.height = std::max(result.height, item.depth);
+            if (item.node->link[0] == nullptr || item.node->link[1] == nullptr) {
+                result.black_height = item.blacks;
+            }
+            for (Links* child : { item.node->link[0], item.node->link[1] }) {
+                if (child != nullptr) {
+                    stack.push_back({ child, item.depth + 1, item.blacks + !child->red });
+                }
+            }
+        }
+        result.average_depth = node_count ? double(depth_sum) / double(node_count) : 0;
+        return result;
+    }
+
+    // Размер узла в байтах (для сравнения с RB_Dictionary)
+    static constexpr size_t node_bytes() {
+        return sizeof(Node);
+    }
+};
@@ -0,0 +1,319 @@
+﻿// Trace_Dictionary.h
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Binary_Stream.h"
+
+//------------------------------------------------------------------------------------------------
+//  Запись и воспроизведение трасс операций над словарём.
+//
+//  Traced_Dictionary пропускает insert/find/erase к настоящему словарю и записывает каждую
+//  операцию с её результатом в двоичную трассу. Трассу потом можно прогнать на любом словаре
+//  (replay_trace / apply_trace_op) и сравнить результаты: расхождение означает, что словарь
+//  ведёт себя иначе, чем тот, на котором трасса записана.
+//
+//  Формат — поток Binary_Stream.h с видом BINARY_TRACE (поле числа пар равно 0: число
+//  операций заранее неизвестно). После заголовка — вид ключа и размеры ключа и значения,
+//  затем записи:
+//      [байт: вид операции в битах 0-1, результат в бите 2][ключ][значение — только у вставки]
+//  Целые ключи хранятся как varint разности с предыдущим ключом (в зигзаг-кодировании),
+//  поэтому последовательные и близкие ключи занимают 1-2 байта. Разность считается по модулю
+//  2^64 (беззнаковая арифметика), так что переполнения нет при любых 64-битных ключах.
+//  Строки — varint-длина и байты.
+//  Трасса завершается записью TRACE_END.
+//------------------------------------------------------------------------------------------------
+
+enum Trace_Kind : uint8_t { TRACE_INSERT = 0, TRACE_FIND = 1, TRACE_ERASE = 2, TRACE_END = 3 };
+enum Trace_Key_Kind : uint8_t { TRACE_KEY_INTEGER = 1, TRACE_KEY_STRING = 2, TRACE_KEY_RAW = 3 };
+
+// Одна операция трассы. result: вставка — ключ был новым, поиск — найден, удаление — удалён
+template <typename Key, typename Value>
+struct Trace_Op {
+    Trace_Kind kind = TRACE_FIND;
+    bool       result = false;
+    Key        key{};
+    Value      value{};
+};
+
+namespace trace_detail {
+
+    template <typename Key>
+    constexpr Trace_Key_Kind key_kind() {
+        if constexpr (std::is_integral<Key>::value) {
+            return TRACE_KEY_INTEGER;
+        }
+        else if constexpr (std::is_same<Key, std::string>::value) {
+            return TRACE_KEY_STRING;
+        }
+        else {
+            return TRACE_KEY_RAW;
+        }
+    }
+
+    // Размер типа в заголовке; у строк — 0
+    template <typename T>
+    constexpr uint8_t type_size() {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return 0;
+        }
+        else {
+            return static_cast<uint8_t>(sizeof(T));
+        }
+    }
+
+    inline uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+}
+
+template <typename Key, typename Value>
+class Trace_Writer {
+    Binary_Writer writer;
+    uint64_t      previous_key = 0;
+    uint64_t      operations = 0;
+    bool          finished = false;
+
+public:
+    explicit Trace_Writer(std::ostream& out) : writer(out) {
+        writer.write_header(BINARY_TRACE, 0);
+        uint8_t layout[3] = { trace_detail::key_kind<Key>(), trace_detail::type_size<Key>(),
+                              trace_detail::type_size<Value>() };
+        writer.write_bytes(layout, sizeof(layout));
+    }
+
+    ~Trace_Writer() {
+        finish();
+    }
+
+    Trace_Writer(const Trace_Writer&) = delete;
+    Trace_Writer& operator=(const Trace_Writer&) = delete;
+
+    void record(Trace_Kind kind, const Key& key, const Value* value, bool result) {
+        uint8_t head = static_cast<uint8_t>(kind | (result ? 4 : 0));
+        writer.write_bytes(&head, 1);
+        if constexpr (std::is_integral<Key>::value) {
+            uint64_t current = static_cast<uint64_t>(key);
+            writer.write_varint(trace_detail::zigzag(static_cast<int64_t>(current - previous_key)));
+            previous_key = current;
+        }
+        else {
+            writer.write(key);
+        }
+        if (kind == TRACE_INSERT) {
+            writer.write(*value);
+        }
+        ++operations;
+    }
+
+    uint64_t count() const {
+        return operations;
+    }
+
+    // Завершает трассу; повторные вызовы ничего не делают
+    bool finish() {
+        if (finished) {
+            return true;
+        }
+        finished = true;
+        uint8_t end = TRACE_END;
+        writer.write_bytes(&end, 1);
+        return writer.finish();
+    }
+};
+
+template <typename Key, typename Value>
+class Trace_Reader {
+    Binary_Reader reader;
+    uint64_t      previous_key = 0;
+    bool          opened = false;
+    bool          ended = false;
+
+public:
+    explicit Trace_Reader(std::istream& in) : reader(in) {
+    }
+
+    // Проверяет заголовок и совпадение типов ключа и значения с записанными
+    bool open() {
+        uint64_t unused = 0;
+        uint8_t layout[3] = {};
+        opened = reader.read_header(BINARY_TRACE, unused) && reader.read_bytes(layout, sizeof(layout)) &&
+            layout[0] == trace_detail::key_kind<Key>() && layout[1] == trace_detail::type_size<Key>() &&
+            layout[2] == trace_detail::type_size<Value>();
+        return opened;
+    }
+
+    // Следующая операция; false в конце трассы или при ошибке (см. finish())
+    bool next(Trace_Op<Key, Value>& op) {
+        if (!opened || ended) {
+            return false;
+        }
+        uint8_t head = 0;
+        if (!reader.read_bytes(&head, 1)) {
+            return false;
+        }
+        op.kind = static_cast<Trace_Kind>(head & 3);
+        op.result = (head & 4) != 0;
+        if (op.kind == TRACE_END) {
+            ended = true;
+            return false;
+        }
+        if constexpr (std::is_integral<Key>::value) {
+            uint64_t delta = 0;
+            if (!reader.read_varint(delta)) {
+                return false;
+            }
+            previous_key += static_cast<uint64_t>(trace_detail::unzigzag(delta));
+            op.key = static_cast<Key>(previous_key);
+        }
+        else if (!reader.read(op.key)) {
+            return false;
+        }
+        if (op.kind == TRACE_INSERT && !reader.read(op.value)) {
+            return false;
+        }
+        return true;
+    }
+
+    // true, если трасса дочитана до TRACE_END и контрольная сумма совпала
+    bool finish() {
+        return ended && reader.finish();
+    }
+};
+
+// Загружает трассу целиком, чтобы при воспроизведении не тратить время на чтение
+template <typename Key, typename Value>
+bool load_trace(std::istream& in, std::vector<Trace_Op<Key, Value>>& ops) {
+    ops.clear();
+    Trace_Reader<Key, Value> reader(in);
+    if (!reader.open()) {
+        return false;
+    }
+    Trace_Op<Key, Value> op;
+    while (reader.next(op)) {
+        ops.push_back(op);
+    }
+    return reader.finish();
+}
+
+// Выполняет операцию трассы на любом словаре (проекта или std) и возвращает её результат.
+// Результат вставки и удаления определяется по изменению размера: так одинаково работают
+// словари, у которых insert/erase ничего не возвращают.
+template <typename DictionaryType, typename Key, typename Value>
+inline bool apply_trace_op(DictionaryType& dict, const Trace_Op<Key, Value>& op) {
+    switch (op.kind) {
+    case TRACE_INSERT: {
+        size_t before = static_cast<size_t>(dict.size());
+        if constexpr (std::is_pointer<decltype(dict.find(op.key))>::value) {
+            dict.insert(op.key, op.value);
+        }
+        else {
+            dict[op.key] = op.value;
+        }
+        return static_cast<size_t>(dict.size()) != before;
+    }
+    case TRACE_FIND:
+        if constexpr (std::is_pointer<decltype(dict.find(op.key))>::value) {
+            return dict.find(op.key) != nullptr;
+        }
+        else {
+            return dict.find(op.key) != dict.end();
+        }
+    case TRACE_ERASE: {
+        size_t before = static_cast<size_t>(dict.size());
+        dict.erase(op.key);
+        return static_cast<size_t>(dict.size()) != before;
+    }
+    default:
+        return false;
+    }
+}
+
+// Итог воспроизведения: число операций и расхождений с записанными результатами
+struct Replay_Result {
+    size_t operations = 0;
+    size_t divergences = 0;
+    size_t first_divergence = 0;   // номер первой расходящейся операции (если divergences > 0)
+};
+
+template <typename DictionaryType, typename Key, typename Value>
+Replay_Result replay_trace(DictionaryType& dict, const std::vector<Trace_Op<Key, Value>>& ops) {
+    Replay_Result result;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        if (apply_trace_op(dict, ops[i]) != ops[i].result) {
+            if (result.divergences++ == 0) {
+                result.first_divergence = i;
+            }
+        }
+    }
+    result.operations = ops.size();
+    return result;
+}
+
+//------------------------------------------------------------------------------------------------
+//  Словарь с записью трассы: все операции передаются Engine и записываются в поток.
+//  Поток должен жить дольше обёртки; трасса завершается в finish() или в деструкторе.
+//------------------------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Engine>
+class Traced_Dictionary {
+    Engine                   dict;
+    Trace_Writer<Key, Value> trace;
+
+public:
+    explicit Traced_Dictionary(std::ostream& out) : trace(out) {
+    }
+
+    Traced_Dictionary(const Traced_Dictionary&) = delete;
+    Traced_Dictionary& operator=(const Traced_Dictionary&) = delete;
+
+    void insert(const Key& key, const Value& value) {
+        size_t before = static_cast<size_t>(dict.size());
+        dict.insert(key, value);
+        trace.record(TRACE_INSERT, key, &value, static_cast<size_t>(dict.size()) != before);
+    }
+
+    Value* find(const Key& key) {
+        Value* found = dict.find(key);
+        trace.record(TRACE_FIND, key, nullptr, found != nullptr);
+        return found;
+    }
+
+    bool contains(const Key& key) {
+        return find(key) != nullptr;
+    }
+
+    bool erase(const Key& key) {
+        size_t before = static_cast<size_t>(dict.size());
+        dict.erase(key);
+        bool erased = static_cast<size_t>(dict.size()) != before;
+        trace.record(TRACE_ERASE, key, nullptr, erased);
+        return erased;
+    }
+
+    size_t size() {
+        return static_cast<size_t>(dict.size());
+    }
+
+    uint64_t recorded() const {
+        return trace.count();
+    }
+
+    bool finish() {
+        return trace.finish();
+    }
+
+    // Доступ к словарю в обход записи
+    Engine& engine() {
+        return dict;
+    }
+};
@@ -0,0 +1,190 @@
+"""Сравнение двух наборов результатов Experiment_C++ (results_*.json).
+
+Каждая сторона может состоять из нескольких прогонов: повторы одного показателя
+(контейнер, набор ключей, операция, размер) объединяются. Замедление считается
+значимым, если одновременно:
+  * медиана выросла больше порога, который не меньше --threshold, двух
+    относительных разбросов повторов базовой стороны (1.4826 * MAD / медиана)
+    и двух относительных разбросов медиан отдельных прогонов на каждой стороне
+    (шум между запусками обычно больше шума внутри одного запуска, поэтому
+    на каждую сторону стоит давать хотя бы два прогона);
+  * критерий Манна-Уитни отвергает равенство распределений на уровне --alpha.
+Показатели с одним замером (память, число выделений) детерминированы и
+сравниваются только по порогу.
+
+Пример:
+    python compare_results.py --base old/results_*.json --new new/results_*.json
+Код возврата 1, если найдено хотя бы одно значимое замедление.
+"""
+import argparse
+import json
+import math
+import sys
+from collections import defaultdict
+
+
+def load_results(paths):
+    """Собирает повторы одинаковых показателей: для каждого ключа — список прогонов."""
+    runs = defaultdict(list)
+    environments = []
+    for path in paths:
+        with open(path, 'r', encoding='utf-8') as f:
+            data = json.load(f)
+        environments.append(data.get('environment', {}))
+        for r in data.get('results', []):
+            key = (r['benchmark'], r['container'], r['dataset'], r['operation'], r['size'], r['unit'])
+            if r['samples']:
+                runs[key].append(r['samples'])
+    return runs, environments
+
+
+def median(values):
+    ordered = sorted(values)
+    n = len(ordered)
+    mid = n // 2
+    return ordered[mid] if n % 2 else (ordered[mid - 1] + ordered[mid]) / 2
+
+
+def relative_spread(values):
+    """Устойчивая оценка относительного разброса: 1.4826 * MAD / медиана."""
+    m = median(values)
+    if m == 0 or len(values) < 2:
+        return 0.0
+    mad = median([abs(v - m) for v in values])
+    return 1.4826 * mad / abs(m)
+
+
+def mann_whitney_p(a, b):
+    """Двусторонний p-уровень критерия Манна-Уитни.
+
+    Для малых выборок без совпадений — точное распределение U,
+    иначе — нормальное приближение с поправкой на совпадения.
+    """
+    n1, n2 = len(a), len(b)
+    combined = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    ranks = [0.0] * len(combined)
+    tie_term = 0.0
+    i = 0
+    while i < len(combined):
+        j = i
+        while j + 1 < len(combined) and combined[j + 1][0] == combined[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+    rank_sum = sum(r for r, (_, side) in zip(ranks, combined) if side == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2
+    u_low = min(u, n1 * n2 - u)
+
+    if tie_term == 0 and n1 * n2 <= 400:
+        # counts[k] — число способов получить U = k (рекуррентно по размерам выборок)
+        counts = exact_u_counts(n1, n2)
+        total = sum(counts)
+        tail = sum(counts[:int(u_low) + 1])
+        return min(1.0, 2 * tail / total)
+
+    n = n1 + n2
+    mean = n1 * n2 / 2
+    variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (abs(u - mean) - 0.5) / math.sqrt(variance)
+    return min(1.0, math.erfc(max(z, 0) / math.sqrt(2)))
+
+
+def exact_u_counts(n1, n2):
+    """Распределение статистики U для выборок размеров n1 и n2 без совпадений."""
+    # table[i][j] — список частот U для выборок размеров i и j
+    table = [[None] * (n2 + 1) for _ in range(n1 + 1)]
+    for i in range(n1 + 1):
+        for j in range(n2 + 1):
+            if i == 0 or j == 0:
+                table[i][j] = [1]
+                continue
+            # Наибольший элемент принадлежит первой выборке (добавляет j к U) или второй
+            first, second = table[i - 1][j], table[i][j - 1]
+            size = i * j + 1
+            counts = [0] * size
+            for u, c in enumerate(first):
+                counts[u + j] += c
+            for u, c in enumerate(second):
+                counts[u] += c
+            table[i][j] = counts
+    return table[n1][n2]
+
+
+def compare(base, new, threshold, alpha):
+    """Возвращает строки сравнения: (ключ, медиана до, после, изменение, порог, p, вердикт)."""
+    rows = []
+    for key in sorted(set(base) & set(new)):
+        a = [v for run in base[key] for v in run]
+        b = [v for run in new[key] for v in run]
+        before, after = median(a), median(b)
+        if before == 0:
+            continue
+        change = (after - before) / before
+        between = max(relative_spread([median(run) for run in base[key]]),
+                      relative_spread([median(run) for run in new[key]]))
+        limit = max(threshold, 2 * relative_spread(a), 2 * between)
+        deterministic = len(a) < 2 or len(b) < 2
+        p = 1.0 if deterministic else mann_whitney_p(a, b)
+        significant = abs(change) > limit and (deterministic or p < alpha)
+        if significant and change > 0:
+            verdict = 'ЗАМЕДЛЕНИЕ'
+        elif significant:
+            verdict = 'ускорение'
+        else:
+            verdict = ''
+        rows.append((key, before, after, change, limit, p, verdict))
+    return rows
+
+
+def describe_environment(title, environments):
+    print(title)
+    seen = set()
+    for env in environments:
+        text = f"  {env.get('commit', '?')[:12]}  {env.get('compiler', '?')}  [{env.get('flags', '')}]  {env.get('cpu', '?')}"
+        if text not in seen:
+            seen.add(text)
+            print(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Сравнение результатов двух наборов прогонов.')
+    parser.add_argument('--base', nargs='+', required=True, help='JSON-файлы базовых прогонов')
+    parser.add_argument('--new', nargs='+', required=True, help='JSON-файлы новых прогонов')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='минимальное относительное изменение медианы (по умолчанию 0.05)')
+    parser.add_argument('--alpha', type=float, default=0.05,
+                        help='уровень значимости критерия Манна-Уитни (по умолчанию 0.05)')
+    parser.add_argument('--all', action='store_true', help='выводить все показатели, а не только значимые')
+    args = parser.parse_args()
+
+    base, base_env = load_results(args.base)
+    new, new_env = load_results(args.new)
+    describe_environment('База:', base_env)
+    describe_environment('Новые:', new_env)
+    print()
+
+    rows = compare(base, new, args.threshold, args.alpha)
+    header = f"{'Режим':<9} {'Контейнер':<13} {'Ключи':<20} {'Операция':<12} {'Размер':>8} " \
+             f"{'До':>14} {'После':>14} {'Изм.':>8} {'Порог':>7} {'p':>7}  Вердикт"
+    print(header)
+    print('-' * len(header))
+    regressions = 0
+    for (benchmark, container, dataset, operation, size, unit), before, after, change, limit, p, verdict in rows:
+        if verdict == 'ЗАМЕДЛЕНИЕ':
+            regressions += 1
+        if not verdict and not args.all:
+            continue
+        print(f"{benchmark:<9} {container:<13} {dataset:<20} {operation:<12} {size:>8} "
+              f"{before:>14.0f} {after:>14.0f} {change:>+8.1%} {limit:>7.1%} {p:>7.3f}  {verdict}")
+
+    print(f"\nСравнено показателей: {len(rows)}, значимых замедлений: {regressions}")
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,360 @@
+"""Единый прогон экспериментов C++, Python и C# с одинаковыми условиями.
+
+Скрипт собирает Experiment_C++.cpp и Experiment_C#.cs, запускает все три эксперимента
+на одних и тех же файлах ключей, размерах и числах повторов, затем объединяет их
+JSON-отчёты в одну таблицу и строит графики по данным:
+  * <набор>_insert/search/delete.png — время операции от числа элементов;
+  * bar_<размер>_<набор>.png — все операции для наибольшего размера.
+
+Результаты складываются в каталог --out:
+  combined_results.csv  — одна строка на показатель (язык, контейнер, набор, операция, размер);
+  combined_results.txt  — таблицы по наборам и операциям, время в нс на одну операцию;
+                          память — отдельно для каждого языка (языки меряют её по-разному);
+  cpp.json (и cpp.csv), python.json, csharp.json — исходные отчёты каждого языка.
+
+Пример:
+    python run_benchmarks.py --data-dir ../Тестирование --sizes 10,1000,100000 --iterations 100,10,3
+Нужны: компилятор C++17 (g++, clang++ или cl), .NET SDK (dotnet), для графиков — matplotlib.
+Язык, для которого нет инструментов, пропускается с предупреждением.
+"""
+import argparse
+import csv
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+
+# Наборы ключей в порядке Experiment_C++.cpp и тип ключей в них
+DATASETS = [
+    ('random_keys', 'str'),
+    ('decreasing_str_key', 'str'),
+    ('increasing_str_key', 'str'),
+    ('shuffled_numbers', 'int'),
+    ('decreasing_int_key', 'int'),
+    ('increasing_int_key', 'int'),
+]
+
+DATASET_TITLES = {
+    'random_keys': 'Случайные ключи',
+    'decreasing_str_key': 'Убывающие строковые ключи',
+    'increasing_str_key': 'Возрастающие строковые ключи',
+    'shuffled_numbers': 'Перемешанные числа',
+    'decreasing_int_key': 'Убывающие числовые ключи',
+    'increasing_int_key': 'Возрастающие числовые ключи',
+}
+
+# Подписи контейнеров на графиках, как в Graphics/
+CONTAINER_TITLES = {
+    ('C++', 'HashTable'): 'My Hash Dictionary (C++)',
+    ('C++', 'RedBlackTree'): 'My RB Tree Dictionary (C++)',
+    ('C++', 'StdHashMap'): 'unordered_map (C++)',
+    ('C++', 'StdTreeMap'): 'map (C++)',
+}
+
+OPERATIONS = [('insert', 'Вставка'), ('find', 'Поиск'), ('erase', 'Удаление')]
+
+# Что каждый язык называет памятью словаря; числа разных языков между собой не сравнимы
+MEMORY_METRICS = {
+    'C++': 'байты, выделенные через operator new (ключи и узлы)',
+    'Python': 'sys.getsizeof словаря (только таблица, без ключей)',
+    'C#': 'прирост GC.GetTotalMemory после вставки',
+}
+CHART_NAMES = {'insert': 'insert', 'find': 'search', 'erase': 'delete'}
+
+DEFAULT_SIZES = [10, 100, 1000, 10000, 100000, 1000000]
+
+
+def default_iterations(size):
+    """Правило getIterations из Experiment_C++.cpp — общее для всех языков."""
+    if size == 10:
+        return 1000
+    if size == 100:
+        return 100
+    if size <= 10000:
+        return 10
+    if size == 100000:
+        return 5
+    return 3
+
+
+def run(command, cwd=None):
+    print('>', ' '.join(command), flush=True)
+    return subprocess.run(command, cwd=cwd).returncode == 0
+
+
+def git_commit():
+    try:
+        out = subprocess.run(['git', 'rev-parse', 'HEAD'], cwd=ROOT, capture_output=True, text=True)
+        return out.stdout.strip() or 'unknown'
+    except OSError:
+        return 'unknown'
+
+
+def build_cpp(build_dir):
+    """Собирает Experiment_C++ с оптимизацией; возвращает путь к программе или None."""
+    source = os.path.join(ROOT, 'Experiment_C++.cpp')
+    commit = git_commit()
+    if platform.system() == 'Windows' and shutil.which('cl'):
+        exe = os.path.join(build_dir, 'experiment_cpp.exe')
+        flags = '/O2 /std:c++17 /EHsc /DNDEBUG'
+        ok = run(['cl', '/nologo', *flags.split(), f'/DBENCH_COMPILE_FLAGS="\\"{flags}\\""',
+                  f'/DBENCH_GIT_COMMIT="\\"{commit}\\""', source, f'/Fe{exe}', f'/Fo{build_dir}\\'])
+        return exe if ok else None
+    for compiler in ('g++', 'clang++'):
+        if shutil.which(compiler):
+            exe = os.path.join(build_dir, 'experiment_cpp')
+            flags = '-O2 -std=c++17 -DNDEBUG'
+            ok = run([compiler, *flags.split(), '-pthread', f'-DBENCH_COMPILE_FLAGS="{flags}"',
+                      f'-DBENCH_GIT_COMMIT="{commit}"', source, '-o', exe])
+            return exe if ok else None
+    print('Компилятор C++ не найден, C++ пропускается')
+    return None
+
+
+def build_csharp(build_dir):
+    """Собирает Experiment_C#.cs через временный проект dotnet; возвращает команду запуска или None."""
+    if not shutil.which('dotnet'):
+        print('dotnet не найден, C# пропускается')
+        return None
+    project_dir = os.path.join(build_dir, 'csharp')
+    os.makedirs(project_dir, exist_ok=True)
+    project = os.path.join(project_dir, 'Experiment_CSharp.csproj')
+    with open(project, 'w', encoding='utf-8') as f:
+        f.write(f"""<Project Sdk="Microsoft.NET.Sdk">
+  <PropertyGroup>
+    <OutputType>Exe</OutputType>
+    <TargetFramework>net{dotnet_version()}</TargetFramework>
+    <Optimize>true</Optimize>
+    <ServerGarbageCollection>false</ServerGarbageCollection>
+    <EnableDefaultCompileItems>false</EnableDefaultCompileItems>
+    <InvariantGlobalization>true</InvariantGlobalization>
+  </PropertyGroup>
+  <ItemGroup>
+    <Compile Include="{os.path.join(ROOT, 'Experiment_C#.cs')}" />
+  </ItemGroup>
+</Project>
+""")
+    output = os.path.join(project_dir, 'bin')
+    if not run(['dotnet', 'build', project, '-c', 'Release', '-o', output, '-nologo', '-v', 'q']):
+        return None
+    return ['dotnet', os.path.join(output, 'Experiment_CSharp.dll')]
+
+
+def dotnet_version():
+    """Версия установленного SDK .NET в виде 8.0 — под неё собирается проект."""
+    out = subprocess.run(['dotnet', '--version'], capture_output=True, text=True).stdout.strip()
+    parts = out.split('.')
+    return f'{parts[0]}.{parts[1]}' if len(parts) >= 2 and parts[0].isdigit() else '8.0'
+
+
+def load_report(path, language):
+    with open(path, 'r', encoding='utf-8') as f:
+        data = json.load(f)
+    records = []
+    for r in data.get('results', []):
+        if r.get('benchmark') != 'tables' or not r.get('samples'):
+            continue
+        r = dict(r, language=language)
+        records.append(r)
+    return records, data.get('environment', {})
+
+
+def median(values):
+    ordered = sorted(values)
+    mid = len(ordered) // 2
+    return ordered[mid] if len(ordered) % 2 else (ordered[mid - 1] + ordered[mid]) / 2
+
+
+def container_title(record):
+    key = (record['language'], record['container'])
+    return CONTAINER_TITLES.get(key, f"{record['container']} ({record['language']})")
+
+
+def write_combined_csv(records, path):
+    with open(path, 'w', newline='', encoding='utf-8') as f:
+        writer = csv.writer(f)
+        writer.writerow(['language', 'container', 'dataset', 'operation', 'size', 'unit',
+                         'median', 'per_element', 'count'])
+        for r in records:
+            m = median(r['samples'])
+            writer.writerow([r['language'], r['container'], r['dataset'], r['operation'], r['size'],
+                             r['unit'], f'{m:.1f}', f"{m / r['size']:.3f}", len(r['samples'])])
+
+
+def write_size_table(f, heading, index, key, containers, sizes):
+    """Одна таблица «размер × контейнер»: медиана показателя на элемент."""
+    if not any(key + (n, c) in index for n in sizes for c in containers):
+        return
+    f.write(f"\n--- {heading} ---\n\n")
+    f.write(f"{'Элементы':>10}" + ''.join(f" | {c:>10}" for c in containers) + '\n')
+    f.write('-' * (10 + sum(max(10, len(c)) + 3 for c in containers)) + '\n')
+    for n in sizes:
+        f.write(f'{n:>10}')
+        for c in containers:
+            r = index.get(key + (n, c))
+            cell = f"{median(r['samples']) / n:.1f}" if r else '-'
+            f.write(f' | {cell:>{max(10, len(c))}}')
+        f.write('\n')
+
+
+def write_combined_table(records, environments, path, sizes):
+    """Таблицы «размер × контейнер» по наборам и операциям; время — медиана в нс на элемент.
+    Память меряется в каждом языке по-своему, поэтому её таблицы строятся отдельно по языкам."""
+    containers = sorted({container_title(r) for r in records})
+    index = {(r['dataset'], r['operation'], r['size'], container_title(r)): r for r in records}
+    with open(path, 'w', encoding='utf-8') as f:
+        for language, env in environments.items():
+            f.write(f"{language}: {env.get('compiler', '?')} [{env.get('flags', '')}] "
+                    f"{env.get('cpu', '?')} {env.get('commit', '')[:12]}\n")
+        for dataset, _ in DATASETS:
+            for operation, title in OPERATIONS:
+                write_size_table(f, f'{dataset}: {title}, нс на элемент', index, (dataset, operation),
+                                 containers, sizes)
+            for language in environments:
+                own = sorted({container_title(r) for r in records if r['language'] == language})
+                metric = MEMORY_METRICS.get(language, 'способ замера не указан')
+                write_size_table(f, f'{dataset}: Память, {language}: {metric}, байт на элемент', index,
+                                 (dataset, 'memory'), own, sizes)
+
+
+def draw_charts(records, out_dir, sizes):
+    """Графики в стиле Graphics/: линии по размерам и столбцы для наибольшего размера."""
+    try:
+        import matplotlib
+        matplotlib.use('Agg')
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print('matplotlib не установлен, графики не построены')
+        return
+
+    plt.rcParams.update({'axes.labelweight': 'bold', 'axes.titleweight': 'bold'})
+    largest = max(sizes)
+    for dataset, _ in DATASETS:
+        title = DATASET_TITLES[dataset]
+        subset = [r for r in records if r['dataset'] == dataset and r['unit'] == 'ns']
+        if not subset:
+            continue
+        containers = sorted({container_title(r) for r in subset})
+
+        for operation, op_title in OPERATIONS:
+            fig, ax = plt.subplots(figsize=(12, 8))
+            for c in containers:
+                points = sorted((r['size'], median(r['samples'])) for r in subset
+                                if r['operation'] == operation and container_title(r) == c)
+                if points:
+                    ax.plot([p[0] for p in points], [p[1] for p in points], marker='o', label=c)
+            ax.set_xscale('log')
+            ax.set_yscale('log')
+            ax.set_xlabel('Количество элементов')
+            ax.set_ylabel('Время (нс)')
+            ax.set_title(f'{title} - {op_title}')
+            ax.grid(True, which='major', linestyle='--', alpha=0.7)
+            ax.legend()
+            fig.tight_layout()
+            fig.savefig(os.path.join(out_dir, f'{dataset}_{CHART_NAMES[operation]}.png'), dpi=150)
+            plt.close(fig)
+
+        fig, ax = plt.subplots(figsize=(12, 8))
+        bar = 0.25
+        for k, (operation, op_title) in enumerate(OPERATIONS):
+            values = []
+            for c in containers:
+                r = next((r for r in subset if r['operation'] == operation and r['size'] == largest
+                          and container_title(r) == c), None)
+                values.append(median(r['samples']) if r else 0)
+            ax.bar([i + (k - 1) * bar for i in range(len(containers))], values, bar, label=op_title)
+        ax.set_yscale('log')
+        ax.set_xticks(range(len(containers)))
+        ax.set_xticklabels(containers, rotation=45, ha='right')
+        ax.set_xlabel('Структуры данных')
+        ax.set_ylabel('Время (нс) - Логарифмическая шкала')
+        ax.set_title(f'Производительность для {largest} элементов ({title})')
+        ax.grid(True, which='both', axis='y', linestyle='--', alpha=0.7)
+        ax.legend()
+        fig.tight_layout()
+        fig.savefig(os.path.join(out_dir, f'bar_{largest}_{dataset}.png'), dpi=150)
+        plt.close(fig)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Прогон экспериментов C++, Python и C# в одинаковых условиях.')
+    parser.add_argument('--data-dir', default='.', help='каталог с файлами ключей (<набор>.txt)')
+    parser.add_argument('--sizes', default=','.join(map(str, DEFAULT_SIZES)),
+                        help='размеры наборов через запятую')
+    parser.add_argument('--iterations', help='число повторов для каждого размера через запятую '
+                                             '(по умолчанию — правило getIterations из C++)')
+    parser.add_argument('--datasets', help='наборы ключей через запятую (по умолчанию — все шесть)')
+    parser.add_argument('--languages', default='cpp,python,csharp', help='какие языки запускать')
+    parser.add_argument('--out', help='каталог результатов (по умолчанию test_results/combined_<время>)')
+    parser.add_argument('--report-only', action='store_true',
+                        help='не запускать эксперименты, а пересобрать таблицу и графики из отчётов в --out')
+    args = parser.parse_args()
+
+    sizes = [int(v) for v in args.sizes.split(',')]
+    iterations = [int(v) for v in args.iterations.split(',')] if args.iterations \
+        else [default_iterations(n) for n in sizes]
+    if len(iterations) != len(sizes):
+        sys.exit('Число значений --iterations должно совпадать с числом размеров')
+    datasets = DATASETS
+    if args.datasets:
+        names = args.datasets.split(',')
+        unknown = set(names) - {name for name, _ in DATASETS}
+        if unknown:
+            sys.exit(f"Неизвестные наборы: {', '.join(sorted(unknown))}")
+        datasets = [d for d in DATASETS if d[0] in names]
+    languages = args.languages.split(',')
+
+    data_dir = os.path.abspath(args.data_dir)
+    stamp = time.strftime('%Y-%m-%dT%H-%M-%SZ', time.gmtime())
+    out_dir = os.path.abspath(args.out or os.path.join(data_dir, 'test_results', f'combined_{stamp}'))
+    build_dir = os.path.join(out_dir, 'build')
+    os.makedirs(build_dir, exist_ok=True)
+    os.makedirs(os.path.join(data_dir, 'test_results'), exist_ok=True)
+
+    size_arg = ','.join(map(str, sizes))
+    iteration_arg = ','.join(map(str, iterations))
+    typed_datasets = ','.join(f'{name}:{key_type}' for name, key_type in datasets)
+    reports = {'C++': os.path.join(out_dir, 'cpp.json'),
+               'Python': os.path.join(out_dir, 'python.json'),
+               'C#': os.path.join(out_dir, 'csharp.json')}
+
+    if not args.report_only:
+        # Эксперименты запускаются по очереди, чтобы не мешать друг другу
+        if 'cpp' in languages:
+            exe = build_cpp(build_dir)
+            if exe:
+                run([exe, 'tables', f'sizes={size_arg}', f'iterations={iteration_arg}',
+                     f"datasets={','.join(name for name, _ in datasets)}", f"report={reports['C++']}"],
+                    cwd=data_dir)
+        if 'python' in languages:
+            run([sys.executable, os.path.join(ROOT, 'Experiment_Python.py'), '--data-dir', data_dir,
+                 '--sizes', size_arg, '--iterations', iteration_arg, '--datasets', typed_datasets,
+                 '--report', reports['Python']], cwd=data_dir)
+        if 'csharp' in languages:
+            command = build_csharp(build_dir)
+            if command:
+                run(command + ['--data', data_dir, '--sizes', size_arg, '--iterations', iteration_arg,
+                               '--datasets', typed_datasets, '--report', reports['C#']], cwd=data_dir)
+
+    records, environments = [], {}
+    for language, path in reports.items():
+        if os.path.exists(path):
+            language_records, environments[language] = load_report(path, language)
+            records += [r for r in language_records if r['size'] in sizes]
+    if not records:
+        sys.exit('Нет ни одного отчёта для объединения')
+
+    write_combined_csv(records, os.path.join(out_dir, 'combined_results.csv'))
+    write_combined_table(records, environments, os.path.join(out_dir, 'combined_results.txt'), sizes)
+    draw_charts(records, out_dir, sizes)
+    print(f'Объединённые результаты сохранены в {out_dir}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())